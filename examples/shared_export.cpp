@@ -0,0 +1,166 @@
+// Example: export of world transforms to other processes through POSIX shared memory
+//
+// Start the writer in one terminal, then any number of readers in other ones:
+//
+//     shared-export write /knm-export
+//     shared-export read /knm-export
+//
+// The writer animates a small hierarchy and exports its world transforms 60 times per
+// second. The readers map the same memory block and print the frames they read, in
+// place (without copying them).
+
+#define KNM_TRANSFORMS_TREE_IMPLEMENTATION
+#include <knm_transforms_tree.hpp>
+
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <thread>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+using namespace knm::tr2;
+
+
+static const size_t NB_NODES = 4;
+static const size_t NB_SLOTS = 3;
+
+
+//-----------------------------------------------------------------------
+
+static int runWriter(const char* name)
+{
+    const size_t size = SharedExportWriter::getRequiredSize(NB_NODES, NB_SLOTS, EF_POSES);
+
+    int fd = shm_open(name, O_CREAT | O_RDWR, 0600);
+    if ((fd < 0) || (ftruncate(fd, off_t(size)) != 0))
+    {
+        std::perror("shm_open");
+        return 1;
+    }
+
+    void* memory = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+
+    if (memory == MAP_FAILED)
+    {
+        std::perror("mmap");
+        return 1;
+    }
+
+    SharedExportWriter writer(memory, NB_NODES, NB_SLOTS, EF_POSES);
+
+    // A chain of Transforms, each one rotating around its parent
+    Transforms nodes[NB_NODES];
+    Transforms* pointers[NB_NODES];
+
+    for (size_t i = 0; i < NB_NODES; ++i)
+    {
+        pointers[i] = &nodes[i];
+
+        if (i > 0)
+        {
+            nodes[i].setParent(&nodes[i - 1]);
+            nodes[i].setPosition(1.0f, 0.0f, 0.0f);
+        }
+    }
+
+    std::printf("Writing frames into '%s' (Ctrl+C to stop)\n", name);
+
+    for (;;)
+    {
+        for (size_t i = 0; i < NB_NODES; ++i)
+            nodes[i].rotate(VEC3_UNIT_Z, 0.01f * real(i + 1));
+
+        writer.write(pointers, NB_NODES);
+
+        std::this_thread::sleep_for(std::chrono::milliseconds(16));
+    }
+}
+
+//-----------------------------------------------------------------------
+
+static int runReader(const char* name)
+{
+    int fd = shm_open(name, O_RDONLY, 0);
+    if (fd < 0)
+    {
+        std::perror("shm_open");
+        return 1;
+    }
+
+    struct stat infos;
+    if (fstat(fd, &infos) != 0)
+    {
+        std::perror("fstat");
+        close(fd);
+        return 1;
+    }
+
+    const size_t size = size_t(infos.st_size);
+
+    void* memory = mmap(nullptr, size, PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+
+    if (memory == MAP_FAILED)
+    {
+        std::perror("mmap");
+        return 1;
+    }
+
+    SharedExportReader reader(memory, size);
+    if (!reader.isValid())
+    {
+        std::fprintf(stderr, "'%s' wasn't initialised by a compatible writer\n", name);
+        return 1;
+    }
+
+    const size_t valuesPerNode = reader.getValuesPerNode();
+    uint64_t last = 0;
+
+    for (;;)
+    {
+        exported_frame_t frame;
+
+        // The values are read in place, then validated: the frame is retried if the
+        // writer modified it meanwhile
+        while (reader.beginRead(frame))
+        {
+            if (frame.frame == last)
+                break;
+
+            float leaf[3] = { 0.0f, 0.0f, 0.0f };
+            if (frame.nbNodes > 0)
+                std::memcpy(leaf, frame.values + (frame.nbNodes - 1) * valuesPerNode,
+                            sizeof(leaf));
+
+            if (reader.endRead(frame))
+            {
+                last = frame.frame;
+                std::printf("Frame %llu: %zu Transforms, leaf at (%.3f, %.3f, %.3f)\n",
+                            (unsigned long long) frame.frame, frame.nbNodes,
+                            leaf[0], leaf[1], leaf[2]);
+                break;
+            }
+        }
+
+        std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    }
+}
+
+//-----------------------------------------------------------------------
+
+int main(int argc, char** argv)
+{
+    if ((argc == 3) && (std::strcmp(argv[1], "write") == 0))
+        return runWriter(argv[2]);
+
+    if ((argc == 3) && (std::strcmp(argv[1], "read") == 0))
+        return runReader(argv[2]);
+
+    std::fprintf(stderr, "Usage: %s write|read <shared memory name>\n", argv[0]);
+    return 1;
+}
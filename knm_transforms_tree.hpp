@@ -125,8 +125,19 @@ LICENSE
 #pragma once
 
 #include <string>
+#include <vector>
 #include <algorithm>
+#include <atomic>
+#include <unordered_map>
+#include <cstdint>
+#include <cmath>
+#include <limits>
 #include <cassert>
+#include <cstring>
+#include <functional>
+#include <new>
+#include <istream>
+#include <ostream>
 
 
 // We only support GLM at the moment
@@ -148,6 +159,7 @@ LICENSE
 
 #ifdef KNM_TRANSFORMS_TREE_USE_GLM
     #include <glm/vec3.hpp>
+    #include <glm/vec4.hpp>
     #include <glm/mat4x4.hpp>
     #include <glm/mat3x3.hpp>
     #include <glm/gtc/quaternion.hpp>
@@ -169,6 +181,7 @@ namespace tr2 {
 
 #ifdef KNM_TRANSFORMS_TREE_USE_GLM
     typedef glm::vec3 vec3;
+    typedef glm::vec4 vec4;
     typedef glm::quat quat;
     typedef glm::mat4 mat4;
     typedef glm::mat3 mat3;
@@ -199,6 +212,11 @@ namespace tr2 {
 
 
     // Forward declarations
+    class Transforms;
+    class StructureJournal;
+    class MotionMatrices;
+    class ConstraintSolver;
+
 #ifdef KNM_TRANSFORMS_TREE_USE_TRANSFORMABLE
     class KNM_TRANSFORMS_TREE_TRANSFORMABLE_TYPE;
 #endif
@@ -215,6 +233,250 @@ namespace tr2 {
     };
 
 
+    //--------------------------------------------------------------------------------
+    /// @brief  Enumeration denoting the result of a test against a frustum
+    //--------------------------------------------------------------------------------
+    enum frustum_test_t
+    {
+        FT_OUTSIDE,     ///< Completely outside the frustum
+        FT_INTERSECTS,  ///< Partially inside the frustum
+        FT_INSIDE       ///< Completely inside the frustum
+    };
+
+
+    //--------------------------------------------------------------------------------
+    /// @brief  Enumeration denoting the formats of the world transforms exported by a
+    ///         SharedExportWriter
+    //--------------------------------------------------------------------------------
+    enum export_format_t
+    {
+        EF_POSES,       ///< Position (3 floats), orientation (4 floats: x, y, z, w) and
+                        ///  scale (3 floats)
+        EF_MATRICES     ///< 3x4 matrices (12 floats, row-major)
+    };
+
+
+    //--------------------------------------------------------------------------------
+    /// @brief  Enumeration denoting the modifications of the structure of a hierarchy
+    ///         recorded by a StructureJournal
+    //--------------------------------------------------------------------------------
+    enum structure_event_type_t
+    {
+        SE_ATTACHED,    ///< A Transforms without parent was given one
+        SE_DETACHED,    ///< A Transforms was removed from its parent
+        SE_REPARENTED,  ///< A Transforms was moved from a parent to another one
+        SE_TAG_ADDED,   ///< A tag was added to a Transforms
+        SE_TAG_REMOVED, ///< A tag was removed from a Transforms
+        SE_DESTROYED    ///< A Transforms was destroyed
+    };
+
+
+    //--------------------------------------------------------------------------------
+    /// @brief  Enumeration denoting the type of the joints of a KinematicChain
+    //--------------------------------------------------------------------------------
+    enum joint_type_t
+    {
+        JT_REVOLUTE,    ///< Rotation around an axis (value in radians)
+        JT_PRISMATIC,   ///< Translation along an axis
+        JT_FIXED        ///< No motion
+    };
+
+
+    //--------------------------------------------------------------------------------
+    /// @brief  A position, an orientation and a scale, in a given transforms space
+    //--------------------------------------------------------------------------------
+    struct pose_t
+    {
+        vec3 position;      ///< The position
+        quat orientation;   ///< The orientation
+        vec3 scale;         ///< The scale
+    };
+
+
+    //--------------------------------------------------------------------------------
+    /// @brief  An axis-aligned bounding box
+    ///
+    /// A box whose minimum corner is greater than its maximum corner is empty (this
+    /// is the case of a default-constructed box).
+    //--------------------------------------------------------------------------------
+    struct aabb_t
+    {
+        vec3 min;           ///< The minimum corner
+        vec3 max;           ///< The maximum corner
+
+        //--------------------------------------------------------------------------------
+        /// @brief  Constructor (empty box)
+        //--------------------------------------------------------------------------------
+        aabb_t()
+        : min(std::numeric_limits<real>::max()), max(-std::numeric_limits<real>::max())
+        {
+        }
+
+        //--------------------------------------------------------------------------------
+        /// @brief  Constructor
+        //--------------------------------------------------------------------------------
+        aabb_t(const vec3& min, const vec3& max)
+        : min(min), max(max)
+        {
+        }
+
+        //--------------------------------------------------------------------------------
+        /// @brief  Indicates if the box is empty
+        //--------------------------------------------------------------------------------
+        inline bool isEmpty() const
+        {
+            return (min.x > max.x) || (min.y > max.y) || (min.z > max.z);
+        }
+
+        //--------------------------------------------------------------------------------
+        /// @brief  Gets the center of the box
+        //--------------------------------------------------------------------------------
+        inline vec3 getCenter() const
+        {
+            return (min + max) * 0.5f;
+        }
+
+        //--------------------------------------------------------------------------------
+        /// @brief  Gets the half-size of the box along each axis
+        //--------------------------------------------------------------------------------
+        inline vec3 getExtents() const
+        {
+            return (max - min) * 0.5f;
+        }
+
+        //--------------------------------------------------------------------------------
+        /// @brief  Grows the box to contain another one
+        //--------------------------------------------------------------------------------
+        inline void merge(const aabb_t& box)
+        {
+            min = glm::min(min, box.min);
+            max = glm::max(max, box.max);
+        }
+
+        //--------------------------------------------------------------------------------
+        /// @brief  Indicates if the box intersects another one
+        //--------------------------------------------------------------------------------
+        inline bool intersects(const aabb_t& box) const
+        {
+            return (min.x <= box.max.x) && (max.x >= box.min.x) &&
+                   (min.y <= box.max.y) && (max.y >= box.min.y) &&
+                   (min.z <= box.max.z) && (max.z >= box.min.z);
+        }
+
+        //--------------------------------------------------------------------------------
+        /// @brief  Indicates if the box intersects a sphere
+        //--------------------------------------------------------------------------------
+        inline bool intersects(const vec3& center, real radius) const
+        {
+            if (isEmpty())
+                return false;
+
+            vec3 closest = glm::clamp(center, min, max);
+            return KNM_TRANSFORMS_TREE_SQUARED_LENGTH(closest - center) <= radius * radius;
+        }
+    };
+
+
+    //--------------------------------------------------------------------------------
+    /// @brief  A ray, defined by an origin and a direction
+    //--------------------------------------------------------------------------------
+    struct ray_t
+    {
+        vec3 origin;        ///< The origin
+        vec3 direction;     ///< The direction (doesn't need to be normalised)
+    };
+
+
+    //--------------------------------------------------------------------------------
+    /// @brief  A Transforms hit by a ray
+    //--------------------------------------------------------------------------------
+    struct ray_hit_t
+    {
+        Transforms* transforms; ///< The Transforms hit
+        real distance;          ///< The world-space distance from the origin of the
+                                ///  ray to the hit point
+    };
+
+
+    //--------------------------------------------------------------------------------
+    /// @brief  Settings of the replication of Transforms (see ReplicationEncoder), that
+    ///         must be identical on both sides
+    //--------------------------------------------------------------------------------
+    struct replication_settings_t
+    {
+        aabb_t bounds;              ///< The box in which the positions are quantized
+        uint32_t positionBits;      ///< Number of bits per coordinate of the positions
+        uint32_t orientationBits;   ///< Number of bits per component of the orientations
+
+        //--------------------------------------------------------------------------------
+        /// @brief  Constructor, with positions in [-1024, 1024] quantized on 16 bits
+        ///         (precision: 3 cm for meters) and orientations on 10 bits
+        //--------------------------------------------------------------------------------
+        replication_settings_t()
+        : bounds(vec3(-1024.0f), vec3(1024.0f)), positionBits(16), orientationBits(10)
+        {
+        }
+    };
+
+
+    //--------------------------------------------------------------------------------
+    /// @brief  Statistics about the data encoded or decoded by a replication encoder or
+    ///         decoder
+    //--------------------------------------------------------------------------------
+    struct replication_stats_t
+    {
+        uint64_t nbMessages;    ///< Number of messages
+        uint64_t nbNodes;       ///< Number of Transforms in the messages
+        uint64_t nbBytes;       ///< Total size of the messages
+
+        //--------------------------------------------------------------------------------
+        /// @brief  Constructor
+        //--------------------------------------------------------------------------------
+        replication_stats_t()
+        : nbMessages(0), nbNodes(0), nbBytes(0)
+        {
+        }
+
+        //--------------------------------------------------------------------------------
+        /// @brief  Returns the average number of bytes per Transforms
+        //--------------------------------------------------------------------------------
+        inline double getBytesPerNode() const
+        {
+            return (nbNodes > 0 ? double(nbBytes) / double(nbNodes) : 0.0);
+        }
+    };
+
+
+    //--------------------------------------------------------------------------------
+    /// @brief  A modification of the structure of a hierarchy, recorded by a
+    ///         StructureJournal
+    //--------------------------------------------------------------------------------
+    struct structure_event_t
+    {
+        uint64_t sequence;              ///< The sequence number of the event
+        structure_event_type_t type;    ///< The type of the event
+        Transforms* transforms;         ///< The modified Transforms (only usable as an
+                                        ///  identifier if it was destroyed)
+        Transforms* parent;             ///< The parent after the modification
+        Transforms* previousParent;     ///< The parent before the modification
+        std::string tag;                ///< The tag added or removed
+    };
+
+
+    //--------------------------------------------------------------------------------
+    /// @brief  A frame exported by a SharedExportWriter, read in place by a
+    ///         SharedExportReader (see SharedExportReader::beginRead())
+    //--------------------------------------------------------------------------------
+    struct exported_frame_t
+    {
+        uint64_t frame;         ///< The number of the frame
+        const float* values;    ///< The exported transforms, in the memory block
+        size_t nbNodes;         ///< The number of Transforms
+        const void* slot;       ///< Used by SharedExportReader::endRead()
+        uint64_t sequence;      ///< Used by SharedExportReader::endRead()
+    };
+
+
     //------------------------------------------------------------------------------------
     /// @brief  Defines a transforms space, by a position, an orientation and a scale
     ///
@@ -319,6 +581,53 @@ namespace tr2 {
         //--------------------------------------------------------------------------------
         std::vector<Transforms*> findChildren(const std::string& tag,
                                               bool recursive=false) const;
+
+        //--------------------------------------------------------------------------------
+        /// @brief  Builds hierarchies from arrays of parent indices and local transforms
+        ///
+        /// @remark Much faster than calling setParent(), setPosition(), ... on each
+        ///         Transforms: the children lists are allocated with their exact size,
+        ///         and the world transforms are computed once at the end, parents first.
+        ///
+        /// @remark The Transforms must have neither parent nor children. The roots
+        ///         (Transforms without parent in the arrays) can use a journal (see
+        ///         setJournal()), in which case the attachments are recorded.
+        ///
+        /// @param  nodes       The Transforms
+        /// @param  parents     The index of the parent of each Transforms in 'nodes' (-1
+        ///                     for the roots)
+        /// @param  poses       The transforms of each Transforms, relative to its parent
+        /// @param  count       The number of Transforms
+        /// @param  tags        The tag of each Transforms (empty strings for no tag). Can
+        ///                     be nullptr.
+        /// @return             'false' if the parent indices are out of range or contain
+        ///                     cycles, in which case nothing is modified
+        //--------------------------------------------------------------------------------
+        static bool buildHierarchy(Transforms* const* nodes, const int32_t* parents,
+                                   const pose_t* poses, size_t count,
+                                   const std::string* tags = nullptr);
+
+        //--------------------------------------------------------------------------------
+        /// @brief  Sets the journal in which the modifications of the structure of the
+        ///         hierarchy are recorded
+        ///
+        /// @remark The journal is used by this Transforms and all the ones below it.
+        ///         Transforms attached to a parent use the journal of their new parent,
+        ///         and detached ones (see setParent()) don't use any journal anymore:
+        ///         their detachment is the last event recorded in the previous one.
+        ///
+        /// @param  journal     The journal (nullptr to not record anything)
+        //--------------------------------------------------------------------------------
+        void setJournal(StructureJournal* journal);
+
+        //--------------------------------------------------------------------------------
+        /// @brief  Gets the journal in which the modifications of the structure of the
+        ///         hierarchy are recorded
+        //--------------------------------------------------------------------------------
+        inline StructureJournal* getJournal() const
+        {
+            return m_journal;
+        }
     /// @}
 
 
@@ -331,25 +640,14 @@ namespace tr2 {
         ///
         /// @param  tag     The tag
         //--------------------------------------------------------------------------------
-        inline void addTag(const std::string& tag)
-        {
-            assert(!tag.empty());
-            m_tags.push_back(tag);
-        }
+        void addTag(const std::string& tag);
 
         //--------------------------------------------------------------------------------
         /// @brief  Remove a tag from the Transforms
         ///
         /// @param  tag     The tag
         //--------------------------------------------------------------------------------
-        inline void removeTag(const std::string& tag)
-        {
-            assert(!tag.empty());
-
-            auto iter = std::find(m_tags.begin(), m_tags.end(), tag);
-            if (iter != m_tags.end())
-                m_tags.erase(iter);
-        }
+        void removeTag(const std::string& tag);
 
         //--------------------------------------------------------------------------------
         /// @brief  Gets all the tags
@@ -390,6 +688,12 @@ namespace tr2 {
         //--------------------------------------------------------------------------------
         mat4 getWorldMatrix();
 
+        //--------------------------------------------------------------------------------
+        /// @brief  Gets a matrix converting from world space to the space of the
+        ///         Transforms (the inverse of the world matrix)
+        //--------------------------------------------------------------------------------
+        mat4 getWorldInverseMatrix();
+
         //--------------------------------------------------------------------------------
         /// @brief  Gets a matrix containing the position/orientation/scale of the
         ///         Transforms
@@ -449,6 +753,31 @@ namespace tr2 {
         //--------------------------------------------------------------------------------
         void translate(real* d, transform_space_t relativeTo = TS_LOCAL);
 
+        //--------------------------------------------------------------------------------
+        /// @brief  Moves several Transforms along the cartesian axes
+        ///
+        /// @remark The world-space translations use the inverse transforms cached
+        ///         in the parents, so moving many siblings only costs one world update
+        ///         of their parent
+        ///
+        /// @param  nodes       The Transforms to move
+        /// @param  d           The translations (one per Transforms)
+        /// @param  count       The number of Transforms
+        /// @param  relativeTo  The space which the translations are relative to
+        //--------------------------------------------------------------------------------
+        static void translate(Transforms* const* nodes, const vec3* d, size_t count,
+                              transform_space_t relativeTo = TS_LOCAL);
+
+        //--------------------------------------------------------------------------------
+        /// @brief  Sets the world-space position of the Transforms
+        ///
+        /// @remark The position relative to the origin is computed from the world
+        ///         transforms of the parent
+        ///
+        /// @param  pos     The world-space position vector
+        //--------------------------------------------------------------------------------
+        void setWorldPosition(const vec3& pos);
+
         //--------------------------------------------------------------------------------
         /// @brief  Gets the world-space position of the Transforms
         //--------------------------------------------------------------------------------
@@ -580,6 +909,21 @@ namespace tr2 {
         //--------------------------------------------------------------------------------
         void rotate(const quat& q, transform_space_t relativeTo = TS_LOCAL);
 
+        //--------------------------------------------------------------------------------
+        /// @brief  Rotate several Transforms using quaternions
+        ///
+        /// @remark The world-space rotations use the inverse orientation cached in
+        ///         each Transforms instead of inverting their world orientation
+        ///
+        /// @param  nodes       The Transforms to rotate
+        /// @param  q           The quaternions representing the rotations (one per
+        ///                     Transforms)
+        /// @param  count       The number of Transforms
+        /// @param  relativeTo  The space in which the rotation axes are expressed
+        //--------------------------------------------------------------------------------
+        static void rotate(Transforms* const* nodes, const quat* q, size_t count,
+                           transform_space_t relativeTo = TS_LOCAL);
+
         //--------------------------------------------------------------------------------
         /// @brief  Resets the orientation (local axes as world axes, no rotation)
         //--------------------------------------------------------------------------------
@@ -609,6 +953,16 @@ namespace tr2 {
             return m_bInheritOrientation;
         }
 
+        //--------------------------------------------------------------------------------
+        /// @brief  Sets the world-space orientation of the Transforms
+        ///
+        /// @remark The orientation relative to the origin is computed from the world
+        ///         orientation of the parent (if it is inherited)
+        ///
+        /// @param  q   The world-space orientation quaternion
+        //--------------------------------------------------------------------------------
+        void setWorldOrientation(const quat& q);
+
         //--------------------------------------------------------------------------------
         /// @brief  Gets the world-space orientation of the Transforms
         //--------------------------------------------------------------------------------
@@ -759,6 +1113,16 @@ namespace tr2 {
             return m_bInheritScale;
         }
 
+        //--------------------------------------------------------------------------------
+        /// @brief  Sets the world-space scale of the Transforms
+        ///
+        /// @remark The scale relative to the origin is computed from the world scale
+        ///         of the parent (if it is inherited)
+        ///
+        /// @param  scale   The world-space scaling factor
+        //--------------------------------------------------------------------------------
+        void setWorldScale(const vec3& scale);
+
         //--------------------------------------------------------------------------------
         /// @brief  Gets the world-space scale of the Transforms
         //--------------------------------------------------------------------------------
@@ -774,53 +1138,481 @@ namespace tr2 {
     /// @}
 
 
-        //_____ Private methods __________
-    private:
-        void needUpdate();
-        void update();
+        //_____ Bounds __________
+    public:
+    /// @name Bounds
+    /// @{
+        //--------------------------------------------------------------------------------
+        /// @brief  Sets the bounding box of the Transforms, in local space
+        ///
+        /// @remark The world-space bounding box is computed along with the world
+        ///         transforms. The bounding boxes of the Transforms are aggregated up
+        ///         the hierarchy (see getSubtreeBounds()).
+        ///
+        /// @param  bounds  The local-space bounding box
+        //--------------------------------------------------------------------------------
+        void setLocalBounds(const aabb_t& bounds);
 
+        //--------------------------------------------------------------------------------
+        /// @brief  Removes the bounding box of the Transforms
+        //--------------------------------------------------------------------------------
+        void clearLocalBounds();
 
-        //_____ Attributes __________
-    private:
-        // Parent-children relationship
-        Transforms* m_parent;
-        std::vector<Transforms*> m_children;
+        //--------------------------------------------------------------------------------
+        /// @brief  Indicates if the Transforms has a bounding box
+        //--------------------------------------------------------------------------------
+        inline bool hasBounds() const
+        {
+            return m_bHasBounds;
+        }
 
-        // Transformable
-        KNM_TRANSFORMS_TREE_TRANSFORMABLE_TYPE* m_transformable;
+        //--------------------------------------------------------------------------------
+        /// @brief  Gets the bounding box of the Transforms, in local space
+        //--------------------------------------------------------------------------------
+        inline const aabb_t& getLocalBounds() const
+        {
+            return m_localBounds;
+        }
 
-        // Tags
-        std::vector<std::string> m_tags;
+        //--------------------------------------------------------------------------------
+        /// @brief  Gets the world-space bounding box of the Transforms (empty if it
+        ///         has no bounding box)
+        //--------------------------------------------------------------------------------
+        aabb_t getWorldBounds();
 
-        // Relative transforms
-        vec3 m_position;
-        quat m_orientation;
-        vec3 m_scale;
+        //--------------------------------------------------------------------------------
+        /// @brief  Gets the world-space bounding box enclosing the bounding boxes of
+        ///         this Transforms and of all the ones below it
+        ///
+        /// @remark Only the branches of the hierarchy modified since the previous call
+        ///         are refitted
+        //--------------------------------------------------------------------------------
+        aabb_t getSubtreeBounds();
 
-        // Full (world) transforms
-        vec3 m_fullPosition;
-        quat m_fullOrientation;
-        vec3 m_fullScale;
+        //--------------------------------------------------------------------------------
+        /// @brief  Finds the Transforms (this one and the ones below it) whose
+        ///         bounding box intersects a world-space box
+        ///
+        /// @remark The branches of the hierarchy whose bounds don't intersect the box
+        ///         are rejected with one test
+        ///
+        /// @param  box     The world-space box
+        /// @param  result  The list in which the Transforms found are stored (it is
+        ///                 cleared first)
+        /// @return The number of Transforms found
+        //--------------------------------------------------------------------------------
+        size_t findInBox(const aabb_t& box, std::vector<Transforms*>& result);
 
-        // Flags
-        bool m_bDirty;
-        bool m_bInheritOrientation;
-        bool m_bInheritScale;
-    };
+        //--------------------------------------------------------------------------------
+        /// @brief  Finds the Transforms (this one and the ones below it) whose
+        ///         bounding box intersects a world-space sphere
+        ///
+        /// @remark The branches of the hierarchy whose bounds don't intersect the
+        ///         sphere are rejected with one test
+        ///
+        /// @param  center  The center of the sphere
+        /// @param  radius  The radius of the sphere
+        /// @param  result  The list in which the Transforms found are stored (it is
+        ///                 cleared first)
+        /// @return The number of Transforms found
+        //--------------------------------------------------------------------------------
+        size_t findInSphere(const vec3& center, real radius,
+                            std::vector<Transforms*>& result);
 
+        //--------------------------------------------------------------------------------
+        /// @brief  Finds the Transforms (this one and the ones below it) whose
+        ///         bounding box is hit by a world-space ray
+        ///
+        /// @remark The bounding boxes are tested as oriented boxes, by converting the
+        ///         ray into the space of each Transforms. The branches of the
+        ///         hierarchy whose bounds aren't hit are rejected with one test.
+        ///
+        /// @param  ray         The world-space ray
+        /// @param  hits        The list in which the hits are stored, sorted by
+        ///                     increasing distance (it is cleared first)
+        /// @param  maxDistance The maximum distance from the origin of the ray
+        /// @return The number of Transforms hit
+        //--------------------------------------------------------------------------------
+        size_t raycast(const ray_t& ray, std::vector<ray_hit_t>& hits,
+                       real maxDistance = std::numeric_limits<real>::max());
 
+        //--------------------------------------------------------------------------------
+        /// @brief  Casts several world-space rays on this Transforms and the ones below
+        ///         it
+        ///
+        /// @param  rays        The world-space rays
+        /// @param  count       The number of rays
+        /// @param  hits        The lists in which the hits of each ray are stored,
+        ///                     sorted by increasing distance (one per ray, cleared
+        ///                     first)
+        /// @param  maxDistance The maximum distance from the origin of the rays
+        //--------------------------------------------------------------------------------
+        void raycast(const ray_t* rays, size_t count, std::vector<ray_hit_t>* hits,
+                     real maxDistance = std::numeric_limits<real>::max());
+    /// @}
 
-#ifdef KNM_TRANSFORMS_TREE_USE_TRANSFORMABLE
 
-    //------------------------------------------------------------------------------------
-    /// @brief  Instances of this class can be associated with the Transforms (to
-    ///         indicates that the Transforms affect this object in particular)
-    ///
-    /// It is expected that your classes inherit from Transformable.
-    ///
-    /// If you want to use another class instead, define the
-    /// KNM_TRANSFORMS_TREE_TRANSFORMABLE_TYPE macro to the fully-qualified name of your
-    /// class.
+        //_____ Local transforms __________
+    public:
+    /// @name Local transforms
+    /// @{
+        //--------------------------------------------------------------------------------
+        /// @brief  Sets the position, orientation and scale of the Transforms
+        ///         (relative to its parent) at once
+        ///
+        /// @remark This is equivalent to calling setPosition(), setOrientation() and
+        ///         setScale(), but the Transforms below this one are only invalidated
+        ///         once
+        ///
+        /// @param  pose    The transforms, relative to the parent
+        //--------------------------------------------------------------------------------
+        void setTransforms(const pose_t& pose);
+
+        //--------------------------------------------------------------------------------
+        /// @brief  Sets the transforms (relative to their parent) of several Transforms
+        ///         at once
+        ///
+        /// @param  nodes   The Transforms
+        /// @param  poses   The transforms (one per Transforms)
+        /// @param  count   The number of Transforms
+        //--------------------------------------------------------------------------------
+        static void setTransforms(Transforms* const* nodes, const pose_t* poses,
+                                  size_t count);
+
+        //--------------------------------------------------------------------------------
+        /// @brief  Gets the position, orientation and scale of the Transforms, relative
+        ///         to its parent
+        //--------------------------------------------------------------------------------
+        inline pose_t getTransforms() const
+        {
+            pose_t pose;
+            pose.position = m_position;
+            pose.orientation = m_orientation;
+            pose.scale = m_scale;
+            return pose;
+        }
+    /// @}
+
+
+        //_____ World transforms __________
+    public:
+    /// @name World transforms
+    /// @{
+        //--------------------------------------------------------------------------------
+        /// @brief  Sets the world-space position, orientation and scale of the
+        ///         Transforms at once
+        ///
+        /// @remark This is equivalent to calling setWorldPosition(),
+        ///         setWorldOrientation() and setWorldScale(), but the Transforms below
+        ///         this one are only invalidated once
+        ///
+        /// @param  pose    The world-space transforms
+        //--------------------------------------------------------------------------------
+        void setWorldTransforms(const pose_t& pose);
+
+        //--------------------------------------------------------------------------------
+        /// @brief  Sets the world-space transforms of several Transforms at once
+        ///
+        /// @remark The Transforms are processed parents first (whatever their order in
+        ///         the array), so a child is placed relatively to the new world
+        ///         transforms of its parent. Each invalidated hierarchy is only
+        ///         traversed once.
+        ///
+        /// @param  nodes   The Transforms
+        /// @param  poses   The world-space transforms (one per Transforms)
+        /// @param  count   The number of Transforms
+        //--------------------------------------------------------------------------------
+        static void setWorldTransforms(Transforms* const* nodes, const pose_t* poses,
+                                       size_t count);
+
+        //--------------------------------------------------------------------------------
+        /// @brief  Gets the world-space position, orientation and scale of the
+        ///         Transforms
+        //--------------------------------------------------------------------------------
+        pose_t getWorldTransforms();
+
+        //--------------------------------------------------------------------------------
+        /// @brief  Gets the revision of the world transforms of the Transforms
+        ///
+        /// @remark The revision is incremented each time the world transforms are
+        ///         invalidated (by a modification of this Transforms or of one above
+        ///         it). Comparing it with a previously retrieved value indicates if the
+        ///         world transforms might have changed in-between.
+        //--------------------------------------------------------------------------------
+        inline uint32_t getRevision() const
+        {
+            return m_revision;
+        }
+    /// @}
+
+
+        //_____ Update pass __________
+    public:
+    /// @name Update pass
+    /// @{
+        //--------------------------------------------------------------------------------
+        /// @brief  Updates the world transforms of the Transforms of the hierarchy
+        ///         (this one and all the ones below it) modified since the previous
+        ///         update pass, and reports them
+        ///
+        /// @remark Only the branches of the hierarchy containing modified Transforms
+        ///         are traversed. Since the pass resets the modification flags, only
+        ///         one system should perform it on a given hierarchy (see ChangeLog).
+        ///
+        /// @param  changed     The list to which the Transforms whose world transforms
+        ///                     changed are appended (parents before their children)
+        /// @return The number of Transforms appended to the list
+        //--------------------------------------------------------------------------------
+        size_t updateHierarchy(std::vector<Transforms*>& changed);
+    /// @}
+
+
+        //_____ Space conversions __________
+    public:
+    /// @name Conversions between transforms spaces
+    /// @{
+        //--------------------------------------------------------------------------------
+        /// @brief  Converts points from the space of a Transforms to the space of
+        ///         another one
+        ///
+        /// @remark The composite transformation is computed only once, then applied
+        ///         to all the points
+        ///
+        /// @param  from    The Transforms in which the points are expressed (nullptr
+        ///                 for world space)
+        /// @param  to      The Transforms in which the points must be expressed
+        ///                 (nullptr for world space)
+        /// @param  in      The points to convert
+        /// @param  out     The converted points (can be the same array as 'in')
+        /// @param  count   The number of points
+        //--------------------------------------------------------------------------------
+        static void convertPoints(Transforms* from, Transforms* to, const vec3* in,
+                                  vec3* out, size_t count);
+
+        //--------------------------------------------------------------------------------
+        /// @brief  Converts points from the space of a Transforms to the space of
+        ///         another one
+        ///
+        /// @param  from    The Transforms in which the points are expressed (nullptr
+        ///                 for world space)
+        /// @param  to      The Transforms in which the points must be expressed
+        ///                 (nullptr for world space)
+        /// @param  in      The points to convert
+        /// @param  out     The converted points
+        //--------------------------------------------------------------------------------
+        inline static void convertPoints(Transforms* from, Transforms* to,
+                                         const std::vector<vec3>& in,
+                                         std::vector<vec3>& out)
+        {
+            out.resize(in.size());
+            convertPoints(from, to, in.data(), out.data(), in.size());
+        }
+
+        //--------------------------------------------------------------------------------
+        /// @brief  Converts vectors (like translations) from the space of a Transforms
+        ///         to the space of another one
+        ///
+        /// @remark Unlike points, vectors aren't affected by the positions of the
+        ///         Transforms, but are affected by their orientations and scales
+        ///
+        /// @param  from    The Transforms in which the vectors are expressed (nullptr
+        ///                 for world space)
+        /// @param  to      The Transforms in which the vectors must be expressed
+        ///                 (nullptr for world space)
+        /// @param  in      The vectors to convert
+        /// @param  out     The converted vectors (can be the same array as 'in')
+        /// @param  count   The number of vectors
+        //--------------------------------------------------------------------------------
+        static void convertVectors(Transforms* from, Transforms* to, const vec3* in,
+                                   vec3* out, size_t count);
+
+        //--------------------------------------------------------------------------------
+        /// @brief  Converts vectors (like translations) from the space of a Transforms
+        ///         to the space of another one
+        ///
+        /// @param  from    The Transforms in which the vectors are expressed (nullptr
+        ///                 for world space)
+        /// @param  to      The Transforms in which the vectors must be expressed
+        ///                 (nullptr for world space)
+        /// @param  in      The vectors to convert
+        /// @param  out     The converted vectors
+        //--------------------------------------------------------------------------------
+        inline static void convertVectors(Transforms* from, Transforms* to,
+                                          const std::vector<vec3>& in,
+                                          std::vector<vec3>& out)
+        {
+            out.resize(in.size());
+            convertVectors(from, to, in.data(), out.data(), in.size());
+        }
+
+        //--------------------------------------------------------------------------------
+        /// @brief  Converts directions from the space of a Transforms to the space of
+        ///         another one
+        ///
+        /// @remark Directions are only affected by the orientations of the Transforms,
+        ///         so their length is preserved
+        ///
+        /// @param  from    The Transforms in which the directions are expressed
+        ///                 (nullptr for world space)
+        /// @param  to      The Transforms in which the directions must be expressed
+        ///                 (nullptr for world space)
+        /// @param  in      The directions to convert
+        /// @param  out     The converted directions (can be the same array as 'in')
+        /// @param  count   The number of directions
+        //--------------------------------------------------------------------------------
+        static void convertDirections(Transforms* from, Transforms* to, const vec3* in,
+                                      vec3* out, size_t count);
+
+        //--------------------------------------------------------------------------------
+        /// @brief  Converts directions from the space of a Transforms to the space of
+        ///         another one
+        ///
+        /// @param  from    The Transforms in which the directions are expressed
+        ///                 (nullptr for world space)
+        /// @param  to      The Transforms in which the directions must be expressed
+        ///                 (nullptr for world space)
+        /// @param  in      The directions to convert
+        /// @param  out     The converted directions
+        //--------------------------------------------------------------------------------
+        inline static void convertDirections(Transforms* from, Transforms* to,
+                                             const std::vector<vec3>& in,
+                                             std::vector<vec3>& out)
+        {
+            out.resize(in.size());
+            convertDirections(from, to, in.data(), out.data(), in.size());
+        }
+
+        //--------------------------------------------------------------------------------
+        /// @brief  Converts orientations from the space of a Transforms to the space of
+        ///         another one
+        ///
+        /// @param  from    The Transforms in which the orientations are expressed
+        ///                 (nullptr for world space)
+        /// @param  to      The Transforms in which the orientations must be expressed
+        ///                 (nullptr for world space)
+        /// @param  in      The orientations to convert
+        /// @param  out     The converted orientations (can be the same array as 'in')
+        /// @param  count   The number of orientations
+        //--------------------------------------------------------------------------------
+        static void convertOrientations(Transforms* from, Transforms* to, const quat* in,
+                                        quat* out, size_t count);
+
+        //--------------------------------------------------------------------------------
+        /// @brief  Converts orientations from the space of a Transforms to the space of
+        ///         another one
+        ///
+        /// @param  from    The Transforms in which the orientations are expressed
+        ///                 (nullptr for world space)
+        /// @param  to      The Transforms in which the orientations must be expressed
+        ///                 (nullptr for world space)
+        /// @param  in      The orientations to convert
+        /// @param  out     The converted orientations
+        //--------------------------------------------------------------------------------
+        inline static void convertOrientations(Transforms* from, Transforms* to,
+                                               const std::vector<quat>& in,
+                                               std::vector<quat>& out)
+        {
+            out.resize(in.size());
+            convertOrientations(from, to, in.data(), out.data(), in.size());
+        }
+    /// @}
+
+
+        //_____ Private methods __________
+    private:
+        void needUpdate();
+        void invalidate();
+        void update();
+        void needBoundsRefit();
+        void needUpdatePass();
+        void collectChanges(std::vector<Transforms*>& changed);
+        void addSubtreeSubscriptions(int32_t delta);
+        void updateWorldBounds();
+        void refitSubtreeBounds();
+        void collectInBox(const aabb_t& box, std::vector<Transforms*>& result);
+        void collectInSphere(const vec3& center, real radius,
+                             std::vector<Transforms*>& result);
+        void collectHits(const ray_t& ray, real maxDistance, std::vector<ray_hit_t>& hits);
+
+
+        //_____ Attributes __________
+    private:
+        // Parent-children relationship
+        Transforms* m_parent;
+        std::vector<Transforms*> m_children;
+
+        // Transformable
+        KNM_TRANSFORMS_TREE_TRANSFORMABLE_TYPE* m_transformable;
+
+        // Tags
+        std::vector<std::string> m_tags;
+
+        // Journal of the modifications of the structure of the hierarchy
+        StructureJournal* m_journal;
+
+        // Slot of the Transforms in a buffer of current/previous world matrices
+        MotionMatrices* m_motion;
+        uint32_t m_motionSlot;
+
+        // Relative transforms
+        vec3 m_position;
+        quat m_orientation;
+        vec3 m_scale;
+
+        // Full (world) transforms
+        vec3 m_fullPosition;
+        quat m_fullOrientation;
+        vec3 m_fullScale;
+
+        // Inverse of the full transforms, used to convert from world space
+        quat m_fullInverseOrientation;
+        vec3 m_fullInverseScale;
+
+        // Incremented each time the world transforms are invalidated
+        uint32_t m_revision;
+
+        // Subscriptions of change listeners (see ChangeLog::addListener()), so the
+        // Transforms without listener cost nothing during the notification
+        uint32_t m_nbSubscriptions;         // To this Transforms
+        uint32_t m_nbSubtreeSubscriptions;  // Of subtree type, to this Transforms or
+                                            // to one above it
+
+        // Bounds
+        aabb_t m_localBounds;
+        aabb_t m_worldBounds;
+        aabb_t m_subtreeBounds;
+
+        // Flags
+        bool m_bDirty;
+        bool m_bInheritOrientation;
+        bool m_bInheritScale;
+        bool m_bHasBounds;
+        bool m_bSubtreeBoundsDirty;
+        bool m_bChanged;            // Modified since the last update pass
+        bool m_bSubtreeChanged;     // This one or one below it modified since the last
+                                    // update pass
+
+        // Classes walking the children lists without copying them
+        friend class SpatialIndex;
+        friend class Frustum;
+        friend class ChangeLog;
+        friend class SnapshotWriter;
+        friend class MotionMatrices;
+    };
+
+
+
+#ifdef KNM_TRANSFORMS_TREE_USE_TRANSFORMABLE
+
+    //------------------------------------------------------------------------------------
+    /// @brief  Instances of this class can be associated with the Transforms (to
+    ///         indicates that the Transforms affect this object in particular)
+    ///
+    /// It is expected that your classes inherit from Transformable.
+    ///
+    /// If you want to use another class instead, define the
+    /// KNM_TRANSFORMS_TREE_TRANSFORMABLE_TYPE macro to the fully-qualified name of your
+    /// class.
     ///
     /// If you don't want to use a common base class for all the objects with
     /// transforms, define the KNM_TRANSFORMS_TREE_USE_VOID_PTR_TRANSFORMABLE macro. The
@@ -889,625 +1681,8267 @@ namespace tr2 {
         //--------------------------------------------------------------------------------
         static quat getRotationTo(const vec3& from, const vec3& dest,
                                   const vec3& fallbackAxis = VEC3_ZERO);
+
+        //--------------------------------------------------------------------------------
+        /// @brief  Transforms an array of points by an affine matrix
+        ///
+        /// @remark The loop is written on scalars so that the compiler can vectorize
+        ///         it. 'in' and 'out' can be the same array.
+        //--------------------------------------------------------------------------------
+        static void transformPoints(const mat4& matrix, const vec3* in, vec3* out,
+                                    size_t count);
+
+        //--------------------------------------------------------------------------------
+        /// @brief  Transforms an array of vectors by a 3x3 matrix
+        ///
+        /// @remark The loop is written on scalars so that the compiler can vectorize
+        ///         it. 'in' and 'out' can be the same array.
+        //--------------------------------------------------------------------------------
+        static void transformVectors(const mat3& matrix, const vec3* in, vec3* out,
+                                     size_t count);
+
+        //--------------------------------------------------------------------------------
+        /// @brief  Tests if a ray intersects an axis-aligned box (slab method)
+        ///
+        /// @param  origin      The origin of the ray
+        /// @param  direction   The direction of the ray
+        /// @param  box         The box
+        /// @param  maxDistance The maximum distance along the ray, in units of
+        ///                     'direction'
+        /// @param  distance    The distance at which the ray enters the box, in units
+        ///                     of 'direction' (0 if the origin is inside the box)
+        //--------------------------------------------------------------------------------
+        static bool intersects(const vec3& origin, const vec3& direction,
+                               const aabb_t& box, real maxDistance, real& distance);
+
+        //--------------------------------------------------------------------------------
+        /// @brief  Quantizes a value on a given number of bits
+        ///
+        /// @param  value   The value (clamped to [min, max])
+        /// @param  min     Minimum value
+        /// @param  max     Maximum value
+        /// @param  nbBits  The number of bits (between 1 and 24)
+        /// @return The quantized value
+        //--------------------------------------------------------------------------------
+        static uint32_t quantize(real value, real min, real max, uint32_t nbBits);
+
+        //--------------------------------------------------------------------------------
+        /// @brief  Retrieves a value quantized with quantize()
+        //--------------------------------------------------------------------------------
+        static real dequantize(uint32_t value, real min, real max, uint32_t nbBits);
+
+        //--------------------------------------------------------------------------------
+        /// @brief  Interpolates between two poses
+        ///
+        /// @remark The positions and scales are linearly interpolated, the orientations
+        ///         are spherically interpolated (along the shortest path)
+        ///
+        /// @param  from    The pose at t = 0
+        /// @param  to      The pose at t = 1
+        /// @param  t       The interpolation factor
+        //--------------------------------------------------------------------------------
+        static pose_t interpolate(const pose_t& from, const pose_t& to, real t);
     };
 
 
+    //------------------------------------------------------------------------------------
+    /// @brief  Spatial index (uniform grid) over the world positions of a set of
+    ///         Transforms
+    ///
+    /// The world positions are only read when the index is refreshed, and only for the
+    /// Transforms that were invalidated since the previous refresh (see
+    /// Transforms::getRevision()). The queries are then performed on the positions
+    /// known at the time of the last refresh.
+    ///
+    /// The cells are stored in a hash map, so the grid is unbounded and the memory
+    /// used only depends on the number of non-empty cells.
+    ///
+    /// The Transforms whose world position isn't finite (NaN or infinite coordinates)
+    /// stay in the index, but aren't returned by the queries until they get a finite
+    /// position.
+    ///
+    /// Like everything else in this library, the index doesn't own the Transforms: they
+    /// must be removed from it before being destroyed.
+    //------------------------------------------------------------------------------------
+    class SpatialIndex
+    {
+        //_____ Construction / Destruction __________
+    public:
+        //--------------------------------------------------------------------------------
+        /// @brief  Constructor
+        ///
+        /// @param  cellSize    Size of the cells of the grid (should be close to the
+        ///                     typical radius of the queries)
+        //--------------------------------------------------------------------------------
+        SpatialIndex(real cellSize);
 
-#ifdef KNM_TRANSFORMS_TREE_IMPLEMENTATION
 
-    /*********************************** CONSTANTS **************************************/
+        //_____ Methods __________
+    public:
+        //--------------------------------------------------------------------------------
+        /// @brief  Adds a Transforms to the index
+        //--------------------------------------------------------------------------------
+        void add(Transforms* transforms);
 
-    const vec3 VEC3_ZERO(0.0f, 0.0f, 0.0f);
-    const vec3 VEC3_UNIT_X(1.0f, 0.0f, 0.0f);
-    const vec3 VEC3_UNIT_Y(0.0f, 1.0f, 0.0f);
-    const vec3 VEC3_UNIT_Z(0.0f, 0.0f, 1.0f);
-    const vec3 VEC3_NEGATIVE_UNIT_X(-1.0f, 0.0f, 0.0f);
-    const vec3 VEC3_NEGATIVE_UNIT_Y(0.0f, -1.0f, 0.0f);
-    const vec3 VEC3_NEGATIVE_UNIT_Z(0.0f, 0.0f, -1.0f);
-    const vec3 VEC3_UNIT_SCALE(1.0f, 1.0f, 1.0f);
+        //--------------------------------------------------------------------------------
+        /// @brief  Adds a Transforms and all the ones below it to the index
+        //--------------------------------------------------------------------------------
+        void addHierarchy(Transforms* root);
 
-    const quat QUAT_ZERO(0.0f, 0.0f, 0.0f, 0.0f);
-    const quat QUAT_IDENTITY(1.0f, 0.0f, 0.0f, 0.0f);
+        //--------------------------------------------------------------------------------
+        /// @brief  Removes a Transforms from the index
+        //--------------------------------------------------------------------------------
+        void remove(Transforms* transforms);
 
-    const real PI = real(4.0 * atan(1.0));
+        //--------------------------------------------------------------------------------
+        /// @brief  Removes all the Transforms from the index
+        //--------------------------------------------------------------------------------
+        void clear();
 
+        //--------------------------------------------------------------------------------
+        /// @brief  Indicates if a Transforms is in the index
+        //--------------------------------------------------------------------------------
+        inline bool contains(Transforms* transforms) const
+        {
+            return (m_indices.find(transforms) != m_indices.end());
+        }
 
-    /*************************** CONSTRUCTION / DESTRUCTION *****************************/
+        //--------------------------------------------------------------------------------
+        /// @brief  Returns the number of Transforms in the index
+        //--------------------------------------------------------------------------------
+        inline size_t size() const
+        {
+            return m_entries.size();
+        }
 
-    Transforms::Transforms()
-    : m_parent(nullptr), m_transformable(nullptr),
-      m_position(VEC3_ZERO), m_orientation(QUAT_IDENTITY), m_scale(VEC3_UNIT_SCALE),
-      m_fullPosition(VEC3_ZERO), m_fullOrientation(QUAT_IDENTITY),
-      m_fullScale(VEC3_UNIT_SCALE), m_bDirty(true), m_bInheritOrientation(true),
-      m_bInheritScale(true)
-    {
-    }
+        //--------------------------------------------------------------------------------
+        /// @brief  Gets the size of the cells of the grid
+        //--------------------------------------------------------------------------------
+        inline real getCellSize() const
+        {
+            return m_cellSize;
+        }
 
-    //-----------------------------------------------------------------------
+        //--------------------------------------------------------------------------------
+        /// @brief  Updates the positions of the Transforms invalidated since the last
+        ///         refresh
+        ///
+        /// @remark Only an integer comparison is done for the other Transforms
+        ///
+        /// @return The number of Transforms that were updated
+        //--------------------------------------------------------------------------------
+        size_t refresh();
 
-    Transforms::Transforms(KNM_TRANSFORMS_TREE_TRANSFORMABLE_TYPE* transformable)
-    : m_parent(nullptr), m_transformable(transformable),
-      m_position(VEC3_ZERO), m_orientation(QUAT_IDENTITY), m_scale(VEC3_UNIT_SCALE),
-      m_fullPosition(VEC3_ZERO), m_fullOrientation(QUAT_IDENTITY),
-      m_fullScale(VEC3_UNIT_SCALE), m_bDirty(true), m_bInheritOrientation(true),
-      m_bInheritScale(true)
-    {
-#ifdef KNM_TRANSFORMS_TREE_USE_TRANSFORMABLE
-        assert((transformable == nullptr) || (transformable->getTransforms() == this));
-#endif
-    }
+        //--------------------------------------------------------------------------------
+        /// @brief  Updates the positions of a list of Transforms known to have moved
+        ///
+        /// @remark The Transforms not in the index are ignored
+        //--------------------------------------------------------------------------------
+        void refresh(Transforms* const* nodes, size_t count);
 
-    //-----------------------------------------------------------------------
+        //--------------------------------------------------------------------------------
+        /// @brief  Gets the world position of a Transforms, as known by the index
+        //--------------------------------------------------------------------------------
+        vec3 getPosition(Transforms* transforms) const;
+
+        //--------------------------------------------------------------------------------
+        /// @brief  Finds the Transforms located inside a sphere
+        ///
+        /// @param  center  Center of the sphere
+        /// @param  radius  Radius of the sphere
+        /// @param  result  The list in which the Transforms found are stored (it is
+        ///                 cleared first)
+        /// @return The number of Transforms found
+        //--------------------------------------------------------------------------------
+        size_t queryRadius(const vec3& center, real radius,
+                           std::vector<Transforms*>& result) const;
+
+        //--------------------------------------------------------------------------------
+        /// @brief  Finds the Transforms located inside an axis-aligned box
+        ///
+        /// @param  min     Minimum corner of the box
+        /// @param  max     Maximum corner of the box
+        /// @param  result  The list in which the Transforms found are stored (it is
+        ///                 cleared first)
+        /// @return The number of Transforms found
+        //--------------------------------------------------------------------------------
+        size_t queryBox(const vec3& min, const vec3& max,
+                        std::vector<Transforms*>& result) const;
+
+        //--------------------------------------------------------------------------------
+        /// @brief  Finds the k Transforms nearest to a point
+        ///
+        /// @param  point   The point
+        /// @param  k       The number of Transforms to find
+        /// @param  result  The list in which the Transforms found are stored, sorted
+        ///                 by increasing distance (it is cleared first)
+        /// @return The number of Transforms found (lower than k if the index contains
+        ///         less Transforms)
+        //--------------------------------------------------------------------------------
+        size_t queryNearest(const vec3& point, size_t k,
+                            std::vector<Transforms*>& result) const;
+
+
+        //_____ Internal types __________
+    private:
+        typedef uint64_t cell_key_t;
+
+        struct entry_t
+        {
+            Transforms* transforms;
+            vec3 position;
+            cell_key_t cell;
+            uint32_t revision;
+        };
+
+
+        //_____ Private methods __________
+    private:
+        void collect(const vec3& min, const vec3& max, std::vector<size_t>& indices) const;
+        void getCellCoords(const vec3& position, int32_t* coords) const;
+        cell_key_t getCellKey(const int32_t* coords) const;
+        void insertInCell(size_t index);
+        void removeFromCell(size_t index);
+        void updateEntry(size_t index);
+        void placeEntry(entry_t& entry) const;
+
+
+        //_____ Constants __________
+    private:
+        // Cell of the entries with a non-finite position (never produced by
+        // getCellKey(), which only uses 63 bits)
+        static const cell_key_t NO_CELL = ~cell_key_t(0);
+
+
+        //_____ Attributes __________
+    private:
+        real m_cellSize;
+        real m_invCellSize;
+        std::vector<entry_t> m_entries;
+        std::unordered_map<Transforms*, size_t> m_indices;
+        std::unordered_map<cell_key_t, std::vector<size_t> > m_cells;
+    };
+
+
+    //------------------------------------------------------------------------------------
+    /// @brief  Interest management: tracks the Transforms located around a set of
+    ///         observers
+    ///
+    /// Each time update() is called, the Transforms entering, leaving and changed
+    /// (whose world transforms were invalidated, see Transforms::getRevision()) inside
+    /// the area of each observer since the previous call are computed.
+    ///
+    /// The positions are those known by a spatial index, which must be refreshed
+    /// before calling update().
+    //------------------------------------------------------------------------------------
+    class InterestManager
+    {
+        //_____ Internal types __________
+    public:
+        //--------------------------------------------------------------------------------
+        /// @brief  The changes in the area of an observer
+        //--------------------------------------------------------------------------------
+        struct changes_t
+        {
+            std::vector<Transforms*> entering;  ///< Transforms that entered the area
+            std::vector<Transforms*> leaving;   ///< Transforms that left the area
+            std::vector<Transforms*> changed;   ///< Transforms that stayed in the area
+                                                ///  but whose world transforms changed
+        };
+
+
+        //_____ Construction / Destruction __________
+    public:
+        //--------------------------------------------------------------------------------
+        /// @brief  Constructor
+        ///
+        /// @param  index   The spatial index containing the Transforms of interest
+        //--------------------------------------------------------------------------------
+        InterestManager(const SpatialIndex* index);
+
+
+        //_____ Methods __________
+    public:
+        //--------------------------------------------------------------------------------
+        /// @brief  Adds an observer
+        ///
+        /// @param  observer    The Transforms of the observer
+        /// @param  radius      Radius of the area of interest of the observer
+        //--------------------------------------------------------------------------------
+        void addObserver(Transforms* observer, real radius);
+
+        //--------------------------------------------------------------------------------
+        /// @brief  Removes an observer
+        //--------------------------------------------------------------------------------
+        void removeObserver(Transforms* observer);
+
+        //--------------------------------------------------------------------------------
+        /// @brief  Changes the radius of the area of interest of an observer
+        //--------------------------------------------------------------------------------
+        void setRadius(Transforms* observer, real radius);
+
+        //--------------------------------------------------------------------------------
+        /// @brief  Returns the number of observers
+        //--------------------------------------------------------------------------------
+        inline size_t getNbObservers() const
+        {
+            return m_observers.size();
+        }
+
+        //--------------------------------------------------------------------------------
+        /// @brief  Computes the changes in the areas of all the observers since the
+        ///         previous call
+        //--------------------------------------------------------------------------------
+        void update();
+
+        //--------------------------------------------------------------------------------
+        /// @brief  Gets the changes in the area of an observer computed by the last
+        ///         call to update()
+        //--------------------------------------------------------------------------------
+        const changes_t& getChanges(Transforms* observer) const;
+
+        //--------------------------------------------------------------------------------
+        /// @brief  Gets the Transforms currently in the area of an observer (as of the
+        ///         last call to update())
+        //--------------------------------------------------------------------------------
+        std::vector<Transforms*> getInterest(Transforms* observer) const;
+
+
+        //_____ Internal types __________
+    private:
+        typedef std::pair<Transforms*, uint32_t> interest_t;
+
+        struct observer_t
+        {
+            Transforms* transforms;
+            real radius;
+            std::vector<interest_t> interests;  // Sorted by Transforms
+            changes_t changes;
+        };
+
+
+        //_____ Private methods __________
+    private:
+        void update(observer_t& observer, std::vector<Transforms*>& found,
+                    std::vector<interest_t>& interests);
+
+
+        //_____ Attributes __________
+    private:
+        const SpatialIndex* m_index;
+        std::vector<observer_t> m_observers;
+        std::unordered_map<Transforms*, size_t> m_indices;
+    };
+
+
+    //------------------------------------------------------------------------------------
+    /// @brief  A frustum defined by six planes, used to cull hierarchies of Transforms
+    ///
+    /// The culling is based on the bounds of the Transforms (see
+    /// Transforms::setLocalBounds()): the bounding spheres of the subtree bounds are
+    /// tested several at a time, and the branches of the hierarchy completely outside
+    /// (or inside) of the frustum aren't tested any further.
+    //------------------------------------------------------------------------------------
+    class Frustum
+    {
+        //_____ Construction / Destruction __________
+    public:
+        //--------------------------------------------------------------------------------
+        /// @brief  Constructor
+        ///
+        /// @param  planes  The six planes, as (a, b, c, d) with a point p inside the
+        ///                 frustum if a*p.x + b*p.y + c*p.z + d >= 0 for all the
+        ///                 planes. They don't need to be normalised.
+        //--------------------------------------------------------------------------------
+        Frustum(const vec4* planes);
+
+        //--------------------------------------------------------------------------------
+        /// @brief  Constructor
+        ///
+        /// @param  viewProjection  The view-projection matrix from which the planes
+        ///                         are extracted (OpenGL conventions)
+        //--------------------------------------------------------------------------------
+        Frustum(const mat4& viewProjection);
+
+
+        //_____ Methods __________
+    public:
+        //--------------------------------------------------------------------------------
+        /// @brief  Gets one of the six (normalised) planes of the frustum
+        //--------------------------------------------------------------------------------
+        inline const vec4& getPlane(size_t index) const
+        {
+            assert(index < 6);
+            return m_planes[index];
+        }
+
+        //--------------------------------------------------------------------------------
+        /// @brief  Tests a world-space box against the frustum
+        //--------------------------------------------------------------------------------
+        frustum_test_t test(const aabb_t& box) const;
+
+        //--------------------------------------------------------------------------------
+        /// @brief  Tests several spheres against the frustum
+        ///
+        /// @remark The spheres are given as separate arrays of coordinates, and are
+        ///         tested by batches of 8 (the loops are written so that the compiler
+        ///         can vectorize them)
+        ///
+        /// @param  x, y, z     The coordinates of the centers of the spheres
+        /// @param  radius      The radius of the spheres
+        /// @param  count       The number of spheres
+        /// @param  results     The results of the tests (one per sphere)
+        //--------------------------------------------------------------------------------
+        void testSpheres(const real* x, const real* y, const real* z, const real* radius,
+                         size_t count, frustum_test_t* results) const;
+
+        //--------------------------------------------------------------------------------
+        /// @brief  Finds the Transforms (the root and all the ones below it) whose
+        ///         bounds are visible in the frustum
+        ///
+        /// @param  root        The root of the hierarchy to cull
+        /// @param  visible     The list in which the visible Transforms are stored
+        ///                     (it is cleared first)
+        /// @return The number of visible Transforms
+        //--------------------------------------------------------------------------------
+        size_t cull(Transforms* root, std::vector<Transforms*>& visible) const;
+
+
+        //_____ Private methods __________
+    private:
+        // Buffers used to test the children, one per depth in the hierarchy
+        struct scratch_t
+        {
+            std::vector<real> spheres;
+            std::vector<frustum_test_t> results;
+        };
+
+        void cull(Transforms* transforms, frustum_test_t test, size_t depth,
+                  std::vector<scratch_t>& scratch, std::vector<Transforms*>& visible) const;
+        void addAll(Transforms* transforms, std::vector<Transforms*>& visible) const;
+
+
+        //_____ Attributes __________
+    private:
+        vec4 m_planes[6];
+    };
+
+
+    //------------------------------------------------------------------------------------
+    /// @brief  Interface of the objects notified of the changes of world transforms
+    ///         detected by a ChangeLog
+    ///
+    /// See ChangeLog::addListener()
+    //------------------------------------------------------------------------------------
+    class ChangeListener
+    {
+    public:
+        virtual ~ChangeListener() {}
+
+        //--------------------------------------------------------------------------------
+        /// @brief  Called once per update pass (see ChangeLog::update()) if at least one
+        ///         of the Transforms the listener subscribed to changed
+        ///
+        /// @remark The world transforms of the Transforms are already up-to-date. The
+        ///         Transforms modified by the listener will be reported by the next
+        ///         update pass.
+        ///
+        /// @param  changed     The changed Transforms, parents before their children
+        //--------------------------------------------------------------------------------
+        virtual void onWorldTransformsChanged(const std::vector<Transforms*>& changed) = 0;
+    };
+
+
+    //------------------------------------------------------------------------------------
+    /// @brief  Records, frame after frame, the Transforms whose world transforms changed,
+    ///         so several consumers can retrieve them independently
+    ///
+    /// Each call to update() performs the update pass of the tracked hierarchies (see
+    /// Transforms::updateHierarchy()) and records the changed Transforms as a new
+    /// frame. The last frames are kept in a ring buffer.
+    ///
+    /// Each consumer has a cursor indicating the last frame it read. A consumer that
+    /// didn't read the changes for longer than the history retrieves all the tracked
+    /// Transforms instead.
+    ///
+    /// @remark The Transforms must be untracked before being destroyed, and destroyed
+    ///         Transforms might still be reported by the frames in the history
+    //------------------------------------------------------------------------------------
+    class ChangeLog
+    {
+        //_____ Construction / Destruction __________
+    public:
+        //--------------------------------------------------------------------------------
+        /// @brief  Constructor
+        ///
+        /// @param  historySize     Number of frames kept in the history
+        //--------------------------------------------------------------------------------
+        ChangeLog(size_t historySize = 4);
+
+
+        //_____ Methods __________
+    public:
+        //--------------------------------------------------------------------------------
+        /// @brief  Tracks a hierarchy (the root and all the ones below it)
+        //--------------------------------------------------------------------------------
+        void track(Transforms* root);
+
+        //--------------------------------------------------------------------------------
+        /// @brief  Stops tracking a hierarchy
+        //--------------------------------------------------------------------------------
+        void untrack(Transforms* root);
+
+        //--------------------------------------------------------------------------------
+        /// @brief  Performs the update pass of the tracked hierarchies and records the
+        ///         changed Transforms as a new frame
+        ///
+        /// @return The number of the new frame
+        //--------------------------------------------------------------------------------
+        uint32_t update();
+
+        //--------------------------------------------------------------------------------
+        /// @brief  Returns the number of the last recorded frame (0 before the first
+        ///         call to update())
+        //--------------------------------------------------------------------------------
+        inline uint32_t getFrame() const
+        {
+            return m_frame;
+        }
+
+        //--------------------------------------------------------------------------------
+        /// @brief  Returns the Transforms changed during the last recorded frame
+        //--------------------------------------------------------------------------------
+        inline const std::vector<Transforms*>& getChanges() const
+        {
+            return m_frames[m_frame % m_frames.size()];
+        }
+
+        //--------------------------------------------------------------------------------
+        /// @brief  Adds a consumer
+        ///
+        /// @remark The cursor of the consumer is set to the last recorded frame
+        ///
+        /// @return The identifier of the consumer
+        //--------------------------------------------------------------------------------
+        size_t addConsumer();
+
+        //--------------------------------------------------------------------------------
+        /// @brief  Removes a consumer
+        //--------------------------------------------------------------------------------
+        void removeConsumer(size_t consumer);
+
+        //--------------------------------------------------------------------------------
+        /// @brief  Returns the last frame read by a consumer
+        //--------------------------------------------------------------------------------
+        uint32_t getCursor(size_t consumer) const;
+
+        //--------------------------------------------------------------------------------
+        /// @brief  Retrieves the Transforms changed since the last frame read by a
+        ///         consumer, and moves its cursor to the last recorded frame
+        ///
+        /// @remark Each Transforms is only reported once. If some of the frames to read
+        ///         aren't in the history anymore, all the tracked Transforms are
+        ///         reported.
+        ///
+        /// @param  consumer    The identifier of the consumer
+        /// @param  changed     The list in which the changed Transforms are stored (it
+        ///                     is cleared first)
+        /// @return The number of changed Transforms
+        //--------------------------------------------------------------------------------
+        size_t read(size_t consumer, std::vector<Transforms*>& changed);
+
+        //--------------------------------------------------------------------------------
+        /// @brief  Subscribes a listener to the changes of a Transforms
+        ///
+        /// @remark The listener is notified after the update pass, with all the
+        ///         Transforms it subscribed to that changed. Only the changed Transforms
+        ///         with a subscription cost something.
+        ///
+        /// @param  listener    The listener
+        /// @param  transforms  The Transforms (it must be in a tracked hierarchy)
+        /// @param  subtree     Indicates if the listener must also be notified of the
+        ///                     changes of the Transforms below this one
+        ///
+        /// @remark Listeners can't be added or removed from within
+        ///         ChangeListener::onWorldTransformsChanged()
+        //--------------------------------------------------------------------------------
+        void addListener(ChangeListener* listener, Transforms* transforms,
+                         bool subtree = false);
+
+        //--------------------------------------------------------------------------------
+        /// @brief  Removes the subscription of a listener to the changes of a
+        ///         Transforms
+        //--------------------------------------------------------------------------------
+        void removeListener(ChangeListener* listener, Transforms* transforms);
+
+        //--------------------------------------------------------------------------------
+        /// @brief  Removes all the subscriptions of a listener
+        //--------------------------------------------------------------------------------
+        void removeListener(ChangeListener* listener);
+
+        //--------------------------------------------------------------------------------
+        /// @brief  Sets the constraints evaluated at the beginning of each update pass
+        ///
+        /// @param  constraints The constraints (nullptr to remove them)
+        //--------------------------------------------------------------------------------
+        inline void setConstraints(ConstraintSolver* constraints)
+        {
+            m_constraints = constraints;
+        }
+
+        //--------------------------------------------------------------------------------
+        /// @brief  Returns the constraints evaluated at the beginning of each update pass
+        //--------------------------------------------------------------------------------
+        inline ConstraintSolver* getConstraints() const
+        {
+            return m_constraints;
+        }
+
+
+        //_____ Internal types __________
+    private:
+        struct consumer_t
+        {
+            uint32_t cursor;
+            bool used;
+        };
+
+        struct subscription_t
+        {
+            size_t listener;    // Slot of the listener in m_listeners
+            bool subtree;
+        };
+
+        struct listener_t
+        {
+            ChangeListener* listener;   // nullptr if the slot is free
+            size_t nbSubscriptions;
+            std::vector<Transforms*> changed;
+        };
+
+
+        //_____ Private methods __________
+    private:
+        void addAll(Transforms* transforms, std::vector<Transforms*>& result) const;
+        void notifyListeners();
+        void notify(size_t listener, Transforms* transforms);
+        void removeSubscription(Transforms* transforms, const subscription_t& subscription);
+
+
+        //_____ Attributes __________
+    private:
+        std::vector<Transforms*> m_roots;
+        std::vector<std::vector<Transforms*>> m_frames;
+        std::vector<consumer_t> m_consumers;
+        uint32_t m_frame;
+
+        // Listeners
+        std::unordered_map<Transforms*, std::vector<subscription_t>> m_subscriptions;
+        std::vector<listener_t> m_listeners;
+        std::unordered_map<ChangeListener*, size_t> m_listenerSlots;
+
+        ConstraintSolver* m_constraints;
+    };
+
+
+    //------------------------------------------------------------------------------------
+    /// @brief  Evaluates constraints which compute the world transforms of Transforms
+    ///         from the ones of other Transforms (their targets)
+    ///
+    /// The constraints are evaluated in dependency order: a constraint is evaluated
+    /// after the ones of the ancestors of its Transforms, and after the ones that
+    /// modify its targets or their ancestors, so each constrained Transforms is only
+    /// written once per evaluation. The constraints that are part of a dependency
+    /// cycle (or that depend on one) aren't evaluated.
+    ///
+    /// Each Transforms can have at most one constraint. The constrained Transforms must
+    /// be removed from the solver before being destroyed, and the targets must outlive
+    /// the constraints using them.
+    ///
+    /// The constraints can be evaluated as part of the update pass of a ChangeLog (see
+    /// ChangeLog::setConstraints()).
+    //------------------------------------------------------------------------------------
+    class ConstraintSolver
+    {
+        //_____ Methods __________
+    public:
+        //--------------------------------------------------------------------------------
+        /// @brief  Makes an axis of a Transforms point toward a target
+        ///
+        /// @param  transforms  The constrained Transforms
+        /// @param  target      The target
+        /// @param  aimAxis     The axis pointing toward the target, in the space of the
+        ///                     constrained Transforms
+        /// @param  upAxis      The axis kept as close as possible to 'worldUp', in the
+        ///                     space of the constrained Transforms
+        /// @param  worldUp     The up direction, in world space
+        //--------------------------------------------------------------------------------
+        void addAimConstraint(Transforms* transforms, Transforms* target,
+                              const vec3& aimAxis = VEC3_NEGATIVE_UNIT_Z,
+                              const vec3& upAxis = VEC3_UNIT_Y,
+                              const vec3& worldUp = VEC3_UNIT_Y);
+
+        //--------------------------------------------------------------------------------
+        /// @brief  Sets the world position of a Transforms to the weighted average of
+        ///         the ones of targets
+        ///
+        /// @param  transforms  The constrained Transforms
+        /// @param  targets     The targets
+        /// @param  weights     The weight of each target (nullptr for equal weights). The
+        ///                     Transforms is left untouched if they sum to 0.
+        /// @param  count       The number of targets
+        //--------------------------------------------------------------------------------
+        void addPositionConstraint(Transforms* transforms, Transforms* const* targets,
+                                   const real* weights, size_t count);
+
+        //--------------------------------------------------------------------------------
+        /// @brief  Sets the world orientation of a Transforms to the weighted blend of
+        ///         the ones of targets
+        ///
+        /// @param  transforms  The constrained Transforms
+        /// @param  targets     The targets
+        /// @param  weights     The weight of each target (nullptr for equal weights). The
+        ///                     Transforms is left untouched if they sum to 0.
+        /// @param  count       The number of targets
+        //--------------------------------------------------------------------------------
+        void addOrientationConstraint(Transforms* transforms, Transforms* const* targets,
+                                      const real* weights, size_t count);
+
+        //--------------------------------------------------------------------------------
+        /// @brief  Makes a Transforms follow targets as if it was their child
+        ///
+        /// @remark The offsets between the Transforms and each target are the ones at
+        ///         the time of the call. The world positions and orientations obtained
+        ///         for each target are blended using their weights.
+        ///
+        /// @param  transforms  The constrained Transforms
+        /// @param  targets     The targets
+        /// @param  weights     The weight of each target (nullptr for equal weights). The
+        ///                     Transforms is left untouched if they sum to 0.
+        /// @param  count       The number of targets
+        //--------------------------------------------------------------------------------
+        void addParentConstraint(Transforms* transforms, Transforms* const* targets,
+                                 const real* weights, size_t count);
+
+        //--------------------------------------------------------------------------------
+        /// @brief  Removes the constraint of a Transforms
+        //--------------------------------------------------------------------------------
+        void removeConstraint(Transforms* transforms);
+
+        //--------------------------------------------------------------------------------
+        /// @brief  Indicates if a Transforms has a constraint
+        //--------------------------------------------------------------------------------
+        bool hasConstraint(Transforms* transforms) const;
+
+        //--------------------------------------------------------------------------------
+        /// @brief  Returns the number of constraints
+        //--------------------------------------------------------------------------------
+        inline size_t getNbConstraints() const
+        {
+            return m_constraints.size();
+        }
+
+        //--------------------------------------------------------------------------------
+        /// @brief  Evaluates all the constraints, in dependency order
+        ///
+        /// @return 'false' if some constraints couldn't be evaluated because of a
+        ///         dependency cycle (see getCyclicTransforms())
+        //--------------------------------------------------------------------------------
+        bool evaluate();
+
+        //--------------------------------------------------------------------------------
+        /// @brief  Returns the constrained Transforms, in the order they were evaluated
+        ///         by the last call to evaluate()
+        //--------------------------------------------------------------------------------
+        inline const std::vector<Transforms*>& getEvaluationOrder() const
+        {
+            return m_order;
+        }
+
+        //--------------------------------------------------------------------------------
+        /// @brief  Returns the constrained Transforms that weren't evaluated by the last
+        ///         call to evaluate(), because they are part of a dependency cycle or
+        ///         depend on one
+        //--------------------------------------------------------------------------------
+        inline const std::vector<Transforms*>& getCyclicTransforms() const
+        {
+            return m_cyclic;
+        }
+
+
+        //_____ Internal types __________
+    private:
+        enum constraint_type_t
+        {
+            CT_AIM,
+            CT_POSITION,
+            CT_ORIENTATION,
+            CT_PARENT
+        };
+
+        struct constraint_t
+        {
+            constraint_type_t type;
+            Transforms* transforms;
+            std::vector<Transforms*> targets;
+            std::vector<real> weights;      // Normalised
+            bool active;                    // 'false' if the weights sum to 0
+            std::vector<pose_t> offsets;    // Parent constraints only
+            vec3 aimAxis;
+            vec3 upAxis;
+            vec3 worldUp;
+        };
+
+
+        //_____ Private methods __________
+    private:
+        constraint_t& add(constraint_type_t type, Transforms* transforms,
+                          Transforms* const* targets, const real* weights, size_t count);
+        void sort();
+        void addDependencies(size_t constraint, Transforms* transforms);
+        void apply(const constraint_t& constraint);
+
+
+        //_____ Attributes __________
+    private:
+        std::vector<constraint_t> m_constraints;
+        std::unordered_map<Transforms*, size_t> m_indices;
+
+        // Results of the last evaluation
+        std::vector<Transforms*> m_order;
+        std::vector<Transforms*> m_cyclic;
+
+        // Buffers reused by the sort
+        std::vector<std::vector<size_t>> m_dependents;
+        std::vector<size_t> m_nbDependencies;
+        std::vector<size_t> m_ready;
+    };
+
+
+    //------------------------------------------------------------------------------------
+    /// @brief  Records the modifications of the structure of hierarchies of Transforms
+    ///         (see Transforms::setJournal())
+    ///
+    /// Each event has a sequence number, so the systems deriving data from the
+    /// hierarchies can only apply the events recorded since the last one they
+    /// processed.
+    ///
+    /// The journal is bounded: the oldest events are discarded when it is full. A
+    /// system that didn't read the events for too long must then rebuild its data
+    /// (see hasOverflowed()).
+    //------------------------------------------------------------------------------------
+    class StructureJournal
+    {
+        //_____ Construction / Destruction __________
+    public:
+        //--------------------------------------------------------------------------------
+        /// @brief  Constructor
+        ///
+        /// @param  capacity    Maximum number of events kept in the journal
+        //--------------------------------------------------------------------------------
+        StructureJournal(size_t capacity = 1024);
+
+
+        //_____ Methods __________
+    public:
+        //--------------------------------------------------------------------------------
+        /// @brief  Records an event
+        ///
+        /// @remark Called by the Transforms using the journal
+        //--------------------------------------------------------------------------------
+        void record(structure_event_type_t type, Transforms* transforms,
+                    Transforms* parent, Transforms* previousParent,
+                    const std::string& tag = "");
+
+        //--------------------------------------------------------------------------------
+        /// @brief  Returns the sequence number of the last recorded event (0 if none)
+        //--------------------------------------------------------------------------------
+        inline uint64_t getSequence() const
+        {
+            return m_sequence;
+        }
+
+        //--------------------------------------------------------------------------------
+        /// @brief  Returns the maximum number of events kept in the journal
+        //--------------------------------------------------------------------------------
+        inline size_t getCapacity() const
+        {
+            return m_events.size();
+        }
+
+        //--------------------------------------------------------------------------------
+        /// @brief  Indicates if some of the events recorded after a given one were
+        ///         discarded
+        ///
+        /// @param  sequence    Sequence number of the last event processed (0 if none)
+        //--------------------------------------------------------------------------------
+        bool hasOverflowed(uint64_t sequence) const;
+
+        //--------------------------------------------------------------------------------
+        /// @brief  Retrieves the events recorded after a given one
+        ///
+        /// @remark Only the events still in the journal are retrieved, see
+        ///         hasOverflowed()
+        ///
+        /// @param  sequence    Sequence number of the last event processed (0 if none)
+        /// @param  events      The list in which the events are stored, oldest first (it
+        ///                     is cleared first)
+        /// @return The number of events
+        //--------------------------------------------------------------------------------
+        size_t read(uint64_t sequence, std::vector<structure_event_t>& events) const;
+
+
+        //_____ Attributes __________
+    private:
+        std::vector<structure_event_t> m_events;    // Ring buffer
+        uint64_t m_sequence;
+    };
+
+
+    //------------------------------------------------------------------------------------
+    /// @brief  Saves hierarchies of Transforms as binary snapshots
+    ///
+    /// A snapshot is made of a header followed by flat arrays (one value per
+    /// Transforms, parents before their children), all 4-bytes aligned and in the
+    /// native byte order, so it can be used directly from memory (for instance from a
+    /// memory-mapped file) by a SnapshotReader. Snapshots written on a machine with a
+    /// different byte order are rejected by the readers (see ENDIANNESS).
+    ///
+    ///   - header: magic number, version, number of Transforms, flags, number of
+    ///     interned tags, number of tag references, size of the strings, byte order
+    ///     marker (8 x uint32)
+    ///   - parent indices (int32, -1 for the roots)
+    ///   - Transforms flags (uint32: inherit orientation, inherit scale)
+    ///   - index of the first tag reference of each Transforms (uint32, n + 1 values)
+    ///   - tag references (uint32 indices of interned tags)
+    ///   - offsets of the interned tags (uint32, number of tags + 1 values)
+    ///   - interned tags (characters, padded to 4 bytes)
+    ///   - local positions (3 floats), orientations (4 floats: x, y, z, w) and scales
+    ///     (3 floats)
+    ///   - optionally, the world positions, orientations and scales
+    //------------------------------------------------------------------------------------
+    class SnapshotWriter
+    {
+        //_____ Constants __________
+    public:
+        static const uint32_t MAGIC;        ///< Magic number at the start of the snapshots
+        static const uint32_t VERSION;      ///< Version of the format
+        static const uint32_t ENDIANNESS;   ///< Byte order marker (native byte order)
+
+        //--------------------------------------------------------------------------------
+        /// @brief  Flags of the snapshots
+        //--------------------------------------------------------------------------------
+        enum
+        {
+            SF_WORLD_TRANSFORMS = 1 << 0,   ///< The world transforms are included
+        };
+
+
+        //_____ Methods __________
+    public:
+        //--------------------------------------------------------------------------------
+        /// @brief  Writes a snapshot of hierarchies of Transforms into a stream
+        ///
+        /// @remark The snapshot is written array after array, without being built in
+        ///         memory first
+        ///
+        /// @param  roots           The roots of the hierarchies
+        /// @param  nbRoots         The number of roots
+        /// @param  stream          The stream
+        /// @param  worldTransforms Indicates if the world transforms must be included
+        /// @return 'false' if the stream failed
+        //--------------------------------------------------------------------------------
+        static bool write(Transforms* const* roots, size_t nbRoots, std::ostream& stream,
+                          bool worldTransforms = false);
+
+        //--------------------------------------------------------------------------------
+        /// @brief  Writes a snapshot of hierarchies of Transforms into a buffer
+        ///
+        /// @param  roots           The roots of the hierarchies
+        /// @param  nbRoots         The number of roots
+        /// @param  buffer          The buffer (it is cleared first)
+        /// @param  worldTransforms Indicates if the world transforms must be included
+        //--------------------------------------------------------------------------------
+        static void write(Transforms* const* roots, size_t nbRoots,
+                          std::vector<uint8_t>& buffer, bool worldTransforms = false);
+
+
+        //_____ Private methods __________
+    private:
+        static void write(Transforms* const* roots, size_t nbRoots, bool worldTransforms,
+                          const std::function<void(const void*, size_t)>& output);
+    };
+
+
+    //------------------------------------------------------------------------------------
+    /// @brief  Reads binary snapshots of hierarchies of Transforms (see SnapshotWriter)
+    ///         and restores them
+    //------------------------------------------------------------------------------------
+    class SnapshotReader
+    {
+        //_____ Construction / Destruction __________
+    public:
+        //--------------------------------------------------------------------------------
+        /// @brief  Constructor
+        //--------------------------------------------------------------------------------
+        SnapshotReader();
+
+
+        //_____ Methods __________
+    public:
+        //--------------------------------------------------------------------------------
+        /// @brief  Uses a snapshot located in memory
+        ///
+        /// @remark The data isn't copied, so it must stay valid while the reader is
+        ///         used. It must be 4-bytes aligned.
+        ///
+        /// @param  data    The snapshot
+        /// @param  size    The size of the snapshot, in bytes
+        /// @return 'false' if the data isn't a valid snapshot
+        //--------------------------------------------------------------------------------
+        bool open(const void* data, size_t size);
+
+        //--------------------------------------------------------------------------------
+        /// @brief  Reads a snapshot from a stream (into a buffer owned by the reader)
+        ///
+        /// @return 'false' if the stream failed or doesn't contain a valid snapshot
+        //--------------------------------------------------------------------------------
+        bool read(std::istream& stream);
+
+        //--------------------------------------------------------------------------------
+        /// @brief  Indicates if a valid snapshot was opened or read
+        //--------------------------------------------------------------------------------
+        inline bool isValid() const
+        {
+            return (m_header != nullptr);
+        }
+
+        //--------------------------------------------------------------------------------
+        /// @brief  Returns the number of Transforms in the snapshot
+        //--------------------------------------------------------------------------------
+        size_t getNbNodes() const;
+
+        //--------------------------------------------------------------------------------
+        /// @brief  Returns the parent indices (-1 for the roots)
+        //--------------------------------------------------------------------------------
+        inline const int32_t* getParents() const
+        {
+            return m_parents;
+        }
+
+        //--------------------------------------------------------------------------------
+        /// @brief  Gets the local transforms of a Transforms
+        //--------------------------------------------------------------------------------
+        pose_t getPose(size_t index) const;
+
+        //--------------------------------------------------------------------------------
+        /// @brief  Indicates if the snapshot contains the world transforms
+        //--------------------------------------------------------------------------------
+        inline bool hasWorldTransforms() const
+        {
+            return (m_worldPositions != nullptr);
+        }
+
+        //--------------------------------------------------------------------------------
+        /// @brief  Gets the world transforms of a Transforms (only if
+        ///         hasWorldTransforms() returns 'true')
+        //--------------------------------------------------------------------------------
+        pose_t getWorldPose(size_t index) const;
+
+        //--------------------------------------------------------------------------------
+        /// @brief  Indicates if a Transforms inherits the orientation of its parent
+        //--------------------------------------------------------------------------------
+        bool inheritOrientation(size_t index) const;
+
+        //--------------------------------------------------------------------------------
+        /// @brief  Indicates if a Transforms inherits the scale of its parent
+        //--------------------------------------------------------------------------------
+        bool inheritScale(size_t index) const;
+
+        //--------------------------------------------------------------------------------
+        /// @brief  Gets the tags of a Transforms
+        //--------------------------------------------------------------------------------
+        std::vector<std::string> getTags(size_t index) const;
+
+        //--------------------------------------------------------------------------------
+        /// @brief  Restores the hierarchies of the snapshot
+        ///
+        /// @remark The hierarchies are built using Transforms::buildHierarchy(), so
+        ///         the Transforms must have neither parent nor children
+        ///
+        /// @param  nodes   The Transforms to use (getNbNodes() of them, in the order of
+        ///                 the snapshot)
+        //--------------------------------------------------------------------------------
+        void restore(Transforms* const* nodes) const;
+
+
+        //_____ Private methods __________
+    private:
+        bool parse(const uint32_t* data, size_t size);
+        static pose_t getPose(const float* positions, const float* orientations,
+                              const float* scales, size_t index);
+
+
+        //_____ Attributes __________
+    private:
+        std::vector<uint32_t> m_buffer;     // Only used when reading from a stream
+
+        const uint32_t* m_header;
+        const int32_t* m_parents;
+        const uint32_t* m_flags;
+        const uint32_t* m_tagStarts;
+        const uint32_t* m_tagRefs;
+        const uint32_t* m_stringOffsets;
+        const char* m_strings;
+        const float* m_positions;
+        const float* m_orientations;
+        const float* m_scales;
+        const float* m_worldPositions;
+        const float* m_worldOrientations;
+        const float* m_worldScales;
+    };
+
+
+    //------------------------------------------------------------------------------------
+    /// @brief  Writes values on an arbitrary number of bits into a buffer
+    //------------------------------------------------------------------------------------
+    class BitWriter
+    {
+    public:
+        //--------------------------------------------------------------------------------
+        /// @brief  Constructor
+        ///
+        /// @param  buffer  The buffer to which the bytes are appended
+        //--------------------------------------------------------------------------------
+        BitWriter(std::vector<uint8_t>& buffer);
+
+        //--------------------------------------------------------------------------------
+        /// @brief  Writes a value
+        ///
+        /// @param  value   The value
+        /// @param  nbBits  The number of bits to write (at most 32)
+        //--------------------------------------------------------------------------------
+        void write(uint32_t value, uint32_t nbBits);
+
+        //--------------------------------------------------------------------------------
+        /// @brief  Writes the remaining bits (the last byte is padded with zeros)
+        //--------------------------------------------------------------------------------
+        void flush();
+
+    private:
+        std::vector<uint8_t>& m_buffer;
+        uint64_t m_bits;
+        uint32_t m_nbBits;
+    };
+
+
+    //------------------------------------------------------------------------------------
+    /// @brief  Reads values written by a BitWriter
+    //------------------------------------------------------------------------------------
+    class BitReader
+    {
+    public:
+        //--------------------------------------------------------------------------------
+        /// @brief  Constructor
+        //--------------------------------------------------------------------------------
+        BitReader(const uint8_t* data, size_t size);
+
+        //--------------------------------------------------------------------------------
+        /// @brief  Reads a value
+        ///
+        /// @param  nbBits  The number of bits to read (at most 32)
+        /// @param  value   The value read
+        /// @return 'false' if there isn't enough data left
+        //--------------------------------------------------------------------------------
+        bool read(uint32_t nbBits, uint32_t& value);
+
+    private:
+        const uint8_t* m_data;
+        size_t m_size;
+        size_t m_offset;
+        uint64_t m_bits;
+        uint32_t m_nbBits;
+    };
+
+
+    //------------------------------------------------------------------------------------
+    /// @brief  Encodes the changes of the transforms (relative to their parent) of a
+    ///         set of Transforms into compact messages, to be applied by a
+    ///         ReplicationDecoder
+    ///
+    /// Both sides use the same list of Transforms: their index in the list is their
+    /// identifier in the messages, bit-packed on the minimal number of bits.
+    ///
+    /// The encoder remembers the last values sent for each Transforms (the baseline),
+    /// and only sends the quantized components (position, orientation, scale) that
+    /// differ from it. The messages must therefore be delivered reliably and in order
+    /// (call reset() to send everything again).
+    ///
+    /// The positions are quantized in a box, the orientations are encoded with the
+    /// "smallest three" method (the largest component is dropped and recomputed by the
+    /// decoder) and the scales are sent as raw floats.
+    //------------------------------------------------------------------------------------
+    class ReplicationEncoder
+    {
+        //_____ Construction / Destruction __________
+    public:
+        //--------------------------------------------------------------------------------
+        /// @brief  Constructor
+        ///
+        /// @param  nodes       The replicated Transforms
+        /// @param  count       The number of Transforms
+        /// @param  settings    The settings of the replication
+        //--------------------------------------------------------------------------------
+        ReplicationEncoder(Transforms* const* nodes, size_t count,
+                           const replication_settings_t& settings = replication_settings_t());
+
+
+        //_____ Methods __________
+    public:
+        //--------------------------------------------------------------------------------
+        /// @brief  Encodes the changes of some Transforms
+        ///
+        /// @param  changed     The Transforms that might have changed (for instance
+        ///                     retrieved from a ChangeLog)
+        /// @param  count       The number of Transforms
+        /// @param  message     The buffer in which the message is written (it is cleared
+        ///                     first)
+        /// @return The number of Transforms in the message
+        //--------------------------------------------------------------------------------
+        size_t encode(Transforms* const* changed, size_t count,
+                      std::vector<uint8_t>& message);
+
+        //--------------------------------------------------------------------------------
+        /// @brief  Forgets the baseline, so all the components of the Transforms are
+        ///         sent by the next messages
+        //--------------------------------------------------------------------------------
+        void reset();
+
+        //--------------------------------------------------------------------------------
+        /// @brief  Returns the statistics about the encoded messages
+        //--------------------------------------------------------------------------------
+        inline const replication_stats_t& getStatistics() const
+        {
+            return m_stats;
+        }
+
+
+        //_____ Internal types __________
+    private:
+        struct baseline_t
+        {
+            uint32_t position[3];
+            uint32_t orientation[4];    // Index of the dropped component, then the others
+            real scale[3];
+            bool valid;
+        };
+
+
+        //_____ Attributes __________
+    private:
+        replication_settings_t m_settings;
+        std::unordered_map<Transforms*, uint32_t> m_identifiers;
+        std::vector<baseline_t> m_baselines;
+        uint32_t m_identifierBits;
+        replication_stats_t m_stats;
+    };
+
+
+    //------------------------------------------------------------------------------------
+    /// @brief  Applies the messages produced by a ReplicationEncoder
+    //------------------------------------------------------------------------------------
+    class ReplicationDecoder
+    {
+        //_____ Construction / Destruction __________
+    public:
+        //--------------------------------------------------------------------------------
+        /// @brief  Constructor
+        ///
+        /// @param  nodes       The replicated Transforms, in the same order than on the
+        ///                     encoder side
+        /// @param  count       The number of Transforms
+        /// @param  settings    The settings of the replication
+        //--------------------------------------------------------------------------------
+        ReplicationDecoder(Transforms* const* nodes, size_t count,
+                           const replication_settings_t& settings = replication_settings_t());
+
+
+        //_____ Methods __________
+    public:
+        //--------------------------------------------------------------------------------
+        /// @brief  Applies a message
+        ///
+        /// @remark The message is entirely decoded before being applied (in one batch,
+        ///         see Transforms::setTransforms()), so an invalid message doesn't
+        ///         modify anything
+        ///
+        /// @param  message     The message
+        /// @param  size        The size of the message, in bytes
+        /// @return 'false' if the message is invalid
+        //--------------------------------------------------------------------------------
+        bool decode(const uint8_t* message, size_t size);
+
+        //--------------------------------------------------------------------------------
+        /// @brief  Returns the statistics about the decoded messages
+        //--------------------------------------------------------------------------------
+        inline const replication_stats_t& getStatistics() const
+        {
+            return m_stats;
+        }
+
+
+        //_____ Attributes __________
+    private:
+        replication_settings_t m_settings;
+        std::vector<Transforms*> m_nodes;
+        uint32_t m_identifierBits;
+        replication_stats_t m_stats;
+
+        // Buffers reused by all the messages
+        std::vector<Transforms*> m_changed;
+        std::vector<pose_t> m_poses;
+    };
+
+
+    //------------------------------------------------------------------------------------
+    /// @brief  Keeps the recent world transforms of Transforms, to retrieve them as they
+    ///         were at a past time (for instance for lag compensation)
+    ///
+    /// At each tick, only the world transforms of the Transforms that changed are
+    /// recorded (see ChangeLog): a Transforms is supposed to keep its last recorded
+    /// transforms until the next ones. The Transforms that never changed cost nothing,
+    /// and at most 'depth' samples are kept per Transforms.
+    ///
+    /// The queries interpolate between the samples surrounding the requested time
+    /// (linear interpolation of the positions and scales, spherical linear
+    /// interpolation of the orientations).
+    //------------------------------------------------------------------------------------
+    class TransformsHistory
+    {
+        //_____ Construction / Destruction __________
+    public:
+        //--------------------------------------------------------------------------------
+        /// @brief  Constructor
+        ///
+        /// @param  depth   Number of ticks kept in the history
+        //--------------------------------------------------------------------------------
+        TransformsHistory(size_t depth = 64);
+
+
+        //_____ Methods __________
+    public:
+        //--------------------------------------------------------------------------------
+        /// @brief  Records the world transforms of the Transforms that changed during a
+        ///         tick
+        ///
+        /// @param  time    The time of the tick (must be greater than the one of the
+        ///                 previous tick)
+        /// @param  changed The Transforms that changed since the previous tick
+        /// @param  count   The number of Transforms
+        //--------------------------------------------------------------------------------
+        void record(double time, Transforms* const* changed, size_t count);
+
+        //--------------------------------------------------------------------------------
+        /// @brief  Records the world transforms of the Transforms that changed during
+        ///         the last frame of a change log
+        ///
+        /// @param  time    The time of the tick
+        /// @param  log     The change log (after its update)
+        //--------------------------------------------------------------------------------
+        inline void record(double time, const ChangeLog& log)
+        {
+            const std::vector<Transforms*>& changed = log.getChanges();
+            record(time, changed.data(), changed.size());
+        }
+
+        //--------------------------------------------------------------------------------
+        /// @brief  Returns the time of the oldest tick in the history
+        //--------------------------------------------------------------------------------
+        double getOldestTime() const;
+
+        //--------------------------------------------------------------------------------
+        /// @brief  Returns the time of the most recent tick in the history
+        //--------------------------------------------------------------------------------
+        double getNewestTime() const;
+
+        //--------------------------------------------------------------------------------
+        /// @brief  Returns the number of Transforms with recorded samples
+        //--------------------------------------------------------------------------------
+        inline size_t getNbTracked() const
+        {
+            return m_tracks.size();
+        }
+
+        //--------------------------------------------------------------------------------
+        /// @brief  Gets the world transforms of a Transforms at a given time
+        ///
+        /// @param  transforms  The Transforms
+        /// @param  time        The time (clamped to the most recent tick)
+        /// @param  pose        The world transforms
+        /// @return 'false' if the time is older than the history, or if the Transforms
+        ///         wasn't recorded yet at that time
+        //--------------------------------------------------------------------------------
+        bool getWorldTransforms(Transforms* transforms, double time, pose_t& pose) const;
+
+        //--------------------------------------------------------------------------------
+        /// @brief  Gets the transforms of a Transforms relative to another one, at a
+        ///         given time
+        ///
+        /// @param  transforms  The Transforms
+        /// @param  reference   The Transforms in the space of which the transforms are
+        ///                     expressed
+        /// @param  time        The time (clamped to the most recent tick)
+        /// @param  pose        The transforms, relative to 'reference'
+        /// @return 'false' if the world transforms of one of the Transforms aren't
+        ///         known at that time
+        //--------------------------------------------------------------------------------
+        bool getRelativeTransforms(Transforms* transforms, Transforms* reference,
+                                   double time, pose_t& pose) const;
+
+        //--------------------------------------------------------------------------------
+        /// @brief  Removes the samples of a Transforms (for instance before its
+        ///         destruction)
+        //--------------------------------------------------------------------------------
+        void forget(Transforms* transforms);
+
+        //--------------------------------------------------------------------------------
+        /// @brief  Removes all the samples
+        //--------------------------------------------------------------------------------
+        void clear();
+
+
+        //_____ Internal types __________
+    private:
+        struct sample_t
+        {
+            double time;
+            pose_t pose;
+        };
+
+        // Ring buffer of samples, oldest first
+        struct track_t
+        {
+            std::vector<sample_t> samples;
+            size_t start;
+        };
+
+
+        //_____ Attributes __________
+    private:
+        size_t m_depth;
+        std::vector<double> m_times;    // Ring buffer of the times of the ticks
+        size_t m_nbTicks;
+        std::unordered_map<Transforms*, track_t> m_tracks;
+    };
+
+
+    //------------------------------------------------------------------------------------
+    /// @brief  Interpolates the world transforms of Transforms between the two last
+    ///         simulation ticks, for rendering at a higher rate than the simulation
+    ///
+    /// capture() must be called after each simulation tick: it retains the previous
+    /// world transforms of the Transforms that changed (see Transforms::getRevision())
+    /// and builds a compact list of the moving ones. sample() then only computes the
+    /// interpolated transforms of those.
+    //------------------------------------------------------------------------------------
+    class RenderInterpolator
+    {
+        //_____ Construction / Destruction __________
+    public:
+        //--------------------------------------------------------------------------------
+        /// @brief  Constructor
+        //--------------------------------------------------------------------------------
+        RenderInterpolator();
+
+
+        //_____ Methods __________
+    public:
+        //--------------------------------------------------------------------------------
+        /// @brief  Adds Transforms to interpolate
+        ///
+        /// @remark Their index in the output of sample() is their order of addition
+        //--------------------------------------------------------------------------------
+        void add(Transforms* const* nodes, size_t count);
+
+        //--------------------------------------------------------------------------------
+        /// @brief  Returns the number of interpolated Transforms
+        //--------------------------------------------------------------------------------
+        inline size_t size() const
+        {
+            return m_nodes.size();
+        }
+
+        //--------------------------------------------------------------------------------
+        /// @brief  Retrieves the world transforms of the Transforms, after a simulation
+        ///         tick
+        //--------------------------------------------------------------------------------
+        void capture();
+
+        //--------------------------------------------------------------------------------
+        /// @brief  Returns the number of Transforms that changed during the last tick
+        //--------------------------------------------------------------------------------
+        inline size_t getNbMoving() const
+        {
+            return m_movingIndices.size();
+        }
+
+        //--------------------------------------------------------------------------------
+        /// @brief  Computes the interpolated world transforms of the Transforms
+        ///
+        /// @remark Only the Transforms that changed during the last tick (and those that
+        ///         stopped changing) are written, so the same output array must be used
+        ///         for all the calls. The orientations are normalised-linearly
+        ///         interpolated (nlerp), which is accurate enough for the small rotations
+        ///         between two ticks and much cheaper than slerp.
+        ///
+        /// @param  alpha   Interpolation factor between the previous tick (0) and the
+        ///                 last one (1)
+        /// @param  out     The interpolated world transforms (size() of them)
+        //--------------------------------------------------------------------------------
+        void sample(real alpha, pose_t* out);
+
+
+        //_____ Attributes __________
+    private:
+        std::vector<Transforms*> m_nodes;
+        std::vector<uint32_t> m_revisions;
+        std::vector<pose_t> m_current;
+        std::vector<uint8_t> m_moving;
+
+        // Compact arrays of the moving Transforms
+        std::vector<size_t> m_movingIndices;
+        std::vector<pose_t> m_movingPrevious;
+        std::vector<pose_t> m_movingCurrent;
+
+        // Transforms whose final transforms must be written by the next sample()
+        std::vector<size_t> m_settled;
+    };
+
+
+    //------------------------------------------------------------------------------------
+    /// @brief  Keeps the current and previous world matrices of Transforms (for
+    ///         instance to compute motion vectors)
+    ///
+    /// The matrices are stored in pairs in a contiguous buffer, and each Transforms
+    /// knows its slot in it, so no lookup is needed to retrieve them.
+    ///
+    /// update() must be called after each update pass, with the changed Transforms:
+    /// only their matrices are copied. The previous matrix of a Transforms that didn't
+    /// change during the last frame is its current one.
+    //------------------------------------------------------------------------------------
+    class MotionMatrices
+    {
+        //_____ Construction / Destruction __________
+    public:
+        //--------------------------------------------------------------------------------
+        /// @brief  Constructor
+        //--------------------------------------------------------------------------------
+        MotionMatrices();
+
+        //--------------------------------------------------------------------------------
+        /// @brief  Destructor
+        //--------------------------------------------------------------------------------
+        ~MotionMatrices();
+
+
+        //_____ Methods __________
+    public:
+        //--------------------------------------------------------------------------------
+        /// @brief  Adds Transforms (a Transforms can only be in one MotionMatrices)
+        //--------------------------------------------------------------------------------
+        void add(Transforms* const* nodes, size_t count);
+
+        //--------------------------------------------------------------------------------
+        /// @brief  Removes a Transforms (done automatically when it is destroyed)
+        //--------------------------------------------------------------------------------
+        void remove(Transforms* transforms);
+
+        //--------------------------------------------------------------------------------
+        /// @brief  Indicates if a Transforms was added
+        //--------------------------------------------------------------------------------
+        inline bool contains(Transforms* transforms) const
+        {
+            return (transforms->m_motion == this);
+        }
+
+        //--------------------------------------------------------------------------------
+        /// @brief  Returns the number of Transforms
+        //--------------------------------------------------------------------------------
+        inline size_t size() const
+        {
+            return m_pairs.size() - m_freeSlots.size();
+        }
+
+        //--------------------------------------------------------------------------------
+        /// @brief  Starts a new frame, and updates the matrices of the Transforms that
+        ///         changed during the last update pass
+        ///
+        /// @param  changed The changed Transforms (the ones not added are ignored)
+        /// @param  count   The number of Transforms
+        //--------------------------------------------------------------------------------
+        void update(Transforms* const* changed, size_t count);
+
+        //--------------------------------------------------------------------------------
+        /// @brief  Starts a new frame, and updates the matrices of the Transforms that
+        ///         changed during the last frame of a change log
+        //--------------------------------------------------------------------------------
+        inline void update(const ChangeLog& log)
+        {
+            const std::vector<Transforms*>& changed = log.getChanges();
+            update(changed.data(), changed.size());
+        }
+
+        //--------------------------------------------------------------------------------
+        /// @brief  Returns the number of the current frame
+        //--------------------------------------------------------------------------------
+        inline uint64_t getFrame() const
+        {
+            return m_frame;
+        }
+
+        //--------------------------------------------------------------------------------
+        /// @brief  Gets the current and previous world matrices of a Transforms
+        //--------------------------------------------------------------------------------
+        void getMatrices(Transforms* transforms, mat4& current, mat4& previous) const;
+
+        //--------------------------------------------------------------------------------
+        /// @brief  Writes the current and previous world matrices of several Transforms
+        ///
+        /// @param  nodes   The Transforms
+        /// @param  count   The number of Transforms
+        /// @param  out     The matrices (2 * count of them: current, then previous, for
+        ///                 each Transforms)
+        //--------------------------------------------------------------------------------
+        void write(Transforms* const* nodes, size_t count, mat4* out) const;
+
+
+        //_____ Internal types __________
+    private:
+        struct pair_t
+        {
+            mat4 current;
+            mat4 previous;
+        };
+
+
+        //_____ Attributes __________
+    private:
+        std::vector<pair_t> m_pairs;
+        std::vector<uint64_t> m_frames;     // Frame of the last change of each slot
+        std::vector<Transforms*> m_nodes;
+        std::vector<uint32_t> m_freeSlots;
+        uint64_t m_frame;
+    };
+
+
+    //------------------------------------------------------------------------------------
+    /// @brief  An animation clip: keys of local transforms, sampled at a fixed rate, for
+    ///         a set of tracks
+    ///
+    /// The keys are stored as structure of arrays: for each key, each component
+    /// (position x, y, z, orientation x, y, z, w, scale x, y, z) of all the tracks is
+    /// contiguous, so all the tracks can be sampled with vectorizable loops.
+    //------------------------------------------------------------------------------------
+    class AnimationClip
+    {
+        //_____ Construction / Destruction __________
+    public:
+        //--------------------------------------------------------------------------------
+        /// @brief  Constructor
+        ///
+        /// @remark All the keys are initialised to the identity transforms
+        ///
+        /// @param  nbTracks    The number of tracks
+        /// @param  nbKeys      The number of keys per track (at least 1)
+        /// @param  frameRate   The number of keys per second
+        //--------------------------------------------------------------------------------
+        AnimationClip(size_t nbTracks, size_t nbKeys, real frameRate);
+
+
+        //_____ Methods __________
+    public:
+        //--------------------------------------------------------------------------------
+        /// @brief  Sets a key of a track
+        ///
+        /// @param  track   Index of the track
+        /// @param  key     Index of the key
+        /// @param  pose    The local transforms
+        //--------------------------------------------------------------------------------
+        void setKey(size_t track, size_t key, const pose_t& pose);
+
+        //--------------------------------------------------------------------------------
+        /// @brief  Gets a key of a track
+        //--------------------------------------------------------------------------------
+        pose_t getKey(size_t track, size_t key) const;
+
+        //--------------------------------------------------------------------------------
+        /// @brief  Returns the number of tracks
+        //--------------------------------------------------------------------------------
+        inline size_t getNbTracks() const
+        {
+            return m_nbTracks;
+        }
+
+        //--------------------------------------------------------------------------------
+        /// @brief  Returns the number of keys per track
+        //--------------------------------------------------------------------------------
+        inline size_t getNbKeys() const
+        {
+            return m_nbKeys;
+        }
+
+        //--------------------------------------------------------------------------------
+        /// @brief  Returns the number of keys per second
+        //--------------------------------------------------------------------------------
+        inline real getFrameRate() const
+        {
+            return m_frameRate;
+        }
+
+        //--------------------------------------------------------------------------------
+        /// @brief  Returns the duration of the clip, in seconds
+        //--------------------------------------------------------------------------------
+        inline real getDuration() const
+        {
+            return real(m_nbKeys - 1) / m_frameRate;
+        }
+
+        //--------------------------------------------------------------------------------
+        /// @brief  Samples all the tracks at a given time
+        ///
+        /// @remark Positions and scales are linearly interpolated, orientations are
+        ///         normalised-linearly interpolated (nlerp) along the shortest path
+        ///
+        /// @param  time    The time, in seconds (clamped to the duration of the clip,
+        ///                 or wrapped around it if 'loop' is true)
+        /// @param  loop    Indicates if the clip loops
+        /// @param  values  The sampled values, with the same layout than a key (10 x
+        ///                 getNbTracks() values)
+        //--------------------------------------------------------------------------------
+        void sample(real time, bool loop, real* values) const;
+
+
+        //_____ Constants __________
+    public:
+        static const size_t NB_COMPONENTS = 10; ///< Number of components per track
+
+
+        //_____ Attributes __________
+    private:
+        size_t m_nbTracks;
+        size_t m_nbKeys;
+        real m_frameRate;
+        std::vector<real> m_values;     // [key][component][track]
+    };
+
+
+    //------------------------------------------------------------------------------------
+    /// @brief  Samples an animation clip and writes the results into the local
+    ///         transforms of the Transforms bound to its tracks
+    ///
+    /// The Transforms are bound once, then each call to sample() writes all of them in
+    /// one batch (see Transforms::setTransforms()), so each modified hierarchy is only
+    /// invalidated once.
+    //------------------------------------------------------------------------------------
+    class AnimationSampler
+    {
+        //_____ Construction / Destruction __________
+    public:
+        //--------------------------------------------------------------------------------
+        /// @brief  Constructor
+        ///
+        /// @param  clip    The animation clip (must stay valid while the sampler is
+        ///                 used)
+        /// @param  nodes   The Transforms bound to each track of the clip (nullptr for
+        ///                 the tracks to ignore)
+        //--------------------------------------------------------------------------------
+        AnimationSampler(const AnimationClip* clip, Transforms* const* nodes);
+
+
+        //_____ Methods __________
+    public:
+        //--------------------------------------------------------------------------------
+        /// @brief  Samples the clip and writes the local transforms of the bound
+        ///         Transforms
+        ///
+        /// @param  time    The time, in seconds
+        /// @param  loop    Indicates if the clip loops
+        //--------------------------------------------------------------------------------
+        void sample(real time, bool loop = true);
+
+        //--------------------------------------------------------------------------------
+        /// @brief  Returns the number of bound Transforms
+        //--------------------------------------------------------------------------------
+        inline size_t getNbBound() const
+        {
+            return m_nodes.size();
+        }
+
+
+        //_____ Attributes __________
+    private:
+        const AnimationClip* m_clip;
+        std::vector<Transforms*> m_nodes;
+        std::vector<size_t> m_tracks;   // Track bound to each Transforms
+
+        // Buffers reused by all the samplings
+        std::vector<real> m_values;
+        std::vector<pose_t> m_poses;
+    };
+
+
+    //------------------------------------------------------------------------------------
+    /// @brief  A set of local transforms (one per node of a set of Transforms), that can
+    ///         be blended with others before being written into the Transforms
+    ///
+    /// The values use the same structure of arrays layout than the one produced by
+    /// AnimationClip::sample(), so a clip with as many tracks as poses in the buffer can
+    /// be sampled directly into getValues().
+    //------------------------------------------------------------------------------------
+    class PoseBuffer
+    {
+        //_____ Construction / Destruction __________
+    public:
+        //--------------------------------------------------------------------------------
+        /// @brief  Constructor
+        ///
+        /// @param  size    The number of poses (initialised to the identity transforms)
+        //--------------------------------------------------------------------------------
+        PoseBuffer(size_t size = 0);
+
+
+        //_____ Methods __________
+    public:
+        //--------------------------------------------------------------------------------
+        /// @brief  Changes the number of poses, and resets all of them to the identity
+        ///         transforms
+        //--------------------------------------------------------------------------------
+        void resize(size_t size);
+
+        //--------------------------------------------------------------------------------
+        /// @brief  Returns the number of poses
+        //--------------------------------------------------------------------------------
+        inline size_t size() const
+        {
+            return m_size;
+        }
+
+        //--------------------------------------------------------------------------------
+        /// @brief  Resets all the poses to the identity transforms
+        //--------------------------------------------------------------------------------
+        void setIdentity();
+
+        //--------------------------------------------------------------------------------
+        /// @brief  Sets one pose
+        //--------------------------------------------------------------------------------
+        void setPose(size_t index, const pose_t& pose);
+
+        //--------------------------------------------------------------------------------
+        /// @brief  Returns one pose
+        //--------------------------------------------------------------------------------
+        pose_t getPose(size_t index) const;
+
+        //--------------------------------------------------------------------------------
+        /// @brief  Gives access to the values (AnimationClip::NB_COMPONENTS x size())
+        //--------------------------------------------------------------------------------
+        inline real* getValues()
+        {
+            return m_values.data();
+        }
+
+        //--------------------------------------------------------------------------------
+        /// @brief  Gives access to the values (AnimationClip::NB_COMPONENTS x size())
+        //--------------------------------------------------------------------------------
+        inline const real* getValues() const
+        {
+            return m_values.data();
+        }
+
+        //--------------------------------------------------------------------------------
+        /// @brief  Reads the local transforms of a set of Transforms
+        ///
+        /// @param  nodes   The Transforms (size() of them)
+        //--------------------------------------------------------------------------------
+        void capture(Transforms* const* nodes);
+
+        //--------------------------------------------------------------------------------
+        /// @brief  Writes the poses into the local transforms of a set of Transforms, in
+        ///         one batch (see Transforms::setTransforms())
+        ///
+        /// @param  nodes   The Transforms (size() of them)
+        //--------------------------------------------------------------------------------
+        void commit(Transforms* const* nodes);
+
+        //--------------------------------------------------------------------------------
+        /// @brief  Blends the poses toward the ones of another buffer
+        ///
+        /// @remark Positions and scales are linearly interpolated, orientations are
+        ///         normalised-linearly interpolated (nlerp) along the shortest path
+        ///
+        /// @param  other   The other buffer (same size)
+        /// @param  weight  The weight of the other buffer (0: no change, 1: copy)
+        /// @param  mask    Optional per-pose factors applied to the weight
+        //--------------------------------------------------------------------------------
+        void blend(const PoseBuffer& other, real weight, const real* mask = nullptr);
+
+        //--------------------------------------------------------------------------------
+        /// @brief  Converts the poses into differences relative to reference ones, to
+        ///         be used with addAdditive()
+        ///
+        /// @param  reference   The reference poses (same size)
+        //--------------------------------------------------------------------------------
+        void makeAdditive(const PoseBuffer& reference);
+
+        //--------------------------------------------------------------------------------
+        /// @brief  Applies the differences computed by makeAdditive() to the poses
+        ///
+        /// @param  additive    The differences (same size)
+        /// @param  weight      The weight of the differences
+        /// @param  mask        Optional per-pose factors applied to the weight
+        //--------------------------------------------------------------------------------
+        void addAdditive(const PoseBuffer& additive, real weight, const real* mask = nullptr);
+
+
+    private:
+        void computeWeights(real weight, const real* mask);
+
+
+        //_____ Attributes __________
+    private:
+        size_t m_size;
+        std::vector<real> m_values;     // [component][pose]
+
+        // Buffers reused by all the operations
+        std::vector<real> m_weights;
+        std::vector<pose_t> m_poses;
+    };
+
+
+    //------------------------------------------------------------------------------------
+    /// @brief  Computes the forward kinematics of a chain of Transforms driven by joint
+    ///         values, without modifying them
+    ///
+    /// Each link of the chain has a joint, expressed relatively to its rest pose (the
+    /// local transforms it had when the chain was created): a revolute joint rotates the
+    /// link around an axis of its own space, a prismatic joint translates it along that
+    /// axis.
+    ///
+    /// Many configurations can be evaluated in one call, which computes the world
+    /// transforms of all the links in one pass (and optionally the geometric Jacobian of
+    /// the last link), without touching the Transforms. apply() writes one configuration
+    /// into them.
+    //------------------------------------------------------------------------------------
+    class KinematicChain
+    {
+        //_____ Construction / Destruction __________
+    public:
+        //--------------------------------------------------------------------------------
+        /// @brief  Constructor
+        ///
+        /// @param  links   The Transforms of the chain, from the base to the end effector
+        ///                 (each one must be the parent of the next one)
+        /// @param  types   The type of the joint of each link
+        /// @param  axes    The (unit) axis of the joint of each link, in the space of
+        ///                 the link
+        /// @param  count   The number of links
+        //--------------------------------------------------------------------------------
+        KinematicChain(Transforms* const* links, const joint_type_t* types,
+                       const vec3* axes, size_t count);
+
+
+        //_____ Methods __________
+    public:
+        //--------------------------------------------------------------------------------
+        /// @brief  Returns the number of links
+        //--------------------------------------------------------------------------------
+        inline size_t getNbLinks() const
+        {
+            return m_links.size();
+        }
+
+        //--------------------------------------------------------------------------------
+        /// @brief  Reads again the rest poses from the local transforms of the links
+        //--------------------------------------------------------------------------------
+        void captureRestPoses();
+
+        //--------------------------------------------------------------------------------
+        /// @brief  Computes the world transforms of the links for several configurations
+        ///
+        /// @remark The world transforms of the parent of the base are read once per call
+        ///
+        /// @param  values          The joint values (getNbLinks() per configuration,
+        ///                         ignored for fixed joints)
+        /// @param  nbConfigurations The number of configurations
+        /// @param  poses           The world transforms of the links (getNbLinks() per
+        ///                         configuration)
+        /// @param  jacobians       Optional geometric Jacobians of the last link
+        ///                         (6 x getNbLinks() values per configuration, in column
+        ///                         order: for each joint, the linear then angular
+        ///                         velocities in world space produced by a unit joint
+        ///                         velocity)
+        //--------------------------------------------------------------------------------
+        void computeForwardKinematics(const real* values, size_t nbConfigurations,
+                                      pose_t* poses, real* jacobians = nullptr);
+
+        //--------------------------------------------------------------------------------
+        /// @brief  Writes a configuration into the local transforms of the links, in one
+        ///         batch (see Transforms::setTransforms())
+        ///
+        /// @param  values  The joint values (getNbLinks() of them)
+        //--------------------------------------------------------------------------------
+        void apply(const real* values);
+
+
+    private:
+        struct joint_t
+        {
+            joint_type_t type;
+            vec3 axis;
+            pose_t rest;
+            bool inheritOrientation;
+            bool inheritScale;
+        };
+
+        pose_t getLocalPose(const joint_t& joint, real value) const;
+
+
+        //_____ Attributes __________
+    private:
+        std::vector<Transforms*> m_links;
+        std::vector<joint_t> m_joints;
+
+        // Buffer reused by apply()
+        std::vector<pose_t> m_poses;
+    };
+
+
+    //------------------------------------------------------------------------------------
+    /// @brief  Solves the inverse kinematics of a chain of Transforms, by rotating its
+    ///         links so the last one reaches a target position
+    ///
+    /// The solvers work on a copy of the local and world transforms of the chain, read
+    /// once at the beginning of the solve, and write the resulting orientations back into
+    /// the Transforms in one batch (see Transforms::setTransforms()) at the end, so the
+    /// hierarchy isn't invalidated during the iterations.
+    //------------------------------------------------------------------------------------
+    class IKSolver
+    {
+        //_____ Construction / Destruction __________
+    public:
+        //--------------------------------------------------------------------------------
+        /// @brief  Constructor
+        ///
+        /// @param  links   The Transforms of the chain, from the base to the end effector
+        ///                 (each one must be the parent of the next one)
+        /// @param  count   The number of links (at least 2)
+        //--------------------------------------------------------------------------------
+        IKSolver(Transforms* const* links, size_t count);
+
+
+        //_____ Methods __________
+    public:
+        //--------------------------------------------------------------------------------
+        /// @brief  Returns the number of links
+        //--------------------------------------------------------------------------------
+        inline size_t getNbLinks() const
+        {
+            return m_links.size();
+        }
+
+        //--------------------------------------------------------------------------------
+        /// @brief  Solves the chain using Cyclic Coordinate Descent
+        ///
+        /// @param  target          The target position of the end effector, in world
+        ///                         space
+        /// @param  maxIterations   The maximum number of iterations
+        /// @param  tolerance       The distance below which the target is considered
+        ///                         reached
+        /// @return                 'true' if the target was reached
+        //--------------------------------------------------------------------------------
+        bool solveCCD(const vec3& target, size_t maxIterations = 16, real tolerance = 1e-3f);
+
+        //--------------------------------------------------------------------------------
+        /// @brief  Solves the chain using Forward And Backward Reaching Inverse
+        ///         Kinematics
+        ///
+        /// @remark The positions found by FABRIK are converted into rotations of the
+        ///         links, from the base to the end effector
+        ///
+        /// @param  target          The target position of the end effector, in world
+        ///                         space
+        /// @param  maxIterations   The maximum number of iterations
+        /// @param  tolerance       The distance below which the target is considered
+        ///                         reached
+        /// @return                 'true' if the target was reached
+        //--------------------------------------------------------------------------------
+        bool solveFABRIK(const vec3& target, size_t maxIterations = 16, real tolerance = 1e-3f);
+
+
+    private:
+        void load();
+        void rotate(size_t link, const quat& rotation);
+        void updateWorld(size_t first);
+        void store();
+
+
+        //_____ Attributes __________
+    private:
+        std::vector<Transforms*> m_links;
+
+        // Working copy of the chain
+        pose_t m_base;
+        std::vector<pose_t> m_local;
+        std::vector<pose_t> m_world;
+        std::vector<uint8_t> m_inheritOrientation;
+        std::vector<uint8_t> m_inheritScale;
+
+        // Buffers used by FABRIK
+        std::vector<vec3> m_positions;
+        std::vector<real> m_lengths;
+    };
+
+
+    //------------------------------------------------------------------------------------
+    /// @brief  Moves Transforms with constant linear and angular velocities
+    ///
+    /// integrate() advances the local position and orientation of all the Transforms
+    /// with a velocity in one batch: their transforms are gathered into arrays, advanced
+    /// by vectorizable loops, then written back with Transforms::setTransforms(), so only
+    /// the moving subtrees are invalidated.
+    ///
+    /// The Transforms must be removed from the integrator before being destroyed.
+    //------------------------------------------------------------------------------------
+    class VelocityIntegrator
+    {
+        //_____ Methods __________
+    public:
+        //--------------------------------------------------------------------------------
+        /// @brief  Sets the velocity of a Transforms
+        ///
+        /// @param  transforms  The Transforms
+        /// @param  linear      The linear velocity, in units per second
+        /// @param  angular     The angular velocity (rotation axis multiplied by the
+        ///                     speed, in radians per second)
+        /// @param  relativeTo  The space in which the velocities are expressed
+        ///                     (world space velocities use the world transforms of the
+        ///                     parent at the beginning of each integration)
+        //--------------------------------------------------------------------------------
+        void setVelocity(Transforms* transforms, const vec3& linear, const vec3& angular,
+                         transform_space_t relativeTo = TS_PARENT);
+
+        //--------------------------------------------------------------------------------
+        /// @brief  Removes the velocity of a Transforms
+        //--------------------------------------------------------------------------------
+        void removeVelocity(Transforms* transforms);
+
+        //--------------------------------------------------------------------------------
+        /// @brief  Indicates if a Transforms has a velocity
+        //--------------------------------------------------------------------------------
+        bool hasVelocity(Transforms* transforms) const;
+
+        //--------------------------------------------------------------------------------
+        /// @brief  Returns the linear velocity of a Transforms (zero if it has none)
+        //--------------------------------------------------------------------------------
+        vec3 getLinearVelocity(Transforms* transforms) const;
+
+        //--------------------------------------------------------------------------------
+        /// @brief  Returns the angular velocity of a Transforms (zero if it has none)
+        //--------------------------------------------------------------------------------
+        vec3 getAngularVelocity(Transforms* transforms) const;
+
+        //--------------------------------------------------------------------------------
+        /// @brief  Returns the number of Transforms with a velocity
+        //--------------------------------------------------------------------------------
+        inline size_t size() const
+        {
+            return m_nodes.size();
+        }
+
+        //--------------------------------------------------------------------------------
+        /// @brief  Advances the local transforms of all the Transforms with a velocity
+        ///
+        /// @param  dt  The elapsed time, in seconds
+        //--------------------------------------------------------------------------------
+        void integrate(real dt);
+
+
+        //_____ Attributes __________
+    private:
+        std::unordered_map<Transforms*, size_t> m_indices;
+        std::vector<Transforms*> m_nodes;
+        std::vector<vec3> m_linear;
+        std::vector<vec3> m_angular;
+        std::vector<transform_space_t> m_spaces;
+
+        // Buffers reused by all the integrations
+        std::vector<real> m_values;     // [component][node]
+        std::vector<pose_t> m_poses;
+    };
+
+
+    //------------------------------------------------------------------------------------
+    /// @brief  Extrapolates the transforms of Transforms from a reference pose and
+    ///         constant velocities (dead reckoning)
+    ///
+    /// The extrapolated transforms are evaluated on demand, for any time, without
+    /// modifying the Transforms: the hierarchies aren't invalidated between two network
+    /// updates. The world transforms take into account the extrapolated ancestors.
+    ///
+    /// The Transforms must be removed from the extrapolator before being destroyed.
+    //------------------------------------------------------------------------------------
+    class Extrapolator
+    {
+        //_____ Methods __________
+    public:
+        //--------------------------------------------------------------------------------
+        /// @brief  Sets the reference of a Transforms (usually from a network update)
+        ///
+        /// @param  transforms  The Transforms
+        /// @param  time        The time of the reference
+        /// @param  pose        The local transforms at that time
+        /// @param  linear      The linear velocity, in parent space, in units per
+        ///                     second
+        /// @param  angular     The angular velocity (rotation axis multiplied by the
+        ///                     speed, in radians per second), in parent space
+        //--------------------------------------------------------------------------------
+        void setReference(Transforms* transforms, double time, const pose_t& pose,
+                          const vec3& linear, const vec3& angular);
+
+        //--------------------------------------------------------------------------------
+        /// @brief  Stops extrapolating a Transforms
+        //--------------------------------------------------------------------------------
+        void remove(Transforms* transforms);
+
+        //--------------------------------------------------------------------------------
+        /// @brief  Indicates if a Transforms is extrapolated
+        //--------------------------------------------------------------------------------
+        bool contains(Transforms* transforms) const;
+
+        //--------------------------------------------------------------------------------
+        /// @brief  Returns the number of extrapolated Transforms
+        //--------------------------------------------------------------------------------
+        inline size_t size() const
+        {
+            return m_nodes.size();
+        }
+
+        //--------------------------------------------------------------------------------
+        /// @brief  Returns the extrapolated Transforms, in the order used by the batch
+        ///         version of getWorldTransforms()
+        //--------------------------------------------------------------------------------
+        inline const std::vector<Transforms*>& getNodes() const
+        {
+            return m_nodes;
+        }
+
+        //--------------------------------------------------------------------------------
+        /// @brief  Evaluates the extrapolated local transforms of a Transforms
+        ///
+        /// @param  transforms  The Transforms
+        /// @param  time        The time
+        /// @param  pose        The extrapolated local transforms
+        /// @return             'false' if the Transforms isn't extrapolated
+        //--------------------------------------------------------------------------------
+        bool getTransforms(Transforms* transforms, double time, pose_t& pose) const;
+
+        //--------------------------------------------------------------------------------
+        /// @brief  Evaluates the extrapolated world transforms of a Transforms
+        ///
+        /// @remark The Transforms doesn't need to be extrapolated itself: it is enough
+        ///         that one of its ancestors is
+        ///
+        /// @param  transforms  The Transforms
+        /// @param  time        The time
+        /// @return             The extrapolated world transforms
+        //--------------------------------------------------------------------------------
+        pose_t getWorldTransforms(Transforms* transforms, double time);
+
+        //--------------------------------------------------------------------------------
+        /// @brief  Evaluates the extrapolated world transforms of all the extrapolated
+        ///         Transforms
+        ///
+        /// @remark The local transforms are extrapolated by vectorized loops, then
+        ///         combined with the world transforms of the parents. The world
+        ///         transforms of each Transforms (including the intermediate ones
+        ///         between extrapolated Transforms) are only computed once.
+        ///
+        /// @param  time    The time
+        /// @param  poses   The extrapolated world transforms, in the order of getNodes()
+        //--------------------------------------------------------------------------------
+        void getWorldTransforms(double time, pose_t* poses);
+
+
+        //_____ Internal types __________
+    private:
+        struct reference_t
+        {
+            double time;
+            pose_t pose;
+            vec3 linear;
+            vec3 angular;
+        };
+
+        struct intermediate_t
+        {
+            bool affected;  // 'false' if no ancestor is extrapolated
+            pose_t world;
+        };
+
+
+        //_____ Private methods __________
+    private:
+        bool computeWorld(Transforms* transforms, double time, bool batch, pose_t& world);
+
+
+        //_____ Attributes __________
+    private:
+        std::unordered_map<Transforms*, size_t> m_indices;
+        std::vector<Transforms*> m_nodes;
+        std::vector<reference_t> m_references;
+
+        // Buffers reused by the batch evaluation
+        std::vector<real> m_values;     // [component][node]
+        std::vector<pose_t> m_local;
+        std::vector<pose_t> m_world;
+        std::vector<uint8_t> m_resolved;
+        std::unordered_map<Transforms*, intermediate_t> m_intermediates;
+    };
+
+
+    //------------------------------------------------------------------------------------
+    /// @brief  Exports the world transforms of Transforms into a memory block, so they
+    ///         can be read by other processes (see SharedExportReader)
+    ///
+    /// The memory block is provided by the caller (typically a shared memory segment
+    /// mapped by both processes). It contains a header followed by a ring of slots,
+    /// each one holding a frame. Each slot is protected by a sequence lock: readers
+    /// never block the writer, and detect (then retry) the frames modified while
+    /// they were read.
+    ///
+    /// @remark The counters are std::atomic values, which must be lock-free to be
+    ///         shared between processes
+    //------------------------------------------------------------------------------------
+    class SharedExportWriter
+    {
+        //_____ Construction / Destruction __________
+    public:
+        //--------------------------------------------------------------------------------
+        /// @brief  Constructor
+        ///
+        /// @remark The memory block is initialised by the constructor
+        ///
+        /// @param  memory      The memory block (aligned on 8 bytes), of at least
+        ///                     getRequiredSize() bytes
+        /// @param  capacity    Maximum number of Transforms per frame
+        /// @param  nbSlots     Number of frames in the ring (at least 2)
+        /// @param  format      Format of the exported transforms
+        //--------------------------------------------------------------------------------
+        SharedExportWriter(void* memory, size_t capacity, size_t nbSlots = 3,
+                           export_format_t format = EF_POSES);
+
+
+        //_____ Methods __________
+    public:
+        //--------------------------------------------------------------------------------
+        /// @brief  Returns the size of the memory block needed to export transforms
+        ///
+        /// @param  capacity    Maximum number of Transforms per frame
+        /// @param  nbSlots     Number of frames in the ring
+        /// @param  format      Format of the exported transforms
+        //--------------------------------------------------------------------------------
+        static size_t getRequiredSize(size_t capacity, size_t nbSlots,
+                                      export_format_t format);
+
+        //--------------------------------------------------------------------------------
+        /// @brief  Writes the world transforms of some Transforms as a new frame
+        ///
+        /// @remark The world transforms are retrieved (and updated if needed) before
+        ///         the slot is locked, so the readers are only blocked during the copy
+        ///
+        /// @param  nodes   The Transforms (at most 'capacity' of them)
+        /// @param  count   The number of Transforms
+        /// @return The number of the frame
+        //--------------------------------------------------------------------------------
+        uint64_t write(Transforms* const* nodes, size_t count);
+
+
+        //_____ Internal types __________
+    private:
+        friend class SharedExportReader;
+
+        struct header_t
+        {
+            uint32_t magic;
+            uint32_t version;
+            uint32_t capacity;
+            uint32_t nbSlots;
+            uint32_t format;
+            uint32_t slotSize;
+            std::atomic<uint64_t> lastFrame;
+        };
+
+        struct slot_t
+        {
+            std::atomic<uint64_t> sequence;     // Odd while the slot is written
+            uint64_t frame;
+            uint32_t nbNodes;
+            uint32_t padding;
+        };
+
+        static const uint32_t MAGIC;
+        static const uint32_t VERSION;
+
+        static size_t getValuesPerNode(export_format_t format);
+
+
+        //_____ Attributes __________
+    private:
+        header_t* m_header;
+        uint8_t* m_slots;
+        export_format_t m_format;
+        uint64_t m_frame;
+        std::vector<float> m_values;    // Values of the frame being written
+    };
+
+
+    //------------------------------------------------------------------------------------
+    /// @brief  Reads the world transforms exported by a SharedExportWriter (possibly in
+    ///         another process)
+    //------------------------------------------------------------------------------------
+    class SharedExportReader
+    {
+        //_____ Construction / Destruction __________
+    public:
+        //--------------------------------------------------------------------------------
+        /// @brief  Constructor
+        ///
+        /// @param  memory  The memory block initialised by a SharedExportWriter
+        /// @param  size    The size of the memory block, in bytes
+        //--------------------------------------------------------------------------------
+        SharedExportReader(const void* memory, size_t size);
+
+
+        //_____ Methods __________
+    public:
+        //--------------------------------------------------------------------------------
+        /// @brief  Indicates if the memory block was initialised by a compatible
+        ///         SharedExportWriter
+        //--------------------------------------------------------------------------------
+        inline bool isValid() const
+        {
+            return (m_header != nullptr);
+        }
+
+        //--------------------------------------------------------------------------------
+        /// @brief  Returns the format of the exported transforms
+        //--------------------------------------------------------------------------------
+        export_format_t getFormat() const;
+
+        //--------------------------------------------------------------------------------
+        /// @brief  Returns the number of floats per Transforms (10 for EF_POSES, 12 for
+        ///         EF_MATRICES)
+        //--------------------------------------------------------------------------------
+        size_t getValuesPerNode() const;
+
+        //--------------------------------------------------------------------------------
+        /// @brief  Returns the number of the last frame written (0 if none)
+        //--------------------------------------------------------------------------------
+        uint64_t getLastFrame() const;
+
+        //--------------------------------------------------------------------------------
+        /// @brief  Reads the last frame written
+        ///
+        /// @param  values      The exported transforms (getValuesPerNode() floats per
+        ///                     Transforms)
+        /// @param  frame       The number of the frame read
+        /// @param  maxRetries  Maximum number of attempts if the frame is modified
+        ///                     while being read
+        /// @return 'false' if no consistent frame could be read
+        //--------------------------------------------------------------------------------
+        bool read(std::vector<float>& values, uint64_t& frame, size_t maxRetries = 8) const;
+
+        //--------------------------------------------------------------------------------
+        /// @brief  Starts to read the last frame written, in place (without copying it)
+        ///
+        /// @remark The values pointed by the frame can be modified by the writer at any
+        ///         time: they must only be trusted once endRead() confirmed that it
+        ///         didn't happen. For instance:
+        ///
+        /// @code
+        ///     exported_frame_t frame;
+        ///     while (reader.beginRead(frame))
+        ///     {
+        ///         float x = frame.values[0];
+        ///         if (reader.endRead(frame))
+        ///         {
+        ///             // use x
+        ///             break;
+        ///         }
+        ///     }
+        /// @endcode
+        ///
+        /// @param  frame       The frame
+        /// @param  maxRetries  Maximum number of attempts if the last frame is being
+        ///                     written
+        /// @return 'false' if no frame could be read
+        //--------------------------------------------------------------------------------
+        bool beginRead(exported_frame_t& frame, size_t maxRetries = 8) const;
+
+        //--------------------------------------------------------------------------------
+        /// @brief  Ends the read of a frame started with beginRead()
+        ///
+        /// @param  frame   The frame
+        /// @return 'true' if the frame wasn't modified by the writer since beginRead()
+        ///         (so the values read meanwhile are consistent)
+        //--------------------------------------------------------------------------------
+        bool endRead(const exported_frame_t& frame) const;
+
+
+        //_____ Attributes __________
+    private:
+        const SharedExportWriter::header_t* m_header;
+        const uint8_t* m_slots;
+    };
+
+
+
+#ifdef KNM_TRANSFORMS_TREE_IMPLEMENTATION
+
+    /*********************************** CONSTANTS **************************************/
+
+    const vec3 VEC3_ZERO(0.0f, 0.0f, 0.0f);
+    const vec3 VEC3_UNIT_X(1.0f, 0.0f, 0.0f);
+    const vec3 VEC3_UNIT_Y(0.0f, 1.0f, 0.0f);
+    const vec3 VEC3_UNIT_Z(0.0f, 0.0f, 1.0f);
+    const vec3 VEC3_NEGATIVE_UNIT_X(-1.0f, 0.0f, 0.0f);
+    const vec3 VEC3_NEGATIVE_UNIT_Y(0.0f, -1.0f, 0.0f);
+    const vec3 VEC3_NEGATIVE_UNIT_Z(0.0f, 0.0f, -1.0f);
+    const vec3 VEC3_UNIT_SCALE(1.0f, 1.0f, 1.0f);
+
+    const quat QUAT_ZERO(0.0f, 0.0f, 0.0f, 0.0f);
+    const quat QUAT_IDENTITY(1.0f, 0.0f, 0.0f, 0.0f);
+
+    const real PI = real(4.0 * atan(1.0));
+
+
+    /******************************** HELPER FUNCTIONS **********************************/
+
+    // Indicates that the arrays given to a kernel don't overlap, so the compiler can
+    // vectorize its loops without checking it at runtime
+    #if defined(__GNUC__) || defined(_MSC_VER)
+        #define KNM_TRANSFORMS_TREE_RESTRICT __restrict
+    #else
+        #define KNM_TRANSFORMS_TREE_RESTRICT
+    #endif
+
+    //-----------------------------------------------------------------------
+    // Computes 1 / sqrt(x) (x > 0) from an approximation based on the bit pattern of
+    // x, refined by Newton iterations (relative error below 2e-7). Unlike std::sqrt(),
+    // which might have to set errno, it doesn't prevent the vectorization of the loops
+    // normalising quaternions.
+    //-----------------------------------------------------------------------
+    static inline real inverseSqrt(real x)
+    {
+        uint32_t bits;
+        std::memcpy(&bits, &x, sizeof(bits));
+        bits = 0x5F375A86u - (bits >> 1);
+
+        real y;
+        std::memcpy(&y, &bits, sizeof(y));
+
+        const real halfX = 0.5f * x;
+        y = y * (1.5f - halfX * y * y);
+        y = y * (1.5f - halfX * y * y);
+        y = y * (1.5f - halfX * y * y);
+
+        return y;
+    }
+
+    //-----------------------------------------------------------------------
+    // Computes the sine and cosine of x (|x| < 1e7) without branches nor calls, so the
+    // loops using it can be vectorized (absolute error below 3e-7): x is reduced to
+    // [-PI/2, PI/2] by subtracting the nearest multiple of PI, then polynomials are
+    // used
+    //-----------------------------------------------------------------------
+    static inline void sinCos(real x, real& sine, real& cosine)
+    {
+        const real INV_PI = 0.318309886f;
+        const real PI_A = 3.140625f;            // PI = PI_A + PI_B, with PI_A exactly
+        const real PI_B = 9.67653589793e-4f;    // representable on a few bits
+        const real ROUNDING = 12582912.0f;      // 1.5 * 2^23
+
+        // Nearest multiple k of PI: once ROUNDING is added, the lowest bit of the
+        // value is the parity of k
+        real rounded = x * INV_PI + ROUNDING;
+
+        uint32_t bits;
+        std::memcpy(&bits, &rounded, sizeof(bits));
+
+        real k = rounded - ROUNDING;
+        real r = (x - k * PI_A) - k * PI_B;
+
+        // sin(r + k * PI) = (-1)^k * sin(r), cos(r + k * PI) = (-1)^k * cos(r)
+        real sign = 1.0f - real(bits & 1u) * 2.0f;
+        real r2 = r * r;
+
+        sine = sign * r * (1.0f + r2 * (-1.0f / 6.0f + r2 * (1.0f / 120.0f +
+                           r2 * (-1.0f / 5040.0f + r2 * (1.0f / 362880.0f -
+                           r2 * (1.0f / 39916800.0f))))));
+
+        cosine = sign * (1.0f + r2 * (-0.5f + r2 * (1.0f / 24.0f + r2 * (-1.0f / 720.0f +
+                         r2 * (1.0f / 40320.0f + r2 * (-1.0f / 3628800.0f +
+                         r2 * (1.0f / 479001600.0f)))))));
+    }
+
+
+    /*************************** CONSTRUCTION / DESTRUCTION *****************************/
+
+    Transforms::Transforms()
+    : m_parent(nullptr), m_transformable(nullptr), m_journal(nullptr),
+      m_motion(nullptr), m_motionSlot(0),
+      m_position(VEC3_ZERO), m_orientation(QUAT_IDENTITY), m_scale(VEC3_UNIT_SCALE),
+      m_fullPosition(VEC3_ZERO), m_fullOrientation(QUAT_IDENTITY),
+      m_fullScale(VEC3_UNIT_SCALE), m_fullInverseOrientation(QUAT_IDENTITY),
+      m_fullInverseScale(VEC3_UNIT_SCALE), m_revision(0), m_nbSubscriptions(0),
+      m_nbSubtreeSubscriptions(0), m_bDirty(true),
+      m_bInheritOrientation(true), m_bInheritScale(true), m_bHasBounds(false),
+      m_bSubtreeBoundsDirty(true), m_bChanged(true), m_bSubtreeChanged(true)
+    {
+    }
+
+    //-----------------------------------------------------------------------
+
+    Transforms::Transforms(KNM_TRANSFORMS_TREE_TRANSFORMABLE_TYPE* transformable)
+    : m_parent(nullptr), m_transformable(transformable), m_journal(nullptr),
+      m_motion(nullptr), m_motionSlot(0),
+      m_position(VEC3_ZERO), m_orientation(QUAT_IDENTITY), m_scale(VEC3_UNIT_SCALE),
+      m_fullPosition(VEC3_ZERO), m_fullOrientation(QUAT_IDENTITY),
+      m_fullScale(VEC3_UNIT_SCALE), m_fullInverseOrientation(QUAT_IDENTITY),
+      m_fullInverseScale(VEC3_UNIT_SCALE), m_revision(0), m_nbSubscriptions(0),
+      m_nbSubtreeSubscriptions(0), m_bDirty(true),
+      m_bInheritOrientation(true), m_bInheritScale(true), m_bHasBounds(false),
+      m_bSubtreeBoundsDirty(true), m_bChanged(true), m_bSubtreeChanged(true)
+    {
+#ifdef KNM_TRANSFORMS_TREE_USE_TRANSFORMABLE
+        assert((transformable == nullptr) || (transformable->getTransforms() == this));
+#endif
+    }
+
+    //-----------------------------------------------------------------------
+
+    Transforms::~Transforms()
+    {
+        if (m_motion)
+            m_motion->remove(this);
+
+        if (m_journal)
+            m_journal->record(SE_DESTROYED, this, m_parent, m_parent);
+    }
+
+
+    /************************** PARENT-CHILDREN RELATIONSHIP ****************************/
+
+    void Transforms::setParent(Transforms* transforms)
+    {
+        assert(transforms != this);
+
+        Transforms* previousParent = m_parent;
+        StructureJournal* previousJournal = m_journal;
+        uint32_t previousSubscriptions = (m_parent ? m_parent->m_nbSubtreeSubscriptions : 0);
+
+        if (m_parent)
+        {
+            m_parent->m_children.erase(
+                std::find(m_parent->m_children.begin(), m_parent->m_children.end(), this)
+            );
+            m_parent->needBoundsRefit();
+            m_parent = nullptr;
+        }
+
+        if (transforms)
+        {
+            m_parent = transforms;
+            transforms->m_children.push_back(this);
+
+            if (m_journal != transforms->m_journal)
+                setJournal(transforms->m_journal);
+        }
+        else if (m_journal)
+        {
+            // A detached Transforms doesn't belong to the hierarchy anymore
+            setJournal(nullptr);
+        }
+
+        needUpdate();
+
+        // The subtree subscriptions inherited from the ancestors changed
+        uint32_t subscriptions = (m_parent ? m_parent->m_nbSubtreeSubscriptions : 0);
+        if (subscriptions != previousSubscriptions)
+            addSubtreeSubscriptions(int32_t(subscriptions) - int32_t(previousSubscriptions));
+
+        if (previousJournal || m_journal)
+        {
+            structure_event_type_t type = (!previousParent ? SE_ATTACHED :
+                                                (!m_parent ? SE_DETACHED : SE_REPARENTED));
+
+            // When moved to another hierarchy, the event is recorded in both journals
+            if (previousJournal)
+                previousJournal->record(type, this, m_parent, previousParent);
+
+            if (m_journal && (m_journal != previousJournal))
+                m_journal->record(type, this, m_parent, previousParent);
+        }
+    }
+
+    //-----------------------------------------------------------------------
+
+    std::vector<Transforms*> Transforms::findChildren(const std::string& tag,
+                                                      bool recursive) const
+    {
+        assert(!tag.empty());
+
+        std::vector<Transforms*> result;
+
+        for (Transforms* child : m_children)
+        {
+            if (child->hasTag(tag))
+                result.push_back(child);
+
+            if (recursive)
+            {
+                auto result2 = child->findChildren(tag, true);
+                result.insert(result.end(), result2.begin(), result2.end());
+            }
+        }
+
+        return result;
+    }
+
+    //-----------------------------------------------------------------------
+
+    bool Transforms::buildHierarchy(Transforms* const* nodes, const int32_t* parents,
+                                    const pose_t* poses, size_t count,
+                                    const std::string* tags)
+    {
+        // Validate the parent indices before modifying anything: each chain of parents
+        // is followed until a root or an already validated Transforms is found, so each
+        // Transforms is only visited once
+        enum { UNKNOWN, VISITING, VALID };
+        std::vector<uint8_t> states(count, UNKNOWN);
+
+        for (size_t i = 0; i < count; ++i)
+        {
+            if ((parents[i] >= 0) && (size_t(parents[i]) >= count))
+                return false;
+        }
+
+        for (size_t i = 0; i < count; ++i)
+        {
+            int32_t current = int32_t(i);
+            while ((current >= 0) && (states[current] == UNKNOWN))
+            {
+                states[current] = VISITING;
+                current = parents[current];
+            }
+
+            // Back to a Transforms of the chain being followed
+            if ((current >= 0) && (states[current] == VISITING))
+                return false;
+
+            for (current = int32_t(i); (current >= 0) && (states[current] == VISITING);
+                 current = parents[current])
+            {
+                states[current] = VALID;
+            }
+        }
+
+        // Count the children of each Transforms, to allocate the lists only once
+        std::vector<uint32_t> nbChildren(count, 0);
+
+        for (size_t i = 0; i < count; ++i)
+        {
+            assert(!nodes[i]->m_parent && nodes[i]->m_children.empty());
+
+            if (parents[i] >= 0)
+                ++nbChildren[parents[i]];
+        }
+
+        for (size_t i = 0; i < count; ++i)
+        {
+            Transforms* node = nodes[i];
+
+            node->m_children.reserve(nbChildren[i]);
+
+            if (parents[i] >= 0)
+            {
+                node->m_parent = nodes[parents[i]];
+                node->m_parent->m_children.push_back(node);
+            }
+
+            node->m_position = poses[i].position;
+            node->m_orientation = poses[i].orientation;
+            node->m_scale = poses[i].scale;
+
+            if (tags && !tags[i].empty())
+                node->m_tags.push_back(tags[i]);
+
+            // All the Transforms are invalidated, so the invariants of the flags hold
+            // without traversing the hierarchies
+            if (!node->m_bDirty)
+                ++node->m_revision;
+
+            node->m_bDirty = true;
+            node->m_bSubtreeBoundsDirty = true;
+            node->m_bChanged = true;
+            node->m_bSubtreeChanged = true;
+        }
+
+        // Sort the Transforms parents first, then compute the world transforms (each
+        // update only uses the already up-to-date transforms of the parent)
+        std::vector<Transforms*> sorted;
+        sorted.reserve(count);
+
+        for (size_t i = 0; i < count; ++i)
+        {
+            if (parents[i] < 0)
+            {
+                sorted.push_back(nodes[i]);
+
+                if (nodes[i]->m_journal)
+                    nodes[i]->setJournal(nodes[i]->m_journal);
+            }
+        }
+
+        for (size_t i = 0; i < sorted.size(); ++i)
+        {
+            Transforms* node = sorted[i];
+
+            node->update();
+            sorted.insert(sorted.end(), node->m_children.begin(), node->m_children.end());
+
+            // The parents are processed first, so their count is already final
+            if (node->m_parent)
+                node->m_nbSubtreeSubscriptions += node->m_parent->m_nbSubtreeSubscriptions;
+
+            if (node->m_journal)
+            {
+                if (node->m_parent)
+                    node->m_journal->record(SE_ATTACHED, node, node->m_parent, nullptr);
+
+                for (const std::string& tag : node->m_tags)
+                    node->m_journal->record(SE_TAG_ADDED, node, node->m_parent,
+                                            node->m_parent, tag);
+            }
+        }
+
+        assert(sorted.size() == count);
+        return true;
+    }
+
+    //-----------------------------------------------------------------------
+
+    void Transforms::setJournal(StructureJournal* journal)
+    {
+        m_journal = journal;
+
+        for (Transforms* child : m_children)
+            child->setJournal(journal);
+    }
+
+
+    /*************************************** TAGS ***************************************/
+
+    void Transforms::addTag(const std::string& tag)
+    {
+        assert(!tag.empty());
+        m_tags.push_back(tag);
+
+        if (m_journal)
+            m_journal->record(SE_TAG_ADDED, this, m_parent, m_parent, tag);
+    }
+
+    //-----------------------------------------------------------------------
+
+    void Transforms::removeTag(const std::string& tag)
+    {
+        assert(!tag.empty());
+
+        auto iter = std::find(m_tags.begin(), m_tags.end(), tag);
+        if (iter == m_tags.end())
+            return;
+
+        m_tags.erase(iter);
+
+        if (m_journal)
+            m_journal->record(SE_TAG_REMOVED, this, m_parent, m_parent, tag);
+    }
+
+
+    /******************************** MATRIX CONVERSIONS ********************************/
+
+    void Transforms::set(const mat4& matrix)
+    {
+        glm::vec3 skew;
+        glm::vec4 perspective;
+
+        glm::decompose(matrix, m_scale, m_orientation, m_position, skew, perspective);
+
+        needUpdate();
+    }
+
+
+    mat4 Transforms::getWorldMatrix()
+    {
+        if (m_bDirty)
+            update();
+
+        mat3 rot3x3(m_fullOrientation);
+
+        return mat4(
+            m_fullScale.x * rot3x3[0][0], m_fullScale.x * rot3x3[0][1], m_fullScale.x * rot3x3[0][2], 0.0f,
+            m_fullScale.y * rot3x3[1][0], m_fullScale.y * rot3x3[1][1], m_fullScale.y * rot3x3[1][2], 0.0f,
+            m_fullScale.z * rot3x3[2][0], m_fullScale.z * rot3x3[2][1], m_fullScale.z * rot3x3[2][2], 0.0f,
+            m_fullPosition.x, m_fullPosition.y, m_fullPosition.z, 1.0f
+        );
+    }
+
+
+    mat4 Transforms::getWorldInverseMatrix()
+    {
+        if (m_bDirty)
+            update();
+
+        // Inverse of T * R * S is S^-1 * R^-1 * T^-1
+        mat3 rot3x3(m_fullInverseOrientation);
+        const vec3& invScale = m_fullInverseScale;
+
+        mat3 m(
+            invScale.x * rot3x3[0][0], invScale.y * rot3x3[0][1], invScale.z * rot3x3[0][2],
+            invScale.x * rot3x3[1][0], invScale.y * rot3x3[1][1], invScale.z * rot3x3[1][2],
+            invScale.x * rot3x3[2][0], invScale.y * rot3x3[2][1], invScale.z * rot3x3[2][2]
+        );
+
+        vec3 t = -(m * m_fullPosition);
+
+        return mat4(
+            m[0][0], m[0][1], m[0][2], 0.0f,
+            m[1][0], m[1][1], m[1][2], 0.0f,
+            m[2][0], m[2][1], m[2][2], 0.0f,
+            t.x, t.y, t.z, 1.0f
+        );
+    }
+
+
+    mat4 Transforms::getMatrix()
+    {
+        mat3 rot3x3(m_orientation);
+
+        return mat4(
+            m_scale.x * rot3x3[0][0], m_scale.x * rot3x3[0][1], m_scale.x * rot3x3[0][2], 0.0f,
+            m_scale.y * rot3x3[1][0], m_scale.y * rot3x3[1][1], m_scale.y * rot3x3[1][2], 0.0f,
+            m_scale.z * rot3x3[2][0], m_scale.z * rot3x3[2][1], m_scale.z * rot3x3[2][2], 0.0f,
+            m_position.x, m_position.y, m_position.z, 1.0f
+        );
+    }
+
+
+    /************************************* POSITION *************************************/
+
+    void Transforms::setPosition(const vec3& pos)
+    {
+        m_position = pos;
+        needUpdate();
+    }
+
+    //-----------------------------------------------------------------------
+
+    void Transforms::setPosition(real x, real y, real z)
+    {
+        m_position.x = x;
+        m_position.y = y;
+        m_position.z = z;
+        needUpdate();
+    }
+
+    //-----------------------------------------------------------------------
+
+    void Transforms::setPosition(real* pos)
+    {
+        m_position.x = pos[0];
+        m_position.y = pos[1];
+        m_position.z = pos[2];
+        needUpdate();
+    }
+
+    //-----------------------------------------------------------------------
+
+    void Transforms::translate(const vec3& d, transform_space_t relativeTo)
+    {
+        switch(relativeTo)
+        {
+        case TS_LOCAL:
+            // Position is relative to parent so transform downwards
+            m_position += m_orientation * d;
+            break;
+
+        case TS_PARENT:
+            m_position += d;
+            break;
+
+        case TS_WORLD:
+            {
+                // Position is relative to parent so transform upwards
+                if (m_parent)
+                {
+                    if (m_parent->m_bDirty)
+                        m_parent->update();
+
+                    m_position += (m_parent->m_fullInverseOrientation * d) * m_parent->m_fullInverseScale;
+                }
+                else
+                {
+                    m_position += d;
+                }
+                break;
+            }
+        }
+
+        needUpdate();
+    }
+
+    //-----------------------------------------------------------------------
+
+    void Transforms::translate(real x, real y, real z, transform_space_t relativeTo)
+    {
+        translate(vec3(x, y, z), relativeTo);
+    }
+
+    //-----------------------------------------------------------------------
+
+    void Transforms::translate(real* d, transform_space_t relativeTo)
+    {
+        translate(vec3(d[0], d[1], d[2]), relativeTo);
+    }
+
+    //-----------------------------------------------------------------------
+
+    void Transforms::translate(Transforms* const* nodes, const vec3* d, size_t count,
+                               transform_space_t relativeTo)
+    {
+        for (size_t i = 0; i < count; ++i)
+            nodes[i]->translate(d[i], relativeTo);
+    }
+
+    //-----------------------------------------------------------------------
+
+    void Transforms::setWorldPosition(const vec3& pos)
+    {
+        if (m_parent)
+        {
+            if (m_parent->m_bDirty)
+                m_parent->update();
+
+            m_position = (m_parent->m_fullInverseOrientation * (pos - m_parent->m_fullPosition)) *
+                         m_parent->m_fullInverseScale;
+        }
+        else
+        {
+            m_position = pos;
+        }
+
+        needUpdate();
+    }
+
+    //-----------------------------------------------------------------------
+
+    vec3 Transforms::getWorldPosition()
+    {
+        if (m_bDirty)
+            update();
+
+        return m_fullPosition;
+    }
+
+
+    /*************************************** ORIENTATION ***************************************/
+
+    void Transforms::setDirection(const vec3& vec, transform_space_t relativeTo,
+                                  const vec3& localDirectionVector)
+    {
+        // Do nothing if given a zero vector
+        if (vec == VEC3_ZERO)
+            return;
+
+        // The direction we want the local direction point to
+        vec3 targetDir = KNM_TRANSFORMS_TREE_NORMALISE(vec);
+
+        // Transform target direction to world space
+        switch (relativeTo)
+        {
+        case TS_LOCAL:
+            targetDir = getWorldOrientation() * targetDir;
+            break;
+
+        case TS_PARENT:
+            if (m_bInheritOrientation && m_parent)
+                targetDir = m_parent->getWorldOrientation() * targetDir;
+            break;
+
+        case TS_WORLD:
+            // default orientation
+            break;
+        }
+
+        // Calculate target orientation relative to world space
+        quat targetOrientation;
+
+        // Get current local direction relative to world space
+        const quat& currentOrient = getWorldOrientation();
+        vec3 currentDir = currentOrient * localDirectionVector;
+
+        if (KNM_TRANSFORMS_TREE_SQUARED_LENGTH(currentDir + targetDir) < 0.00005f)
+        {
+            // Oops, a 180 degree turn (infinite possible rotation axes)
+            // Default to pitch i.e. use current UP
+            targetOrientation =
+                quat(-currentOrient.y, -currentOrient.z, currentOrient.w, currentOrient.x);
+        }
+        else
+        {
+            // Derive shortest arc to new direction
+            quat rotQuat = Math::getRotationTo(currentDir, targetDir);
+            targetOrientation = rotQuat * currentOrient;
+        }
+
+        // Set target orientation, transformed to parent space
+        if (m_parent && m_bInheritOrientation)
+        {
+            quat q = m_parent->getWorldOrientation();
+            setOrientation(quat(q.w, -q.x, -q.y, -q.z) * targetOrientation);
+        }
+        else
+        {
+            setOrientation(targetOrientation);
+        }
+    }
+
+    //-----------------------------------------------------------------------
+
+    void Transforms::lookAt(const vec3& targetPoint, transform_space_t relativeTo,
+                            const vec3& localDirectionVector)
+    {
+        // Calculate our self origin relative to the given transform space
+        vec3 origin;
+        switch (relativeTo)
+        {
+        case TS_WORLD:
+            origin = getWorldPosition();
+            break;
+
+        case TS_PARENT:
+            origin = m_position;
+            break;
+
+        case TS_LOCAL:
+            origin = VEC3_ZERO;
+            break;
+        }
+
+        setDirection(targetPoint - origin, relativeTo, localDirectionVector);
+    }
+
+    //-----------------------------------------------------------------------
+
+    void Transforms::setOrientation(const quat& q)
+    {
+        m_orientation = q;
+        needUpdate();
+    }
+
+    //-----------------------------------------------------------------------
+
+    void Transforms::setOrientation(real x, real y, real z, real w)
+    {
+        m_orientation.w = w;
+        m_orientation.x = x;
+        m_orientation.y = y;
+        m_orientation.z = z;
+        needUpdate();
+    }
+
+    //-----------------------------------------------------------------------
+
+    void Transforms::setOrientation(real* q)
+    {
+        m_orientation.w = q[0];
+        m_orientation.x = q[1];
+        m_orientation.y = q[2];
+        m_orientation.z = q[3];
+        needUpdate();
+    }
+
+    //-----------------------------------------------------------------------
+
+    void Transforms::roll(real angle, transform_space_t relativeTo)
+    {
+        rotate(VEC3_UNIT_X, angle, relativeTo);
+    }
+
+    //-----------------------------------------------------------------------
+
+    void Transforms::pitch(real angle, transform_space_t relativeTo)
+    {
+        rotate(VEC3_UNIT_Y, angle, relativeTo);
+    }
+
+    //-----------------------------------------------------------------------
+
+    void Transforms::yaw(real angle, transform_space_t relativeTo)
+    {
+        rotate(VEC3_UNIT_Z, angle, relativeTo);
+    }
+
+    //-----------------------------------------------------------------------
+
+    void Transforms::rotate(const vec3& axis, real angle,
+                            transform_space_t relativeTo)
+    {
+        rotate(KNM_TRANSFORMS_TREE_ANGLE_AXIS(angle, axis), relativeTo);
+    }
+
+    //-----------------------------------------------------------------------
+
+    void Transforms::rotate(const quat& q, transform_space_t relativeTo)
+    {
+        switch (relativeTo)
+        {
+        case TS_PARENT:
+            // Rotations are normally relative to local axes, transform up
+            m_orientation = q * m_orientation;
+            break;
+
+        case TS_WORLD:
+            // Rotations are normally relative to local axes, transform up
+            if (m_bDirty)
+                update();
+
+            m_orientation = m_orientation * m_fullInverseOrientation * q * m_fullOrientation;
+            break;
+
+        case TS_LOCAL:
+            // Note the order of the mult, i.e. q comes after
+            m_orientation = m_orientation * q;
+            break;
+        }
+
+        needUpdate();
+    }
+
+    //-----------------------------------------------------------------------
+
+    void Transforms::rotate(Transforms* const* nodes, const quat* q, size_t count,
+                            transform_space_t relativeTo)
+    {
+        for (size_t i = 0; i < count; ++i)
+            nodes[i]->rotate(q[i], relativeTo);
+    }
+
+    //-----------------------------------------------------------------------
+
+    void Transforms::resetOrientation()
+    {
+        m_orientation = QUAT_IDENTITY;
+        needUpdate();
+    }
+
+    //-----------------------------------------------------------------------
+
+    void Transforms::setInheritOrientation(bool bInherit)
+    {
+        m_bInheritOrientation = bInherit;
+        needUpdate();
+    }
+
+    //-----------------------------------------------------------------------
+
+    void Transforms::setWorldOrientation(const quat& q)
+    {
+        if (m_parent && m_bInheritOrientation)
+        {
+            if (m_parent->m_bDirty)
+                m_parent->update();
+
+            m_orientation = m_parent->m_fullInverseOrientation * q;
+        }
+        else
+        {
+            m_orientation = q;
+        }
+
+        needUpdate();
+    }
+
+    //-----------------------------------------------------------------------
+
+    quat Transforms::getWorldOrientation()
+    {
+        if (m_bDirty)
+            update();
+
+        return m_fullOrientation;
+    }
+
+
+    /**************************************** SCALE *****************************************/
+
+    void Transforms::setScale(const vec3& scale)
+    {
+        m_scale = scale;
+        needUpdate();
+    }
+
+    //-----------------------------------------------------------------------
+
+    void Transforms::setScale(real x, real y, real z)
+    {
+        m_scale.x = x;
+        m_scale.y = y;
+        m_scale.z = z;
+        needUpdate();
+    }
+
+    //-----------------------------------------------------------------------
+
+    void Transforms::setScale(real scale)
+    {
+        m_scale.x = scale;
+        m_scale.y = scale;
+        m_scale.z = scale;
+        needUpdate();
+    }
+
+    //-----------------------------------------------------------------------
+
+    void Transforms::setScale(real* scale)
+    {
+        m_scale.x = scale[0];
+        m_scale.y = scale[1];
+        m_scale.z = scale[2];
+        needUpdate();
+    }
+
+    //-----------------------------------------------------------------------
+
+    void Transforms::scale(const vec3& scale)
+    {
+        m_scale = m_scale * scale;
+        needUpdate();
+    }
+
+    //-----------------------------------------------------------------------
+
+    void Transforms::scale(real x, real y, real z)
+    {
+        scale(vec3(x, y, z));
+    }
+
+    //-----------------------------------------------------------------------
+
+    void Transforms::scale(real* scales)
+    {
+        scale(vec3(scales[0], scales[1], scales[2]));
+    }
+
+    //-----------------------------------------------------------------------
+
+    void Transforms::setInheritScale(bool bInherit)
+    {
+        m_bInheritScale = bInherit;
+        needUpdate();
+    }
+
+    //-----------------------------------------------------------------------
+
+    void Transforms::setWorldScale(const vec3& scale)
+    {
+        if (m_parent && m_bInheritScale)
+        {
+            if (m_parent->m_bDirty)
+                m_parent->update();
+
+            m_scale = scale * m_parent->m_fullInverseScale;
+        }
+        else
+        {
+            m_scale = scale;
+        }
+
+        needUpdate();
+    }
+
+    //-----------------------------------------------------------------------
+
+    vec3 Transforms::getWorldScale()
+    {
+        if (m_bDirty)
+            update();
+
+        return m_fullScale;
+    }
+
+
+    /************************************** BOUNDS **************************************/
+
+    void Transforms::setLocalBounds(const aabb_t& bounds)
+    {
+        m_localBounds = bounds;
+        m_bHasBounds = true;
+
+        if (!m_bDirty)
+            updateWorldBounds();
+
+        needBoundsRefit();
+    }
+
+    //-----------------------------------------------------------------------
+
+    void Transforms::clearLocalBounds()
+    {
+        m_localBounds = aabb_t();
+        m_worldBounds = aabb_t();
+        m_bHasBounds = false;
+
+        needBoundsRefit();
+    }
+
+    //-----------------------------------------------------------------------
+
+    aabb_t Transforms::getWorldBounds()
+    {
+        if (m_bDirty)
+            update();
+
+        return m_worldBounds;
+    }
+
+    //-----------------------------------------------------------------------
+
+    aabb_t Transforms::getSubtreeBounds()
+    {
+        if (m_bSubtreeBoundsDirty)
+            refitSubtreeBounds();
+
+        return m_subtreeBounds;
+    }
+
+    //-----------------------------------------------------------------------
+
+    size_t Transforms::findInBox(const aabb_t& box, std::vector<Transforms*>& result)
+    {
+        result.clear();
+
+        if (m_bSubtreeBoundsDirty)
+            refitSubtreeBounds();
+
+        collectInBox(box, result);
+
+        return result.size();
+    }
+
+    //-----------------------------------------------------------------------
+
+    size_t Transforms::findInSphere(const vec3& center, real radius,
+                                    std::vector<Transforms*>& result)
+    {
+        result.clear();
+
+        if (m_bSubtreeBoundsDirty)
+            refitSubtreeBounds();
+
+        collectInSphere(center, radius, result);
+
+        return result.size();
+    }
+
+    //-----------------------------------------------------------------------
+
+    void Transforms::collectInBox(const aabb_t& box, std::vector<Transforms*>& result)
+    {
+        if (!m_subtreeBounds.intersects(box))
+            return;
+
+        if (m_bHasBounds && m_worldBounds.intersects(box))
+            result.push_back(this);
+
+        for (Transforms* child : m_children)
+            child->collectInBox(box, result);
+    }
+
+    //-----------------------------------------------------------------------
+
+    void Transforms::collectInSphere(const vec3& center, real radius,
+                                     std::vector<Transforms*>& result)
+    {
+        if (!m_subtreeBounds.intersects(center, radius))
+            return;
+
+        if (m_bHasBounds && m_worldBounds.intersects(center, radius))
+            result.push_back(this);
+
+        for (Transforms* child : m_children)
+            child->collectInSphere(center, radius, result);
+    }
+
+
+    //-----------------------------------------------------------------------
+
+    size_t Transforms::raycast(const ray_t& ray, std::vector<ray_hit_t>& hits,
+                               real maxDistance)
+    {
+        hits.clear();
+
+        real length = glm::length(ray.direction);
+        if (length <= 0.0f)
+            return 0;
+
+        if (m_bSubtreeBoundsDirty)
+            refitSubtreeBounds();
+
+        // Distances are computed in world units
+        ray_t normalised;
+        normalised.origin = ray.origin;
+        normalised.direction = ray.direction / length;
+
+        collectHits(normalised, maxDistance, hits);
+
+        std::sort(hits.begin(), hits.end(), [](const ray_hit_t& a, const ray_hit_t& b) {
+            return a.distance < b.distance;
+        });
+
+        return hits.size();
+    }
+
+    //-----------------------------------------------------------------------
+
+    void Transforms::raycast(const ray_t* rays, size_t count, std::vector<ray_hit_t>* hits,
+                             real maxDistance)
+    {
+        for (size_t i = 0; i < count; ++i)
+            raycast(rays[i], hits[i], maxDistance);
+    }
+
+    //-----------------------------------------------------------------------
+
+    void Transforms::collectHits(const ray_t& ray, real maxDistance,
+                                 std::vector<ray_hit_t>& hits)
+    {
+        real distance;
+
+        if (!Math::intersects(ray.origin, ray.direction, m_subtreeBounds, maxDistance, distance))
+            return;
+
+        if (m_bHasBounds && !m_localBounds.isEmpty())
+        {
+            // Convert the ray into local space instead of the box into world space.
+            // Since the conversion is affine, the distances along the ray are
+            // preserved.
+            vec3 origin = (m_fullInverseOrientation * (ray.origin - m_fullPosition)) * m_fullInverseScale;
+            vec3 direction = (m_fullInverseOrientation * ray.direction) * m_fullInverseScale;
+
+            if (Math::intersects(origin, direction, m_localBounds, maxDistance, distance))
+            {
+                ray_hit_t hit;
+                hit.transforms = this;
+                hit.distance = distance;
+                hits.push_back(hit);
+            }
+        }
+
+        for (Transforms* child : m_children)
+            child->collectHits(ray, maxDistance, hits);
+    }
+
+
+    /********************************* LOCAL TRANSFORMS *********************************/
+
+    void Transforms::setTransforms(const pose_t& pose)
+    {
+        m_position = pose.position;
+        m_orientation = pose.orientation;
+        m_scale = pose.scale;
+
+        needUpdate();
+    }
+
+    //-----------------------------------------------------------------------
+
+    void Transforms::setTransforms(Transforms* const* nodes, const pose_t* poses,
+                                   size_t count)
+    {
+        // Invalidating a Transforms below one already invalidated stops immediately
+        for (size_t i = 0; i < count; ++i)
+            nodes[i]->setTransforms(poses[i]);
+    }
+
+
+    /********************************* WORLD TRANSFORMS *********************************/
+
+    void Transforms::setWorldTransforms(const pose_t& pose)
+    {
+        if (m_parent)
+        {
+            if (m_parent->m_bDirty)
+                m_parent->update();
+
+            m_position = (m_parent->m_fullInverseOrientation * (pose.position - m_parent->m_fullPosition)) *
+                         m_parent->m_fullInverseScale;
+
+            m_orientation = (m_bInheritOrientation ?
+                                m_parent->m_fullInverseOrientation * pose.orientation :
+                                pose.orientation);
+
+            m_scale = (m_bInheritScale ? pose.scale * m_parent->m_fullInverseScale : pose.scale);
+        }
+        else
+        {
+            m_position = pose.position;
+            m_orientation = pose.orientation;
+            m_scale = pose.scale;
+        }
+
+        needUpdate();
+    }
+
+    //-----------------------------------------------------------------------
+
+    void Transforms::setWorldTransforms(Transforms* const* nodes, const pose_t* poses,
+                                        size_t count)
+    {
+        // Sort the Transforms by depth in the hierarchy, so the parents are processed
+        // before their children
+        std::vector<std::pair<size_t, size_t> > order;
+        order.reserve(count);
+
+        for (size_t i = 0; i < count; ++i)
+        {
+            size_t depth = 0;
+            for (Transforms* parent = nodes[i]->m_parent; parent; parent = parent->m_parent)
+                ++depth;
+
+            order.push_back(std::make_pair(depth, i));
+        }
+
+        std::stable_sort(order.begin(), order.end());
+
+        for (const auto& entry : order)
+            nodes[entry.second]->setWorldTransforms(poses[entry.second]);
+    }
+
+    //-----------------------------------------------------------------------
+
+    pose_t Transforms::getWorldTransforms()
+    {
+        if (m_bDirty)
+            update();
+
+        pose_t pose;
+        pose.position = m_fullPosition;
+        pose.orientation = m_fullOrientation;
+        pose.scale = m_fullScale;
+
+        return pose;
+    }
+
+
+    /******************************** SPACE CONVERSIONS *********************************/
+
+    void Transforms::convertPoints(Transforms* from, Transforms* to, const vec3* in,
+                                   vec3* out, size_t count)
+    {
+        mat4 matrix(1.0f);
+
+        if (from)
+            matrix = from->getWorldMatrix();
+
+        if (to)
+            matrix = to->getWorldInverseMatrix() * matrix;
+
+        Math::transformPoints(matrix, in, out, count);
+    }
+
+    //-----------------------------------------------------------------------
+
+    void Transforms::convertVectors(Transforms* from, Transforms* to, const vec3* in,
+                                    vec3* out, size_t count)
+    {
+        mat4 matrix(1.0f);
+
+        if (from)
+            matrix = from->getWorldMatrix();
+
+        if (to)
+            matrix = to->getWorldInverseMatrix() * matrix;
+
+        Math::transformVectors(mat3(matrix), in, out, count);
+    }
+
+    //-----------------------------------------------------------------------
+
+    void Transforms::convertDirections(Transforms* from, Transforms* to, const vec3* in,
+                                       vec3* out, size_t count)
+    {
+        quat q = QUAT_IDENTITY;
+
+        if (from)
+            q = from->getWorldOrientation();
+
+        if (to)
+        {
+            if (to->m_bDirty)
+                to->update();
+
+            q = to->m_fullInverseOrientation * q;
+        }
+
+        Math::transformVectors(mat3(q), in, out, count);
+    }
+
+    //-----------------------------------------------------------------------
+
+    void Transforms::convertOrientations(Transforms* from, Transforms* to,
+                                         const quat* in, quat* out, size_t count)
+    {
+        quat q = QUAT_IDENTITY;
+
+        if (from)
+            q = from->getWorldOrientation();
+
+        if (to)
+        {
+            if (to->m_bDirty)
+                to->update();
+
+            q = to->m_fullInverseOrientation * q;
+        }
+
+        for (size_t i = 0; i < count; ++i)
+            out[i] = q * in[i];
+    }
+
+
+    /*********************************** UPDATE PASS ************************************/
+
+    size_t Transforms::updateHierarchy(std::vector<Transforms*>& changed)
+    {
+        size_t count = changed.size();
+
+        if (m_bSubtreeChanged)
+            collectChanges(changed);
+
+        return changed.size() - count;
+    }
+
+
+    /********************************* PRIVATE METHODS **********************************/
+
+    void Transforms::needUpdate()
+    {
+        invalidate();
+
+        // The bounds of the parents must be refitted, and the next update pass must
+        // reach this Transforms
+        if (m_parent)
+        {
+            m_parent->needBoundsRefit();
+            m_parent->needUpdatePass();
+        }
+    }
+
+    //-----------------------------------------------------------------------
+
+    void Transforms::invalidate()
+    {
+        // A dirty Transforms can only have dirty children (they are updated after
+        // their parent), so there is no need to traverse the hierarchy again
+        if (m_bDirty)
+            return;
+
+        m_bDirty = true;
+        m_bSubtreeBoundsDirty = true;
+        m_bChanged = true;
+        m_bSubtreeChanged = true;
+        ++m_revision;
+
+        for (Transforms* child : m_children)
+            child->invalidate();
+    }
+
+    //-----------------------------------------------------------------------
+
+    void Transforms::update()
+    {
+        if (!m_bDirty)
+            return;
+
+        if (m_parent)
+        {
+            // Update orientation
+            const quat& parentOrientation = m_parent->getWorldOrientation();
+            if (m_bInheritOrientation)
+            {
+                // Combine orientation with that of parent
+                m_fullOrientation = KNM_TRANSFORMS_TREE_NORMALISE(parentOrientation * m_orientation);
+            }
+            else
+            {
+                // No inheritence
+                m_fullOrientation = m_orientation;
+            }
+
+            // Update scale
+            const vec3& parentScale = m_parent->getWorldScale();
+            if (m_bInheritScale)
+            {
+                // Scale own position by parent scale, NB just combine
+                // as equivalent axes, no shearing
+                m_fullScale = parentScale * m_scale;
+            }
+            else
+            {
+                // No inheritence
+                m_fullScale = m_scale;
+            }
+
+            // Change position vector based on parent's orientation & scale
+            m_fullPosition = parentOrientation * (parentScale * m_position);
+
+            // Add altered position vector to parents
+            m_fullPosition += m_parent->getWorldPosition();
+        }
+        else
+        {
+            // No parent
+            m_fullPosition      = m_position;
+            m_fullOrientation   = m_orientation;
+            m_fullScale         = m_scale;
+        }
+
+        // Cache the inverse transforms, used by all the conversions from world space
+        m_fullInverseOrientation = KNM_TRANSFORMS_TREE_INVERSE(m_fullOrientation);
+        m_fullInverseScale = VEC3_UNIT_SCALE / m_fullScale;
+
+        m_bDirty = false;
+
+        if (m_bHasBounds)
+            updateWorldBounds();
+    }
+
+    //-----------------------------------------------------------------------
+
+    void Transforms::needBoundsRefit()
+    {
+        // If a Transforms must be refitted, so are all the ones above it
+        for (Transforms* transforms = this;
+             transforms && !transforms->m_bSubtreeBoundsDirty;
+             transforms = transforms->m_parent)
+        {
+            transforms->m_bSubtreeBoundsDirty = true;
+        }
+    }
+
+    //-----------------------------------------------------------------------
+
+    void Transforms::needUpdatePass()
+    {
+        // Same as for the bounds: the update pass must traverse all the Transforms
+        // above a modified one
+        for (Transforms* transforms = this;
+             transforms && !transforms->m_bSubtreeChanged;
+             transforms = transforms->m_parent)
+        {
+            transforms->m_bSubtreeChanged = true;
+        }
+    }
+
+    //-----------------------------------------------------------------------
+
+    void Transforms::collectChanges(std::vector<Transforms*>& changed)
+    {
+        if (m_bChanged)
+        {
+            if (m_bDirty)
+                update();
+
+            changed.push_back(this);
+            m_bChanged = false;
+        }
+
+        for (Transforms* child : m_children)
+        {
+            if (child->m_bSubtreeChanged)
+                child->collectChanges(changed);
+        }
+
+        m_bSubtreeChanged = false;
+    }
+
+    //-----------------------------------------------------------------------
+
+    void Transforms::addSubtreeSubscriptions(int32_t delta)
+    {
+        m_nbSubtreeSubscriptions = uint32_t(int32_t(m_nbSubtreeSubscriptions) + delta);
+
+        for (Transforms* child : m_children)
+            child->addSubtreeSubscriptions(delta);
+    }
+
+    //-----------------------------------------------------------------------
+
+    void Transforms::updateWorldBounds()
+    {
+        if (m_localBounds.isEmpty())
+        {
+            m_worldBounds = aabb_t();
+            return;
+        }
+
+        // Transform the center of the box, and project its rotated and scaled
+        // extents on the world axes
+        mat3 rot3x3(m_fullOrientation);
+        vec3 center = m_fullOrientation * (m_fullScale * m_localBounds.getCenter()) +
+                      m_fullPosition;
+        vec3 extents = glm::abs(m_fullScale) * m_localBounds.getExtents();
+
+        vec3 worldExtents(
+            std::abs(rot3x3[0][0]) * extents.x + std::abs(rot3x3[1][0]) * extents.y + std::abs(rot3x3[2][0]) * extents.z,
+            std::abs(rot3x3[0][1]) * extents.x + std::abs(rot3x3[1][1]) * extents.y + std::abs(rot3x3[2][1]) * extents.z,
+            std::abs(rot3x3[0][2]) * extents.x + std::abs(rot3x3[1][2]) * extents.y + std::abs(rot3x3[2][2]) * extents.z
+        );
+
+        m_worldBounds = aabb_t(center - worldExtents, center + worldExtents);
+    }
+
+    //-----------------------------------------------------------------------
+
+    void Transforms::refitSubtreeBounds()
+    {
+        if (m_bDirty)
+            update();
+
+        m_subtreeBounds = (m_bHasBounds ? m_worldBounds : aabb_t());
+
+        for (Transforms* child : m_children)
+        {
+            if (child->m_bSubtreeBoundsDirty)
+                child->refitSubtreeBounds();
+
+            m_subtreeBounds.merge(child->m_subtreeBounds);
+        }
+
+        m_bSubtreeBoundsDirty = false;
+    }
+
+
+    /************************************** MATH ****************************************/
+
+    quat Math::getRotationTo(const vec3& from, const vec3& dest,
+                             const vec3& fallbackAxis)
+    {
+        // Based on Stan Melax's article in Game Programming Gems
+        quat q;
+        vec3 v0 = KNM_TRANSFORMS_TREE_NORMALISE(from);
+        vec3 v1 = KNM_TRANSFORMS_TREE_NORMALISE(dest);
+
+        real d = KNM_TRANSFORMS_TREE_DOT(v0, v1);
+        // If dot == 1, vectors are the same
+        if (d >= 1.0f)
+        {
+            return QUAT_IDENTITY;
+        }
+        if (d < (1e-6f - 1.0f))
+        {
+            if (fallbackAxis != VEC3_ZERO)
+            {
+                // rotate 180 degrees about the fallback axis
+                q = KNM_TRANSFORMS_TREE_ANGLE_AXIS(PI, fallbackAxis);
+            }
+            else
+            {
+                // Generate an axis
+                vec3 axis = KNM_TRANSFORMS_TREE_CROSS(VEC3_UNIT_X, from);
+                if (KNM_TRANSFORMS_TREE_SQUARED_LENGTH(axis) < 1e-6f) // pick another if colinear
+                    axis = KNM_TRANSFORMS_TREE_CROSS(VEC3_UNIT_Y, from);
+                axis = KNM_TRANSFORMS_TREE_NORMALISE(axis);
+                q = KNM_TRANSFORMS_TREE_ANGLE_AXIS(PI, axis);
+            }
+        }
+        else
+        {
+            real s = sqrt((1.0f + d) * 2.0f);
+            real invs = 1.0f / s;
+
+            vec3 c = KNM_TRANSFORMS_TREE_CROSS(v0, v1);
+
+            q.x = c.x * invs;
+            q.y = c.y * invs;
+            q.z = c.z * invs;
+            q.w = s * 0.5f;
+
+            q = KNM_TRANSFORMS_TREE_NORMALISE(q);
+        }
+
+        return q;
+    }
+
+    //-----------------------------------------------------------------------
+
+    bool Math::intersects(const vec3& origin, const vec3& direction, const aabb_t& box,
+                          real maxDistance, real& distance)
+    {
+        if (box.isEmpty())
+            return false;
+
+        real tmin = 0.0f;
+        real tmax = maxDistance;
+
+        for (int i = 0; i < 3; ++i)
+        {
+            if (direction[i] == 0.0f)
+            {
+                // Parallel to the slab
+                if ((origin[i] < box.min[i]) || (origin[i] > box.max[i]))
+                    return false;
+
+                continue;
+            }
+
+            real invDirection = 1.0f / direction[i];
+            real t1 = (box.min[i] - origin[i]) * invDirection;
+            real t2 = (box.max[i] - origin[i]) * invDirection;
+
+            if (t1 > t2)
+                std::swap(t1, t2);
+
+            tmin = std::max(tmin, t1);
+            tmax = std::min(tmax, t2);
+
+            if (tmin > tmax)
+                return false;
+        }
+
+        distance = tmin;
+        return true;
+    }
+
+    //-----------------------------------------------------------------------
+
+    void Math::transformPoints(const mat4& matrix, const vec3* in, vec3* out,
+                               size_t count)
+    {
+        const real m00 = matrix[0][0], m01 = matrix[0][1], m02 = matrix[0][2];
+        const real m10 = matrix[1][0], m11 = matrix[1][1], m12 = matrix[1][2];
+        const real m20 = matrix[2][0], m21 = matrix[2][1], m22 = matrix[2][2];
+        const real m30 = matrix[3][0], m31 = matrix[3][1], m32 = matrix[3][2];
+
+        for (size_t i = 0; i < count; ++i)
+        {
+            const real x = in[i].x;
+            const real y = in[i].y;
+            const real z = in[i].z;
+
+            out[i].x = m00 * x + m10 * y + m20 * z + m30;
+            out[i].y = m01 * x + m11 * y + m21 * z + m31;
+            out[i].z = m02 * x + m12 * y + m22 * z + m32;
+        }
+    }
+
+    //-----------------------------------------------------------------------
+
+    void Math::transformVectors(const mat3& matrix, const vec3* in, vec3* out,
+                                size_t count)
+    {
+        const real m00 = matrix[0][0], m01 = matrix[0][1], m02 = matrix[0][2];
+        const real m10 = matrix[1][0], m11 = matrix[1][1], m12 = matrix[1][2];
+        const real m20 = matrix[2][0], m21 = matrix[2][1], m22 = matrix[2][2];
+
+        for (size_t i = 0; i < count; ++i)
+        {
+            const real x = in[i].x;
+            const real y = in[i].y;
+            const real z = in[i].z;
+
+            out[i].x = m00 * x + m10 * y + m20 * z;
+            out[i].y = m01 * x + m11 * y + m21 * z;
+            out[i].z = m02 * x + m12 * y + m22 * z;
+        }
+    }
+
+
+
+    //-----------------------------------------------------------------------
+
+    uint32_t Math::quantize(real value, real min, real max, uint32_t nbBits)
+    {
+        assert((nbBits >= 1) && (nbBits <= 24));
+        assert(max > min);
+
+        const uint32_t maxValue = (1u << nbBits) - 1;
+
+        real t = (std::min(std::max(value, min), max) - min) / (max - min);
+        return std::min(uint32_t(t * real(maxValue) + 0.5f), maxValue);
+    }
+
+    //-----------------------------------------------------------------------
+
+    real Math::dequantize(uint32_t value, real min, real max, uint32_t nbBits)
+    {
+        assert((nbBits >= 1) && (nbBits <= 24));
+
+        const uint32_t maxValue = (1u << nbBits) - 1;
+
+        return min + (max - min) * (real(value) / real(maxValue));
+    }
+
+    //-----------------------------------------------------------------------
+
+    pose_t Math::interpolate(const pose_t& from, const pose_t& to, real t)
+    {
+        pose_t pose;
+        pose.position = glm::mix(from.position, to.position, t);
+        pose.orientation = glm::slerp(from.orientation, to.orientation, t);
+        pose.scale = glm::mix(from.scale, to.scale, t);
+        return pose;
+    }
+
+
+    /********************************** SPATIAL INDEX ***********************************/
+
+    const SpatialIndex::cell_key_t SpatialIndex::NO_CELL;
+
+    //-----------------------------------------------------------------------
+
+    SpatialIndex::SpatialIndex(real cellSize)
+    : m_cellSize(cellSize), m_invCellSize(1.0f / cellSize)
+    {
+        assert(cellSize > 0.0f);
+    }
+
+    //-----------------------------------------------------------------------
+
+    void SpatialIndex::add(Transforms* transforms)
+    {
+        assert(transforms);
+
+        if (contains(transforms))
+            return;
+
+        entry_t entry;
+        entry.transforms = transforms;
+        entry.revision = transforms->getRevision();
+        entry.position = transforms->getWorldPosition();
+        placeEntry(entry);
+
+        m_indices[transforms] = m_entries.size();
+        m_entries.push_back(entry);
+
+        insertInCell(m_entries.size() - 1);
+    }
+
+    //-----------------------------------------------------------------------
+
+    void SpatialIndex::addHierarchy(Transforms* root)
+    {
+        assert(root);
+
+        add(root);
+
+        for (Transforms* child : root->m_children)
+            addHierarchy(child);
+    }
+
+    //-----------------------------------------------------------------------
+
+    void SpatialIndex::remove(Transforms* transforms)
+    {
+        auto iter = m_indices.find(transforms);
+        if (iter == m_indices.end())
+            return;
+
+        size_t index = iter->second;
+        size_t last = m_entries.size() - 1;
+
+        removeFromCell(index);
+        m_indices.erase(iter);
+
+        if (index != last)
+        {
+            // Move the last entry in the freed slot
+            removeFromCell(last);
+            m_entries[index] = m_entries[last];
+            m_indices[m_entries[index].transforms] = index;
+            insertInCell(index);
+        }
+
+        m_entries.pop_back();
+    }
+
+    //-----------------------------------------------------------------------
+
+    void SpatialIndex::clear()
+    {
+        m_entries.clear();
+        m_indices.clear();
+        m_cells.clear();
+    }
+
+    //-----------------------------------------------------------------------
+
+    size_t SpatialIndex::refresh()
+    {
+        size_t nb = 0;
+
+        for (size_t i = 0; i < m_entries.size(); ++i)
+        {
+            if (m_entries[i].revision != m_entries[i].transforms->getRevision())
+            {
+                updateEntry(i);
+                ++nb;
+            }
+        }
+
+        return nb;
+    }
+
+    //-----------------------------------------------------------------------
+
+    void SpatialIndex::refresh(Transforms* const* nodes, size_t count)
+    {
+        for (size_t i = 0; i < count; ++i)
+        {
+            auto iter = m_indices.find(nodes[i]);
+            if (iter != m_indices.end())
+                updateEntry(iter->second);
+        }
+    }
+
+    //-----------------------------------------------------------------------
+
+    vec3 SpatialIndex::getPosition(Transforms* transforms) const
+    {
+        auto iter = m_indices.find(transforms);
+        assert(iter != m_indices.end());
+
+        return m_entries[iter->second].position;
+    }
+
+    //-----------------------------------------------------------------------
+
+    size_t SpatialIndex::queryRadius(const vec3& center, real radius,
+                                     std::vector<Transforms*>& result) const
+    {
+        result.clear();
+
+        const vec3 extent(radius, radius, radius);
+        const real radius2 = radius * radius;
+
+        std::vector<size_t> indices;
+        collect(center - extent, center + extent, indices);
+
+        for (size_t index : indices)
+        {
+            const entry_t& entry = m_entries[index];
+            if (KNM_TRANSFORMS_TREE_SQUARED_LENGTH(entry.position - center) <= radius2)
+                result.push_back(entry.transforms);
+        }
+
+        return result.size();
+    }
+
+    //-----------------------------------------------------------------------
+
+    size_t SpatialIndex::queryBox(const vec3& min, const vec3& max,
+                                  std::vector<Transforms*>& result) const
+    {
+        result.clear();
+
+        std::vector<size_t> indices;
+        collect(min, max, indices);
+
+        for (size_t index : indices)
+            result.push_back(m_entries[index].transforms);
+
+        return result.size();
+    }
+
+    //-----------------------------------------------------------------------
+
+    size_t SpatialIndex::queryNearest(const vec3& point, size_t k,
+                                      std::vector<Transforms*>& result) const
+    {
+        result.clear();
+
+        if ((k == 0) || m_entries.empty())
+            return 0;
+
+        std::vector<std::pair<real, size_t> > candidates;
+        bool fullScan = (k >= m_entries.size());
+
+        if (!fullScan)
+        {
+            // Grow the search radius until enough Transforms are found: the k
+            // nearest ones are then necessarily inside the sphere
+            std::vector<size_t> indices;
+
+            for (real radius = m_cellSize; candidates.size() < k; radius *= 2.0f)
+            {
+                const vec3 extent(radius, radius, radius);
+                const real radius2 = radius * radius;
+
+                // The sphere can't grow anymore (not enough Transforms with a
+                // finite position, or too far away)
+                if (!std::isfinite(radius2))
+                {
+                    fullScan = true;
+                    break;
+                }
+
+                indices.clear();
+                candidates.clear();
+                collect(point - extent, point + extent, indices);
+
+                for (size_t index : indices)
+                {
+                    real distance2 = KNM_TRANSFORMS_TREE_SQUARED_LENGTH(m_entries[index].position - point);
+                    if (distance2 <= radius2)
+                        candidates.push_back(std::make_pair(distance2, index));
+                }
+            }
+        }
+
+        if (fullScan)
+        {
+            candidates.clear();
+
+            for (size_t i = 0; i < m_entries.size(); ++i)
+            {
+                if (m_entries[i].cell != NO_CELL)
+                    candidates.push_back(std::make_pair(KNM_TRANSFORMS_TREE_SQUARED_LENGTH(m_entries[i].position - point), i));
+            }
+        }
+
+        k = std::min(k, candidates.size());
+
+        std::partial_sort(candidates.begin(), candidates.begin() + k, candidates.end());
+
+        for (size_t i = 0; i < k; ++i)
+            result.push_back(m_entries[candidates[i].second].transforms);
+
+        return k;
+    }
+
+    //-----------------------------------------------------------------------
+
+    void SpatialIndex::collect(const vec3& min, const vec3& max,
+                               std::vector<size_t>& indices) const
+    {
+        int32_t minCoords[3];
+        int32_t maxCoords[3];
+        getCellCoords(min, minCoords);
+        getCellCoords(max, maxCoords);
+
+        double nbCells = (double(maxCoords[0]) - double(minCoords[0]) + 1.0) *
+                         (double(maxCoords[1]) - double(minCoords[1]) + 1.0) *
+                         (double(maxCoords[2]) - double(minCoords[2]) + 1.0);
+
+        if (nbCells > double(m_cells.size()))
+        {
+            // Less work to test all the Transforms than to look up all the cells
+            // covered by the box
+            for (size_t i = 0; i < m_entries.size(); ++i)
+            {
+                if (m_entries[i].cell == NO_CELL)
+                    continue;
+
+                const vec3& p = m_entries[i].position;
+                if ((p.x >= min.x) && (p.y >= min.y) && (p.z >= min.z) &&
+                    (p.x <= max.x) && (p.y <= max.y) && (p.z <= max.z))
+                {
+                    indices.push_back(i);
+                }
+            }
+
+            return;
+        }
+
+        int32_t coords[3];
+        for (coords[2] = minCoords[2]; coords[2] <= maxCoords[2]; ++coords[2])
+        {
+            for (coords[1] = minCoords[1]; coords[1] <= maxCoords[1]; ++coords[1])
+            {
+                for (coords[0] = minCoords[0]; coords[0] <= maxCoords[0]; ++coords[0])
+                {
+                    auto iter = m_cells.find(getCellKey(coords));
+                    if (iter == m_cells.end())
+                        continue;
+
+                    for (size_t index : iter->second)
+                    {
+                        const vec3& p = m_entries[index].position;
+                        if ((p.x >= min.x) && (p.y >= min.y) && (p.z >= min.z) &&
+                            (p.x <= max.x) && (p.y <= max.y) && (p.z <= max.z))
+                        {
+                            indices.push_back(index);
+                        }
+                    }
+                }
+            }
+        }
+    }
+
+    //-----------------------------------------------------------------------
+
+    void SpatialIndex::getCellCoords(const vec3& position, int32_t* coords) const
+    {
+        // Clamped so the conversion is defined for huge or non-finite values
+        const real LIMIT = 1073741824.0f;
+
+        for (int i = 0; i < 3; ++i)
+        {
+            real value = std::floor(position[i] * m_invCellSize);
+
+            if (!(value >= -LIMIT))
+                value = -LIMIT;
+            else if (value > LIMIT)
+                value = LIMIT;
+
+            coords[i] = int32_t(value);
+        }
+    }
+
+    //-----------------------------------------------------------------------
+
+    SpatialIndex::cell_key_t SpatialIndex::getCellKey(const int32_t* coords) const
+    {
+        // 21 bits per coordinate: collisions between far away cells are possible,
+        // but harmless since the positions are always tested
+        const cell_key_t mask = (cell_key_t(1) << 21) - 1;
+
+        return (cell_key_t(uint32_t(coords[0])) & mask) |
+               ((cell_key_t(uint32_t(coords[1])) & mask) << 21) |
+               ((cell_key_t(uint32_t(coords[2])) & mask) << 42);
+    }
+
+    //-----------------------------------------------------------------------
+
+    void SpatialIndex::insertInCell(size_t index)
+    {
+        if (m_entries[index].cell != NO_CELL)
+            m_cells[m_entries[index].cell].push_back(index);
+    }
+
+    //-----------------------------------------------------------------------
+
+    void SpatialIndex::removeFromCell(size_t index)
+    {
+        if (m_entries[index].cell == NO_CELL)
+            return;
+
+        auto iter = m_cells.find(m_entries[index].cell);
+        assert(iter != m_cells.end());
+
+        std::vector<size_t>& cell = iter->second;
+
+        auto iter2 = std::find(cell.begin(), cell.end(), index);
+        assert(iter2 != cell.end());
+
+        *iter2 = cell.back();
+        cell.pop_back();
+
+        if (cell.empty())
+            m_cells.erase(iter);
+    }
+
+    //-----------------------------------------------------------------------
+
+    void SpatialIndex::updateEntry(size_t index)
+    {
+        entry_t& entry = m_entries[index];
+
+        entry.revision = entry.transforms->getRevision();
+        entry.position = entry.transforms->getWorldPosition();
+
+        cell_key_t previous = entry.cell;
+        placeEntry(entry);
+
+        if (entry.cell != previous)
+        {
+            cell_key_t cell = entry.cell;
+
+            entry.cell = previous;
+            removeFromCell(index);
+
+            entry.cell = cell;
+            insertInCell(index);
+        }
+    }
+
+    //-----------------------------------------------------------------------
+
+    void SpatialIndex::placeEntry(entry_t& entry) const
+    {
+        const vec3& p = entry.position;
+
+        if (!std::isfinite(p.x) || !std::isfinite(p.y) || !std::isfinite(p.z))
+        {
+            entry.cell = NO_CELL;
+            return;
+        }
+
+        int32_t coords[3];
+        getCellCoords(p, coords);
+        entry.cell = getCellKey(coords);
+    }
+
+
+
+    /******************************** INTEREST MANAGER **********************************/
+
+    InterestManager::InterestManager(const SpatialIndex* index)
+    : m_index(index)
+    {
+        assert(index);
+    }
+
+    //-----------------------------------------------------------------------
+
+    void InterestManager::addObserver(Transforms* observer, real radius)
+    {
+        assert(observer);
+
+        if (m_indices.find(observer) != m_indices.end())
+        {
+            setRadius(observer, radius);
+            return;
+        }
+
+        observer_t entry;
+        entry.transforms = observer;
+        entry.radius = radius;
+
+        m_indices[observer] = m_observers.size();
+        m_observers.push_back(entry);
+    }
+
+    //-----------------------------------------------------------------------
+
+    void InterestManager::removeObserver(Transforms* observer)
+    {
+        auto iter = m_indices.find(observer);
+        if (iter == m_indices.end())
+            return;
+
+        size_t index = iter->second;
+        m_indices.erase(iter);
+
+        if (index != m_observers.size() - 1)
+        {
+            std::swap(m_observers[index], m_observers.back());
+            m_indices[m_observers[index].transforms] = index;
+        }
+
+        m_observers.pop_back();
+    }
+
+    //-----------------------------------------------------------------------
+
+    void InterestManager::setRadius(Transforms* observer, real radius)
+    {
+        auto iter = m_indices.find(observer);
+        assert(iter != m_indices.end());
+
+        m_observers[iter->second].radius = radius;
+    }
+
+    //-----------------------------------------------------------------------
+
+    void InterestManager::update()
+    {
+        // Buffers shared by all the observers, to limit the allocations
+        std::vector<Transforms*> found;
+        std::vector<interest_t> interests;
+
+        for (observer_t& observer : m_observers)
+            update(observer, found, interests);
+    }
+
+    //-----------------------------------------------------------------------
+
+    const InterestManager::changes_t& InterestManager::getChanges(Transforms* observer) const
+    {
+        auto iter = m_indices.find(observer);
+        assert(iter != m_indices.end());
+
+        return m_observers[iter->second].changes;
+    }
+
+    //-----------------------------------------------------------------------
+
+    std::vector<Transforms*> InterestManager::getInterest(Transforms* observer) const
+    {
+        auto iter = m_indices.find(observer);
+        assert(iter != m_indices.end());
+
+        std::vector<Transforms*> result;
+
+        for (const interest_t& interest : m_observers[iter->second].interests)
+            result.push_back(interest.first);
+
+        return result;
+    }
+
+    //-----------------------------------------------------------------------
+
+    void InterestManager::update(observer_t& observer, std::vector<Transforms*>& found,
+                                 std::vector<interest_t>& interests)
+    {
+        changes_t& changes = observer.changes;
+        changes.entering.clear();
+        changes.leaving.clear();
+        changes.changed.clear();
+
+        vec3 center = (m_index->contains(observer.transforms) ?
+                            m_index->getPosition(observer.transforms) :
+                            observer.transforms->getWorldPosition());
+
+        m_index->queryRadius(center, observer.radius, found);
+
+        std::sort(found.begin(), found.end());
+
+        interests.clear();
+        interests.reserve(found.size());
+
+        // Merge the sorted lists of previous and current Transforms of interest
+        auto previous = observer.interests.begin();
+        auto current = found.begin();
+
+        while ((previous != observer.interests.end()) || (current != found.end()))
+        {
+            if ((current != found.end()) && (*current == observer.transforms))
+            {
+                ++current;
+                continue;
+            }
+
+            if ((current == found.end()) ||
+                ((previous != observer.interests.end()) && (previous->first < *current)))
+            {
+                changes.leaving.push_back(previous->first);
+                ++previous;
+            }
+            else if ((previous == observer.interests.end()) || (*current < previous->first))
+            {
+                changes.entering.push_back(*current);
+                interests.push_back(interest_t(*current, (*current)->getRevision()));
+                ++current;
+            }
+            else
+            {
+                uint32_t revision = (*current)->getRevision();
+                if (revision != previous->second)
+                    changes.changed.push_back(*current);
+
+                interests.push_back(interest_t(*current, revision));
+                ++previous;
+                ++current;
+            }
+        }
+
+        observer.interests.swap(interests);
+    }
+
+
+    /************************************* FRUSTUM **************************************/
+
+    Frustum::Frustum(const vec4* planes)
+    {
+        for (size_t i = 0; i < 6; ++i)
+            m_planes[i] = planes[i] / glm::length(vec3(planes[i]));
+    }
+
+    //-----------------------------------------------------------------------
+
+    Frustum::Frustum(const mat4& viewProjection)
+    {
+        // Gribb & Hartmann method
+        vec4 row0(viewProjection[0][0], viewProjection[1][0], viewProjection[2][0], viewProjection[3][0]);
+        vec4 row1(viewProjection[0][1], viewProjection[1][1], viewProjection[2][1], viewProjection[3][1]);
+        vec4 row2(viewProjection[0][2], viewProjection[1][2], viewProjection[2][2], viewProjection[3][2]);
+        vec4 row3(viewProjection[0][3], viewProjection[1][3], viewProjection[2][3], viewProjection[3][3]);
+
+        m_planes[0] = row3 + row0;      // Left
+        m_planes[1] = row3 - row0;      // Right
+        m_planes[2] = row3 + row1;      // Bottom
+        m_planes[3] = row3 - row1;      // Top
+        m_planes[4] = row3 + row2;      // Near
+        m_planes[5] = row3 - row2;      // Far
+
+        for (size_t i = 0; i < 6; ++i)
+            m_planes[i] /= glm::length(vec3(m_planes[i]));
+    }
+
+    //-----------------------------------------------------------------------
+
+    frustum_test_t Frustum::test(const aabb_t& box) const
+    {
+        if (box.isEmpty())
+            return FT_OUTSIDE;
+
+        const vec3 center = box.getCenter();
+        const vec3 extents = box.getExtents();
+
+        frustum_test_t result = FT_INSIDE;
+
+        for (size_t i = 0; i < 6; ++i)
+        {
+            const vec4& plane = m_planes[i];
+
+            real d = plane.x * center.x + plane.y * center.y + plane.z * center.z + plane.w;
+            real r = std::abs(plane.x) * extents.x + std::abs(plane.y) * extents.y +
+                     std::abs(plane.z) * extents.z;
+
+            if (d < -r)
+                return FT_OUTSIDE;
+
+            if (d < r)
+                result = FT_INTERSECTS;
+        }
+
+        return result;
+    }
+
+    //-----------------------------------------------------------------------
+
+    void Frustum::testSpheres(const real* x, const real* y, const real* z,
+                              const real* radius, size_t count,
+                              frustum_test_t* results) const
+    {
+        const size_t BATCH_SIZE = 8;
+
+        for (size_t offset = 0; offset < count; offset += BATCH_SIZE)
+        {
+            const size_t n = std::min(BATCH_SIZE, count - offset);
+
+            // Copy the spheres in fixed-size arrays, so the loops below have a
+            // constant number of iterations
+            real bx[BATCH_SIZE] = { 0.0f };
+            real by[BATCH_SIZE] = { 0.0f };
+            real bz[BATCH_SIZE] = { 0.0f };
+            real br[BATCH_SIZE] = { 0.0f };
+
+            for (size_t j = 0; j < n; ++j)
+            {
+                bx[j] = x[offset + j];
+                by[j] = y[offset + j];
+                bz[j] = z[offset + j];
+                br[j] = radius[offset + j];
+            }
+
+            int outside[BATCH_SIZE] = { 0 };
+            int intersects[BATCH_SIZE] = { 0 };
+
+            for (size_t i = 0; i < 6; ++i)
+            {
+                const real a = m_planes[i].x;
+                const real b = m_planes[i].y;
+                const real c = m_planes[i].z;
+                const real d = m_planes[i].w;
+
+                for (size_t j = 0; j < BATCH_SIZE; ++j)
+                {
+                    const real distance = a * bx[j] + b * by[j] + c * bz[j] + d;
+                    outside[j] |= (distance < -br[j]);
+                    intersects[j] |= (distance < br[j]);
+                }
+            }
+
+            for (size_t j = 0; j < n; ++j)
+            {
+                results[offset + j] = (outside[j] ? FT_OUTSIDE :
+                                            (intersects[j] ? FT_INTERSECTS : FT_INSIDE));
+            }
+        }
+    }
+
+    //-----------------------------------------------------------------------
+
+    size_t Frustum::cull(Transforms* root, std::vector<Transforms*>& visible) const
+    {
+        assert(root);
+
+        visible.clear();
+
+        // Refit the bounds of the modified branches of the hierarchy
+        aabb_t bounds = root->getSubtreeBounds();
+        if (bounds.isEmpty())
+            return 0;
+
+        vec3 center = bounds.getCenter();
+        real radius = glm::length(bounds.getExtents());
+
+        frustum_test_t result;
+        testSpheres(&center.x, &center.y, &center.z, &radius, 1, &result);
+
+        std::vector<scratch_t> scratch;
+        cull(root, result, 0, scratch, visible);
+
+        return visible.size();
+    }
+
+    //-----------------------------------------------------------------------
+
+    void Frustum::cull(Transforms* transforms, frustum_test_t test, size_t depth,
+                       std::vector<scratch_t>& scratch,
+                       std::vector<Transforms*>& visible) const
+    {
+        if (test == FT_OUTSIDE)
+            return;
+
+        if (test == FT_INSIDE)
+        {
+            addAll(transforms, visible);
+            return;
+        }
+
+        if (transforms->hasBounds() && (this->test(transforms->getWorldBounds()) != FT_OUTSIDE))
+            visible.push_back(transforms);
+
+        const std::vector<Transforms*>& children = transforms->m_children;
+        const size_t count = children.size();
+
+        if (count == 0)
+            return;
+
+        // Test the bounding spheres of all the children at once (the buffers of this
+        // depth are only reused once all the children were processed)
+        if (scratch.size() <= depth)
+            scratch.resize(depth + 1);
+
+        if (scratch[depth].results.size() < count)
+        {
+            scratch[depth].spheres.resize(count * 4);
+            scratch[depth].results.resize(count);
+        }
+
+        // Only the pointers are used from here: the recursion can grow 'scratch',
+        // which moves the vectors but not their content
+        frustum_test_t* results = scratch[depth].results.data();
+        real* x = scratch[depth].spheres.data();
+        real* y = x + count;
+        real* z = y + count;
+        real* radius = z + count;
+
+        for (size_t i = 0; i < count; ++i)
+        {
+            aabb_t bounds = children[i]->getSubtreeBounds();
+
+            if (bounds.isEmpty())
+            {
+                // Can never be visible
+                x[i] = 0.0f;
+                y[i] = 0.0f;
+                z[i] = 0.0f;
+                radius[i] = -1.0f;
+                continue;
+            }
+
+            vec3 center = bounds.getCenter();
+            x[i] = center.x;
+            y[i] = center.y;
+            z[i] = center.z;
+            radius[i] = glm::length(bounds.getExtents());
+        }
+
+        testSpheres(x, y, z, radius, count, results);
+
+        for (size_t i = 0; i < count; ++i)
+        {
+            if (radius[i] >= 0.0f)
+                cull(children[i], results[i], depth + 1, scratch, visible);
+        }
+    }
+
+    //-----------------------------------------------------------------------
+
+    void Frustum::addAll(Transforms* transforms, std::vector<Transforms*>& visible) const
+    {
+        if (transforms->hasBounds())
+            visible.push_back(transforms);
+
+        for (Transforms* child : transforms->m_children)
+            addAll(child, visible);
+    }
+
+
+    /*********************************** CHANGE LOG *************************************/
+
+    ChangeLog::ChangeLog(size_t historySize)
+    : m_frames(std::max(historySize, size_t(1))), m_frame(0), m_constraints(nullptr)
+    {
+    }
+
+    //-----------------------------------------------------------------------
+
+    void ChangeLog::track(Transforms* root)
+    {
+        assert(root);
+
+        if (std::find(m_roots.begin(), m_roots.end(), root) == m_roots.end())
+            m_roots.push_back(root);
+    }
+
+    //-----------------------------------------------------------------------
+
+    void ChangeLog::untrack(Transforms* root)
+    {
+        auto iter = std::find(m_roots.begin(), m_roots.end(), root);
+        if (iter != m_roots.end())
+            m_roots.erase(iter);
+    }
+
+    //-----------------------------------------------------------------------
+
+    uint32_t ChangeLog::update()
+    {
+        ++m_frame;
+
+        std::vector<Transforms*>& changes = m_frames[m_frame % m_frames.size()];
+        changes.clear();
+
+        if (m_constraints)
+            m_constraints->evaluate();
+
+        for (Transforms* root : m_roots)
+            root->updateHierarchy(changes);
+
+        if (!m_subscriptions.empty())
+            notifyListeners();
+
+        return m_frame;
+    }
+
+    //-----------------------------------------------------------------------
+
+    size_t ChangeLog::addConsumer()
+    {
+        consumer_t consumer;
+        consumer.cursor = m_frame;
+        consumer.used = true;
+
+        for (size_t i = 0; i < m_consumers.size(); ++i)
+        {
+            if (!m_consumers[i].used)
+            {
+                m_consumers[i] = consumer;
+                return i;
+            }
+        }
+
+        m_consumers.push_back(consumer);
+        return m_consumers.size() - 1;
+    }
+
+    //-----------------------------------------------------------------------
+
+    void ChangeLog::removeConsumer(size_t consumer)
+    {
+        assert(consumer < m_consumers.size());
+        m_consumers[consumer].used = false;
+    }
+
+    //-----------------------------------------------------------------------
+
+    uint32_t ChangeLog::getCursor(size_t consumer) const
+    {
+        assert((consumer < m_consumers.size()) && m_consumers[consumer].used);
+        return m_consumers[consumer].cursor;
+    }
+
+    //-----------------------------------------------------------------------
+
+    size_t ChangeLog::read(size_t consumer, std::vector<Transforms*>& changed)
+    {
+        assert((consumer < m_consumers.size()) && m_consumers[consumer].used);
+
+        changed.clear();
+
+        uint32_t& cursor = m_consumers[consumer].cursor;
+        uint32_t nbFrames = m_frame - cursor;
+        cursor = m_frame;
+
+        if (nbFrames == 0)
+            return 0;
+
+        if (nbFrames > m_frames.size())
+        {
+            for (Transforms* root : m_roots)
+                addAll(root, changed);
+
+            return changed.size();
+        }
+
+        if (nbFrames == 1)
+        {
+            changed = getChanges();
+            return changed.size();
+        }
+
+        for (uint32_t frame = m_frame - nbFrames + 1; frame != m_frame + 1; ++frame)
+        {
+            const std::vector<Transforms*>& changes = m_frames[frame % m_frames.size()];
+            changed.insert(changed.end(), changes.begin(), changes.end());
+        }
+
+        // Report each Transforms only once
+        std::sort(changed.begin(), changed.end());
+        changed.erase(std::unique(changed.begin(), changed.end()), changed.end());
+
+        return changed.size();
+    }
+
+    //-----------------------------------------------------------------------
+
+    void ChangeLog::addAll(Transforms* transforms, std::vector<Transforms*>& result) const
+    {
+        result.push_back(transforms);
+
+        for (Transforms* child : transforms->m_children)
+            addAll(child, result);
+    }
+
+    //-----------------------------------------------------------------------
+
+    void ChangeLog::addListener(ChangeListener* listener, Transforms* transforms,
+                                bool subtree)
+    {
+        assert(listener);
+        assert(transforms);
+
+        // Retrieve the slot of the listener, or allocate one
+        size_t slot;
+
+        auto iter = m_listenerSlots.find(listener);
+        if (iter != m_listenerSlots.end())
+        {
+            slot = iter->second;
+        }
+        else
+        {
+            slot = 0;
+            while ((slot < m_listeners.size()) && m_listeners[slot].listener)
+                ++slot;
+
+            if (slot == m_listeners.size())
+                m_listeners.push_back(listener_t());
+
+            m_listeners[slot].listener = listener;
+            m_listeners[slot].nbSubscriptions = 0;
+            m_listenerSlots[listener] = slot;
+        }
+
+        std::vector<subscription_t>& subscriptions = m_subscriptions[transforms];
+
+        for (subscription_t& subscription : subscriptions)
+        {
+            if (subscription.listener == slot)
+            {
+                if (subscription.subtree != subtree)
+                    transforms->addSubtreeSubscriptions(subtree ? 1 : -1);
+
+                subscription.subtree = subtree;
+                return;
+            }
+        }
+
+        subscription_t subscription;
+        subscription.listener = slot;
+        subscription.subtree = subtree;
+        subscriptions.push_back(subscription);
+
+        ++transforms->m_nbSubscriptions;
+        if (subtree)
+            transforms->addSubtreeSubscriptions(1);
+
+        ++m_listeners[slot].nbSubscriptions;
+    }
+
+    //-----------------------------------------------------------------------
+
+    void ChangeLog::removeListener(ChangeListener* listener, Transforms* transforms)
+    {
+        auto slot = m_listenerSlots.find(listener);
+        if (slot == m_listenerSlots.end())
+            return;
+
+        auto iter = m_subscriptions.find(transforms);
+        if (iter == m_subscriptions.end())
+            return;
+
+        std::vector<subscription_t>& subscriptions = iter->second;
+
+        for (size_t i = 0; i < subscriptions.size(); ++i)
+        {
+            if (subscriptions[i].listener != slot->second)
+                continue;
+
+            removeSubscription(transforms, subscriptions[i]);
+
+            subscriptions[i] = subscriptions.back();
+            subscriptions.pop_back();
+
+            if (subscriptions.empty())
+                m_subscriptions.erase(iter);
+
+            return;
+        }
+    }
+
+    //-----------------------------------------------------------------------
+
+    void ChangeLog::removeListener(ChangeListener* listener)
+    {
+        auto slot = m_listenerSlots.find(listener);
+        if (slot == m_listenerSlots.end())
+            return;
+
+        const size_t index = slot->second;
+
+        for (auto iter = m_subscriptions.begin(); iter != m_subscriptions.end(); )
+        {
+            std::vector<subscription_t>& subscriptions = iter->second;
+
+            for (size_t i = 0; i < subscriptions.size(); ++i)
+            {
+                if (subscriptions[i].listener == index)
+                {
+                    removeSubscription(iter->first, subscriptions[i]);
+
+                    subscriptions[i] = subscriptions.back();
+                    subscriptions.pop_back();
+                    break;
+                }
+            }
+
+            if (subscriptions.empty())
+                iter = m_subscriptions.erase(iter);
+            else
+                ++iter;
+        }
+    }
+
+    //-----------------------------------------------------------------------
+
+    void ChangeLog::removeSubscription(Transforms* transforms,
+                                       const subscription_t& subscription)
+    {
+        --transforms->m_nbSubscriptions;
+        if (subscription.subtree)
+            transforms->addSubtreeSubscriptions(-1);
+
+        listener_t& entry = m_listeners[subscription.listener];
+        if (--entry.nbSubscriptions == 0)
+        {
+            // Free the slot
+            m_listenerSlots.erase(entry.listener);
+            entry.listener = nullptr;
+            entry.changed.clear();
+        }
+    }
+
+    //-----------------------------------------------------------------------
+
+    void ChangeLog::notifyListeners()
+    {
+        for (Transforms* transforms : getChanges())
+        {
+            // Look for subscriptions to the Transforms, and to the ones above it only if
+            // one of them has a subtree subscription
+            for (Transforms* current = transforms; current;
+                 current = current->m_parent)
+            {
+                if (current->m_nbSubscriptions > 0)
+                {
+                    auto iter = m_subscriptions.find(current);
+                    if (iter != m_subscriptions.end())
+                    {
+                        for (const subscription_t& subscription : iter->second)
+                        {
+                            if ((current == transforms) || subscription.subtree)
+                                notify(subscription.listener, transforms);
+                        }
+                    }
+                }
+
+                if (current->m_nbSubtreeSubscriptions == 0)
+                    break;
+            }
+        }
+
+        // The listeners are only called once all the changes are known, so they can
+        // safely modify the Transforms
+        for (listener_t& entry : m_listeners)
+        {
+            if (entry.changed.empty())
+                continue;
+
+            entry.listener->onWorldTransformsChanged(entry.changed);
+            entry.changed.clear();
+        }
+    }
+
+    //-----------------------------------------------------------------------
+
+    void ChangeLog::notify(size_t listener, Transforms* transforms)
+    {
+        listener_t& entry = m_listeners[listener];
+
+        // Several subscriptions of the listener might match the same Transforms
+        if (entry.changed.empty() || (entry.changed.back() != transforms))
+            entry.changed.push_back(transforms);
+    }
+
+
+    /******************************** STRUCTURE JOURNAL *********************************/
+
+    StructureJournal::StructureJournal(size_t capacity)
+    : m_events(std::max(capacity, size_t(1))), m_sequence(0)
+    {
+    }
+
+    //-----------------------------------------------------------------------
+
+    void StructureJournal::record(structure_event_type_t type, Transforms* transforms,
+                                  Transforms* parent, Transforms* previousParent,
+                                  const std::string& tag)
+    {
+        ++m_sequence;
+
+        structure_event_t& event = m_events[(m_sequence - 1) % m_events.size()];
+        event.sequence = m_sequence;
+        event.type = type;
+        event.transforms = transforms;
+        event.parent = parent;
+        event.previousParent = previousParent;
+        event.tag = tag;
+    }
+
+    //-----------------------------------------------------------------------
+
+    bool StructureJournal::hasOverflowed(uint64_t sequence) const
+    {
+        return (m_sequence - std::min(sequence, m_sequence) > m_events.size());
+    }
+
+    //-----------------------------------------------------------------------
+
+    size_t StructureJournal::read(uint64_t sequence,
+                                  std::vector<structure_event_t>& events) const
+    {
+        events.clear();
+
+        uint64_t first = sequence + 1;
+        if (m_sequence > m_events.size())
+            first = std::max(first, m_sequence - m_events.size() + 1);
+
+        for (uint64_t i = first; i <= m_sequence; ++i)
+            events.push_back(m_events[(i - 1) % m_events.size()]);
+
+        return events.size();
+    }
+
+
+
+    /********************************* SNAPSHOT WRITER **********************************/
+
+    const uint32_t SnapshotWriter::MAGIC = 0x5352544B;     // "KTRS"
+    const uint32_t SnapshotWriter::VERSION = 2;
+    const uint32_t SnapshotWriter::ENDIANNESS = 0x01020304;
+
+    //-----------------------------------------------------------------------
+
+    bool SnapshotWriter::write(Transforms* const* roots, size_t nbRoots,
+                               std::ostream& stream, bool worldTransforms)
+    {
+        write(roots, nbRoots, worldTransforms, [&stream](const void* data, size_t size) {
+            stream.write(static_cast<const char*>(data), std::streamsize(size));
+        });
+
+        return !stream.fail();
+    }
+
+    //-----------------------------------------------------------------------
+
+    void SnapshotWriter::write(Transforms* const* roots, size_t nbRoots,
+                               std::vector<uint8_t>& buffer, bool worldTransforms)
+    {
+        buffer.clear();
+
+        write(roots, nbRoots, worldTransforms, [&buffer](const void* data, size_t size) {
+            const uint8_t* bytes = static_cast<const uint8_t*>(data);
+            buffer.insert(buffer.end(), bytes, bytes + size);
+        });
+    }
+
+    //-----------------------------------------------------------------------
+
+    void SnapshotWriter::write(Transforms* const* roots, size_t nbRoots,
+                               bool worldTransforms,
+                               const std::function<void(const void*, size_t)>& output)
+    {
+        // Flatten the hierarchies, parents first
+        std::vector<Transforms*> nodes(roots, roots + nbRoots);
+        std::vector<int32_t> parents(nbRoots, -1);
+
+        for (size_t i = 0; i < nodes.size(); ++i)
+        {
+            for (Transforms* child : nodes[i]->m_children)
+            {
+                nodes.push_back(child);
+                parents.push_back(int32_t(i));
+            }
+        }
+
+        const size_t count = nodes.size();
+
+        // Intern the tags
+        std::unordered_map<std::string, uint32_t> tagIndices;
+        std::vector<uint32_t> tagStarts(count + 1);
+        std::vector<uint32_t> tagRefs;
+        std::vector<uint32_t> stringOffsets(1, 0);
+        std::string strings;
+
+        for (size_t i = 0; i < count; ++i)
+        {
+            tagStarts[i] = uint32_t(tagRefs.size());
+
+            for (const std::string& tag : nodes[i]->getTags())
+            {
+                auto iter = tagIndices.find(tag);
+                if (iter == tagIndices.end())
+                {
+                    iter = tagIndices.emplace(tag, uint32_t(tagIndices.size())).first;
+                    strings += tag;
+                    stringOffsets.push_back(uint32_t(strings.size()));
+                }
+
+                tagRefs.push_back(iter->second);
+            }
+        }
+
+        tagStarts[count] = uint32_t(tagRefs.size());
+
+        size_t stringsSize = (strings.size() + 3) & ~size_t(3);
+        strings.resize(stringsSize, '\0');
+
+        // Header
+        uint32_t header[8] = {
+            MAGIC, VERSION, uint32_t(count),
+            (worldTransforms ? uint32_t(SF_WORLD_TRANSFORMS) : 0u),
+            uint32_t(tagIndices.size()), uint32_t(tagRefs.size()), uint32_t(stringsSize),
+            ENDIANNESS
+        };
+
+        output(header, sizeof(header));
+
+        // Hierarchy and tags
+        output(parents.data(), count * sizeof(int32_t));
+
+        std::vector<uint32_t> flags(count);
+        for (size_t i = 0; i < count; ++i)
+        {
+            flags[i] = (nodes[i]->inheritOrientation() ? 1u : 0u) |
+                       (nodes[i]->inheritScale() ? 2u : 0u);
+        }
+
+        output(flags.data(), count * sizeof(uint32_t));
+        output(tagStarts.data(), tagStarts.size() * sizeof(uint32_t));
+        output(tagRefs.data(), tagRefs.size() * sizeof(uint32_t));
+        output(stringOffsets.data(), stringOffsets.size() * sizeof(uint32_t));
+        output(strings.data(), stringsSize);
+
+        // Transforms, one array at a time
+        std::vector<float> values(count * 4);
+
+        for (int world = 0; world < (worldTransforms ? 2 : 1); ++world)
+        {
+            for (size_t i = 0; i < count; ++i)
+            {
+                vec3 p = (world ? nodes[i]->getWorldPosition() : nodes[i]->getPosition());
+                values[i * 3] = p.x;
+                values[i * 3 + 1] = p.y;
+                values[i * 3 + 2] = p.z;
+            }
+
+            output(values.data(), count * 3 * sizeof(float));
+
+            for (size_t i = 0; i < count; ++i)
+            {
+                quat q = (world ? nodes[i]->getWorldOrientation() :
+                                  nodes[i]->getOrientation());
+                values[i * 4] = q.x;
+                values[i * 4 + 1] = q.y;
+                values[i * 4 + 2] = q.z;
+                values[i * 4 + 3] = q.w;
+            }
+
+            output(values.data(), count * 4 * sizeof(float));
+
+            for (size_t i = 0; i < count; ++i)
+            {
+                vec3 s = (world ? nodes[i]->getWorldScale() : nodes[i]->getScale());
+                values[i * 3] = s.x;
+                values[i * 3 + 1] = s.y;
+                values[i * 3 + 2] = s.z;
+            }
+
+            output(values.data(), count * 3 * sizeof(float));
+        }
+    }
+
+
+    /********************************* SNAPSHOT READER **********************************/
+
+    SnapshotReader::SnapshotReader()
+    : m_header(nullptr), m_parents(nullptr), m_flags(nullptr), m_tagStarts(nullptr),
+      m_tagRefs(nullptr), m_stringOffsets(nullptr), m_strings(nullptr),
+      m_positions(nullptr), m_orientations(nullptr), m_scales(nullptr),
+      m_worldPositions(nullptr), m_worldOrientations(nullptr), m_worldScales(nullptr)
+    {
+    }
+
+    //-----------------------------------------------------------------------
+
+    bool SnapshotReader::open(const void* data, size_t size)
+    {
+        m_buffer.clear();
+
+        if ((reinterpret_cast<uintptr_t>(data) % sizeof(uint32_t)) != 0)
+        {
+            m_header = nullptr;
+            return false;
+        }
+
+        return parse(static_cast<const uint32_t*>(data), size);
+    }
+
+    //-----------------------------------------------------------------------
+
+    bool SnapshotReader::read(std::istream& stream)
+    {
+        m_header = nullptr;
+
+        uint32_t header[8];
+        if (!stream.read(reinterpret_cast<char*>(header), sizeof(header)))
+            return false;
+
+        if ((header[0] != SnapshotWriter::MAGIC) || (header[1] != SnapshotWriter::VERSION) ||
+            (header[7] != SnapshotWriter::ENDIANNESS))
+        {
+            return false;
+        }
+
+        // Compute the size of the snapshot from the header
+        uint64_t count = header[2];
+        uint64_t size = 8 + count * 2 + (count + 1) + header[5] + (uint64_t(header[4]) + 1) +
+                        header[6] / 4 + count * 10;
+
+        if (header[3] & SnapshotWriter::SF_WORLD_TRANSFORMS)
+            size += count * 10;
+
+        // The header isn't trusted: the buffer only grows as the data is actually read,
+        // so a corrupted one can't trigger a huge allocation
+        const uint64_t CHUNK_SIZE = 1 << 18;
+
+        m_buffer.assign(header, header + 8);
+
+        for (uint64_t remaining = size - 8; remaining > 0; )
+        {
+            const size_t chunk = size_t(std::min(remaining, CHUNK_SIZE));
+            const size_t offset = m_buffer.size();
+
+            m_buffer.resize(offset + chunk);
+
+            if (!stream.read(reinterpret_cast<char*>(m_buffer.data() + offset),
+                             std::streamsize(chunk * sizeof(uint32_t))))
+            {
+                m_buffer.clear();
+                return false;
+            }
+
+            remaining -= chunk;
+        }
+
+        return parse(m_buffer.data(), m_buffer.size() * sizeof(uint32_t));
+    }
+
+    //-----------------------------------------------------------------------
+
+    size_t SnapshotReader::getNbNodes() const
+    {
+        return (m_header ? m_header[2] : 0);
+    }
+
+    //-----------------------------------------------------------------------
+
+    pose_t SnapshotReader::getPose(size_t index) const
+    {
+        assert(index < getNbNodes());
+        return getPose(m_positions, m_orientations, m_scales, index);
+    }
+
+    //-----------------------------------------------------------------------
+
+    pose_t SnapshotReader::getWorldPose(size_t index) const
+    {
+        assert(index < getNbNodes());
+        assert(hasWorldTransforms());
+        return getPose(m_worldPositions, m_worldOrientations, m_worldScales, index);
+    }
+
+    //-----------------------------------------------------------------------
+
+    bool SnapshotReader::inheritOrientation(size_t index) const
+    {
+        assert(index < getNbNodes());
+        return (m_flags[index] & 1u) != 0;
+    }
+
+    //-----------------------------------------------------------------------
+
+    bool SnapshotReader::inheritScale(size_t index) const
+    {
+        assert(index < getNbNodes());
+        return (m_flags[index] & 2u) != 0;
+    }
+
+    //-----------------------------------------------------------------------
+
+    std::vector<std::string> SnapshotReader::getTags(size_t index) const
+    {
+        assert(index < getNbNodes());
+
+        std::vector<std::string> tags;
+
+        for (uint32_t i = m_tagStarts[index]; i < m_tagStarts[index + 1]; ++i)
+        {
+            uint32_t tag = m_tagRefs[i];
+            tags.push_back(std::string(m_strings + m_stringOffsets[tag],
+                                       m_stringOffsets[tag + 1] - m_stringOffsets[tag]));
+        }
+
+        return tags;
+    }
+
+    //-----------------------------------------------------------------------
+
+    void SnapshotReader::restore(Transforms* const* nodes) const
+    {
+        assert(isValid());
+
+        const size_t count = getNbNodes();
+
+        // The Transforms are still dirty, so changing their options doesn't traverse
+        // anything
+        std::vector<pose_t> poses(count);
+        for (size_t i = 0; i < count; ++i)
+        {
+            nodes[i]->setInheritOrientation(inheritOrientation(i));
+            nodes[i]->setInheritScale(inheritScale(i));
+            poses[i] = getPose(i);
+        }
+
+        // The parents were validated by parse()
+        bool built = Transforms::buildHierarchy(nodes, m_parents, poses.data(), count);
+        assert(built);
+        (void) built;
+
+        for (size_t i = 0; i < count; ++i)
+        {
+            for (const std::string& tag : getTags(i))
+                nodes[i]->addTag(tag);
+        }
+    }
+
+    //-----------------------------------------------------------------------
+
+    bool SnapshotReader::parse(const uint32_t* data, size_t size)
+    {
+        m_header = nullptr;
+
+        const size_t available = size / sizeof(uint32_t);
+        if ((available < 8) || (data[0] != SnapshotWriter::MAGIC) ||
+            (data[1] != SnapshotWriter::VERSION) || (data[7] != SnapshotWriter::ENDIANNESS) ||
+            (data[6] % 4 != 0))
+        {
+            return false;
+        }
+
+        const size_t count = data[2];
+        const size_t nbTags = data[4];
+        const size_t nbTagRefs = data[5];
+        const size_t stringsSize = data[6];
+        const bool world = (data[3] & SnapshotWriter::SF_WORLD_TRANSFORMS) != 0;
+
+        size_t offset = 8;
+
+        // Returns the start of the next array, or nullptr if the data is too small
+        auto next = [&](size_t nbValues) -> const uint32_t* {
+            if (available - offset < nbValues)
+                return nullptr;
+
+            const uint32_t* start = data + offset;
+            offset += nbValues;
+            return start;
+        };
+
+        const int32_t* parents = reinterpret_cast<const int32_t*>(next(count));
+        const uint32_t* flags = next(count);
+        const uint32_t* tagStarts = next(count + 1);
+        const uint32_t* tagRefs = next(nbTagRefs);
+        const uint32_t* stringOffsets = next(nbTags + 1);
+        const char* strings = reinterpret_cast<const char*>(next(stringsSize / 4));
+        const float* positions = reinterpret_cast<const float*>(next(count * 3));
+        const float* orientations = reinterpret_cast<const float*>(next(count * 4));
+        const float* scales = reinterpret_cast<const float*>(next(count * 3));
+
+        if (!parents || !flags || !tagStarts || !tagRefs || !stringOffsets || !strings ||
+            !positions || !orientations || !scales)
+        {
+            return false;
+        }
+
+        const float* worldPositions = nullptr;
+        const float* worldOrientations = nullptr;
+        const float* worldScales = nullptr;
+
+        if (world)
+        {
+            worldPositions = reinterpret_cast<const float*>(next(count * 3));
+            worldOrientations = reinterpret_cast<const float*>(next(count * 4));
+            worldScales = reinterpret_cast<const float*>(next(count * 3));
+
+            if (!worldPositions || !worldOrientations || !worldScales)
+                return false;
+        }
+
+        // Validate the hierarchy (the parents must come before their children, so
+        // there can't be any cycle) and the tags
+        for (size_t i = 0; i < count; ++i)
+        {
+            if ((parents[i] < -1) || (parents[i] >= int32_t(i)))
+                return false;
+
+            if ((tagStarts[i] > tagStarts[i + 1]) || (tagStarts[i + 1] > nbTagRefs))
+                return false;
+        }
+
+        for (size_t i = 0; i < nbTagRefs; ++i)
+        {
+            if (tagRefs[i] >= nbTags)
+                return false;
+        }
+
+        for (size_t i = 0; i < nbTags; ++i)
+        {
+            if ((stringOffsets[i] > stringOffsets[i + 1]) ||
+                (stringOffsets[i + 1] > stringsSize))
+            {
+                return false;
+            }
+        }
+
+        m_header = data;
+        m_parents = parents;
+        m_flags = flags;
+        m_tagStarts = tagStarts;
+        m_tagRefs = tagRefs;
+        m_stringOffsets = stringOffsets;
+        m_strings = strings;
+        m_positions = positions;
+        m_orientations = orientations;
+        m_scales = scales;
+        m_worldPositions = worldPositions;
+        m_worldOrientations = worldOrientations;
+        m_worldScales = worldScales;
+
+        return true;
+    }
+
+    //-----------------------------------------------------------------------
+
+    pose_t SnapshotReader::getPose(const float* positions, const float* orientations,
+                                   const float* scales, size_t index)
+    {
+        pose_t pose;
+
+        pose.position = vec3(positions[index * 3], positions[index * 3 + 1],
+                             positions[index * 3 + 2]);
+
+        pose.orientation = quat(orientations[index * 4 + 3], orientations[index * 4],
+                                orientations[index * 4 + 1], orientations[index * 4 + 2]);
+
+        pose.scale = vec3(scales[index * 3], scales[index * 3 + 1], scales[index * 3 + 2]);
+
+        return pose;
+    }
+
+
+
+    /*********************************** BIT WRITER *************************************/
+
+    BitWriter::BitWriter(std::vector<uint8_t>& buffer)
+    : m_buffer(buffer), m_bits(0), m_nbBits(0)
+    {
+    }
+
+    //-----------------------------------------------------------------------
+
+    void BitWriter::write(uint32_t value, uint32_t nbBits)
+    {
+        assert(nbBits <= 32);
+
+        if (nbBits < 32)
+            value &= (1u << nbBits) - 1;
+
+        m_bits |= uint64_t(value) << m_nbBits;
+        m_nbBits += nbBits;
+
+        while (m_nbBits >= 8)
+        {
+            m_buffer.push_back(uint8_t(m_bits & 0xFF));
+            m_bits >>= 8;
+            m_nbBits -= 8;
+        }
+    }
+
+    //-----------------------------------------------------------------------
+
+    void BitWriter::flush()
+    {
+        if (m_nbBits > 0)
+            m_buffer.push_back(uint8_t(m_bits & 0xFF));
+
+        m_bits = 0;
+        m_nbBits = 0;
+    }
+
+
+    /*********************************** BIT READER *************************************/
+
+    BitReader::BitReader(const uint8_t* data, size_t size)
+    : m_data(data), m_size(size), m_offset(0), m_bits(0), m_nbBits(0)
+    {
+    }
+
+    //-----------------------------------------------------------------------
+
+    bool BitReader::read(uint32_t nbBits, uint32_t& value)
+    {
+        assert(nbBits <= 32);
+
+        while (m_nbBits < nbBits)
+        {
+            if (m_offset == m_size)
+                return false;
+
+            m_bits |= uint64_t(m_data[m_offset]) << m_nbBits;
+            ++m_offset;
+            m_nbBits += 8;
+        }
+
+        value = uint32_t(m_bits & ((uint64_t(1) << nbBits) - 1));
+        m_bits >>= nbBits;
+        m_nbBits -= nbBits;
+
+        return true;
+    }
+
+
+    /******************************* REPLICATION ENCODER ********************************/
+
+    // Range of the components of a quaternion, other than the largest one
+    static const real SMALLEST_THREE_RANGE = 0.70710678f;
+
+    //-----------------------------------------------------------------------
+
+    static uint32_t getIdentifierBits(size_t count)
+    {
+        uint32_t nbBits = 1;
+        while ((nbBits < 32) && ((uint64_t(1) << nbBits) < count))
+            ++nbBits;
+
+        return nbBits;
+    }
+
+    //-----------------------------------------------------------------------
+
+    ReplicationEncoder::ReplicationEncoder(Transforms* const* nodes, size_t count,
+                                           const replication_settings_t& settings)
+    : m_settings(settings), m_baselines(count), m_identifierBits(getIdentifierBits(count))
+    {
+        for (size_t i = 0; i < count; ++i)
+            m_identifiers[nodes[i]] = uint32_t(i);
+
+        reset();
+    }
+
+    //-----------------------------------------------------------------------
+
+    size_t ReplicationEncoder::encode(Transforms* const* changed, size_t count,
+                                      std::vector<uint8_t>& message)
+    {
+        message.clear();
+
+        // The number of Transforms is written last, once known
+        message.resize(sizeof(uint32_t));
+
+        BitWriter writer(message);
+        uint32_t nbEncoded = 0;
+
+        const aabb_t& bounds = m_settings.bounds;
+
+        for (size_t i = 0; i < count; ++i)
+        {
+            auto iter = m_identifiers.find(changed[i]);
+            assert(iter != m_identifiers.end());
+
+            baseline_t& baseline = m_baselines[iter->second];
+            pose_t pose = changed[i]->getTransforms();
+
+            // Quantize the position
+            uint32_t position[3];
+            for (int j = 0; j < 3; ++j)
+            {
+                position[j] = Math::quantize(pose.position[j], bounds.min[j], bounds.max[j],
+                                             m_settings.positionBits);
+            }
+
+            // Quantize the orientation, dropping its largest component (the sign of the
+            // quaternion is chosen so that it is positive)
+            real components[4] = { pose.orientation.x, pose.orientation.y,
+                                   pose.orientation.z, pose.orientation.w };
+
+            uint32_t largest = 0;
+            for (uint32_t j = 1; j < 4; ++j)
+            {
+                if (std::abs(components[j]) > std::abs(components[largest]))
+                    largest = j;
+            }
+
+            real sign = (components[largest] < 0.0f ? -1.0f : 1.0f);
+
+            uint32_t orientation[4] = { largest, 0, 0, 0 };
+            for (uint32_t j = 0, k = 1; j < 4; ++j)
+            {
+                if (j == largest)
+                    continue;
+
+                orientation[k++] = Math::quantize(sign * components[j],
+                                                  -SMALLEST_THREE_RANGE, SMALLEST_THREE_RANGE,
+                                                  m_settings.orientationBits);
+            }
+
+            // Only send the components that changed
+            uint32_t mask = 0;
+
+            if (!baseline.valid ||
+                !std::equal(position, position + 3, baseline.position))
+            {
+                mask |= 1;
+            }
+
+            if (!baseline.valid ||
+                !std::equal(orientation, orientation + 4, baseline.orientation))
+            {
+                mask |= 2;
+            }
+
+            if (!baseline.valid || (pose.scale.x != baseline.scale[0]) ||
+                (pose.scale.y != baseline.scale[1]) || (pose.scale.z != baseline.scale[2]))
+            {
+                mask |= 4;
+            }
+
+            if (mask == 0)
+                continue;
+
+            writer.write(iter->second, m_identifierBits);
+            writer.write(mask, 3);
+
+            if (mask & 1)
+            {
+                for (int j = 0; j < 3; ++j)
+                    writer.write(position[j], m_settings.positionBits);
+
+                std::copy(position, position + 3, baseline.position);
+            }
+
+            if (mask & 2)
+            {
+                writer.write(orientation[0], 2);
+                for (int j = 1; j < 4; ++j)
+                    writer.write(orientation[j], m_settings.orientationBits);
+
+                std::copy(orientation, orientation + 4, baseline.orientation);
+            }
+
+            if (mask & 4)
+            {
+                for (int j = 0; j < 3; ++j)
+                {
+                    uint32_t bits;
+                    std::memcpy(&bits, &pose.scale[j], sizeof(bits));
+                    writer.write(bits, 32);
+
+                    baseline.scale[j] = pose.scale[j];
+                }
+            }
+
+            baseline.valid = true;
+            ++nbEncoded;
+        }
+
+        writer.flush();
+
+        for (size_t i = 0; i < sizeof(uint32_t); ++i)
+            message[i] = uint8_t(nbEncoded >> (i * 8));
+
+        ++m_stats.nbMessages;
+        m_stats.nbNodes += nbEncoded;
+        m_stats.nbBytes += message.size();
+
+        return nbEncoded;
+    }
+
+    //-----------------------------------------------------------------------
+
+    void ReplicationEncoder::reset()
+    {
+        for (baseline_t& baseline : m_baselines)
+            baseline.valid = false;
+    }
+
+
+    /******************************* REPLICATION DECODER ********************************/
+
+    ReplicationDecoder::ReplicationDecoder(Transforms* const* nodes, size_t count,
+                                           const replication_settings_t& settings)
+    : m_settings(settings), m_nodes(nodes, nodes + count),
+      m_identifierBits(getIdentifierBits(count))
+    {
+    }
+
+    //-----------------------------------------------------------------------
+
+    bool ReplicationDecoder::decode(const uint8_t* message, size_t size)
+    {
+        if (size < sizeof(uint32_t))
+            return false;
+
+        uint32_t nbEncoded = 0;
+        for (size_t i = 0; i < sizeof(uint32_t); ++i)
+            nbEncoded |= uint32_t(message[i]) << (i * 8);
+
+        BitReader reader(message + sizeof(uint32_t), size - sizeof(uint32_t));
+
+        m_changed.clear();
+        m_poses.clear();
+
+        const aabb_t& bounds = m_settings.bounds;
+
+        for (uint32_t i = 0; i < nbEncoded; ++i)
+        {
+            uint32_t identifier;
+            uint32_t mask;
+
+            if (!reader.read(m_identifierBits, identifier) || !reader.read(3, mask) ||
+                (identifier >= m_nodes.size()))
+            {
+                return false;
+            }
+
+            Transforms* node = m_nodes[identifier];
+
+            // The components that weren't sent didn't change
+            pose_t pose = node->getTransforms();
+
+            if (mask & 1)
+            {
+                for (int j = 0; j < 3; ++j)
+                {
+                    uint32_t value;
+                    if (!reader.read(m_settings.positionBits, value))
+                        return false;
+
+                    pose.position[j] = Math::dequantize(value, bounds.min[j], bounds.max[j],
+                                                        m_settings.positionBits);
+                }
+            }
+
+            if (mask & 2)
+            {
+                uint32_t largest;
+                if (!reader.read(2, largest))
+                    return false;
+
+                real components[4];
+                real sum = 0.0f;
+
+                for (uint32_t j = 0; j < 4; ++j)
+                {
+                    if (j == largest)
+                        continue;
+
+                    uint32_t value;
+                    if (!reader.read(m_settings.orientationBits, value))
+                        return false;
+
+                    components[j] = Math::dequantize(value, -SMALLEST_THREE_RANGE,
+                                                     SMALLEST_THREE_RANGE,
+                                                     m_settings.orientationBits);
+                    sum += components[j] * components[j];
+                }
+
+                components[largest] = std::sqrt(std::max(1.0f - sum, 0.0f));
+
+                pose.orientation = KNM_TRANSFORMS_TREE_NORMALISE(
+                    quat(components[3], components[0], components[1], components[2])
+                );
+            }
+
+            if (mask & 4)
+            {
+                for (int j = 0; j < 3; ++j)
+                {
+                    uint32_t bits;
+                    if (!reader.read(32, bits))
+                        return false;
+
+                    std::memcpy(&pose.scale[j], &bits, sizeof(bits));
+                }
+            }
+
+            m_changed.push_back(node);
+            m_poses.push_back(pose);
+        }
+
+        Transforms::setTransforms(m_changed.data(), m_poses.data(), m_changed.size());
+
+        ++m_stats.nbMessages;
+        m_stats.nbNodes += nbEncoded;
+        m_stats.nbBytes += size;
+
+        return true;
+    }
+
+
+
+    /******************************* TRANSFORMS HISTORY *********************************/
+
+    TransformsHistory::TransformsHistory(size_t depth)
+    : m_depth(std::max(depth, size_t(1))), m_times(m_depth, 0.0), m_nbTicks(0)
+    {
+    }
+
+    //-----------------------------------------------------------------------
+
+    void TransformsHistory::record(double time, Transforms* const* changed, size_t count)
+    {
+        assert((m_nbTicks == 0) || (time > getNewestTime()));
+
+        m_times[m_nbTicks % m_depth] = time;
+        ++m_nbTicks;
+
+        for (size_t i = 0; i < count; ++i)
+        {
+            sample_t sample;
+            sample.time = time;
+            sample.pose = changed[i]->getWorldTransforms();
+
+            track_t& track = m_tracks[changed[i]];
+
+            if (track.samples.size() < m_depth)
+            {
+                if (track.samples.empty())
+                    track.start = 0;
+
+                track.samples.push_back(sample);
+            }
+            else
+            {
+                // Replace the oldest sample
+                track.samples[track.start] = sample;
+                track.start = (track.start + 1) % m_depth;
+            }
+        }
+    }
+
+    //-----------------------------------------------------------------------
+
+    double TransformsHistory::getOldestTime() const
+    {
+        assert(m_nbTicks > 0);
+        return (m_nbTicks <= m_depth ? m_times[0] : m_times[m_nbTicks % m_depth]);
+    }
+
+    //-----------------------------------------------------------------------
+
+    double TransformsHistory::getNewestTime() const
+    {
+        assert(m_nbTicks > 0);
+        return m_times[(m_nbTicks - 1) % m_depth];
+    }
+
+    //-----------------------------------------------------------------------
+
+    bool TransformsHistory::getWorldTransforms(Transforms* transforms, double time,
+                                               pose_t& pose) const
+    {
+        if ((m_nbTicks == 0) || (time < getOldestTime()))
+            return false;
+
+        auto iter = m_tracks.find(transforms);
+        if (iter == m_tracks.end())
+            return false;
+
+        const track_t& track = iter->second;
+        const size_t nbSamples = track.samples.size();
+
+        auto sample = [&track, nbSamples](size_t index) -> const sample_t& {
+            return track.samples[(track.start + index) % nbSamples];
+        };
+
+        if (time < sample(0).time)
+            return false;
+
+        // Find the last sample not after the requested time
+        size_t first = 0;
+        size_t last = nbSamples;
+        while (last - first > 1)
+        {
+            size_t middle = (first + last) / 2;
+            if (sample(middle).time <= time)
+                first = middle;
+            else
+                last = middle;
+        }
+
+        const sample_t& before = sample(first);
+
+        // The Transforms didn't change after that sample
+        if (first == nbSamples - 1)
+        {
+            pose = before.pose;
+            return true;
+        }
+
+        // The transforms changed between the previous tick and the next sample, so
+        // they are interpolated from the sample of that tick
+        const sample_t& after = sample(first + 1);
+
+        double previousTick = before.time;
+        for (size_t i = 0; i < std::min(m_nbTicks, m_depth); ++i)
+        {
+            double tick = m_times[(m_nbTicks - 1 - i) % m_depth];
+            if (tick < after.time)
+            {
+                previousTick = std::max(tick, before.time);
+                break;
+            }
+        }
+
+        if (time <= previousTick)
+        {
+            pose = before.pose;
+            return true;
+        }
+
+        real t = real((time - previousTick) / (after.time - previousTick));
+
+        pose = Math::interpolate(before.pose, after.pose, t);
+        return true;
+    }
+
+    //-----------------------------------------------------------------------
+
+    bool TransformsHistory::getRelativeTransforms(Transforms* transforms,
+                                                  Transforms* reference, double time,
+                                                  pose_t& pose) const
+    {
+        pose_t world;
+        pose_t referenceWorld;
+
+        if (!getWorldTransforms(transforms, time, world) ||
+            !getWorldTransforms(reference, time, referenceWorld))
+        {
+            return false;
+        }
+
+        quat inverseOrientation = KNM_TRANSFORMS_TREE_INVERSE(referenceWorld.orientation);
+
+        pose.position = (inverseOrientation * (world.position - referenceWorld.position)) /
+                        referenceWorld.scale;
+        pose.orientation = inverseOrientation * world.orientation;
+        pose.scale = world.scale / referenceWorld.scale;
+
+        return true;
+    }
+
+    //-----------------------------------------------------------------------
+
+    void TransformsHistory::forget(Transforms* transforms)
+    {
+        m_tracks.erase(transforms);
+    }
+
+    //-----------------------------------------------------------------------
+
+    void TransformsHistory::clear()
+    {
+        m_tracks.clear();
+        m_nbTicks = 0;
+    }
+
+
+    /****************************** RENDER INTERPOLATOR *********************************/
+
+    RenderInterpolator::RenderInterpolator()
+    {
+    }
+
+    //-----------------------------------------------------------------------
+
+    void RenderInterpolator::add(Transforms* const* nodes, size_t count)
+    {
+        for (size_t i = 0; i < count; ++i)
+        {
+            m_settled.push_back(m_nodes.size());
+
+            m_nodes.push_back(nodes[i]);
+            m_revisions.push_back(nodes[i]->getRevision());
+            m_current.push_back(nodes[i]->getWorldTransforms());
+            m_moving.push_back(0);
+        }
+    }
+
+    //-----------------------------------------------------------------------
+
+    void RenderInterpolator::capture()
+    {
+        m_movingIndices.clear();
+        m_movingPrevious.clear();
+        m_movingCurrent.clear();
+
+        for (size_t i = 0; i < m_nodes.size(); ++i)
+        {
+            uint32_t revision = m_nodes[i]->getRevision();
+
+            if (revision == m_revisions[i])
+            {
+                // The Transforms stopped moving: its output must be written one last time
+                if (m_moving[i])
+                    m_settled.push_back(i);
+
+                m_moving[i] = 0;
+                continue;
+            }
+
+            m_movingIndices.push_back(i);
+            m_movingPrevious.push_back(m_current[i]);
+
+            m_current[i] = m_nodes[i]->getWorldTransforms();
+            m_revisions[i] = m_nodes[i]->getRevision();
+            m_moving[i] = 1;
+
+            m_movingCurrent.push_back(m_current[i]);
+        }
+    }
+
+    //-----------------------------------------------------------------------
+
+    void RenderInterpolator::sample(real alpha, pose_t* out)
+    {
+        for (size_t index : m_settled)
+            out[index] = m_current[index];
+
+        m_settled.clear();
+
+        const size_t count = m_movingIndices.size();
+        const pose_t* previous = m_movingPrevious.data();
+        const pose_t* current = m_movingCurrent.data();
+        const real beta = 1.0f - alpha;
+
+        for (size_t i = 0; i < count; ++i)
+        {
+            pose_t& pose = out[m_movingIndices[i]];
+
+            pose.position = previous[i].position * beta + current[i].position * alpha;
+            pose.scale = previous[i].scale * beta + current[i].scale * alpha;
+
+            // nlerp, along the shortest path
+            const quat& q1 = previous[i].orientation;
+            const quat& q2 = current[i].orientation;
+            real sign = (KNM_TRANSFORMS_TREE_DOT(q1, q2) < 0.0f ? -alpha : alpha);
+
+            quat q(q1.w * beta + q2.w * sign, q1.x * beta + q2.x * sign,
+                   q1.y * beta + q2.y * sign, q1.z * beta + q2.z * sign);
+
+            pose.orientation = KNM_TRANSFORMS_TREE_NORMALISE(q);
+        }
+    }
+
+
+    /********************************* MOTION MATRICES **********************************/
+
+    MotionMatrices::MotionMatrices()
+    : m_frame(0)
+    {
+    }
+
+    //-----------------------------------------------------------------------
+
+    MotionMatrices::~MotionMatrices()
+    {
+        for (Transforms* transforms : m_nodes)
+        {
+            if (transforms)
+                transforms->m_motion = nullptr;
+        }
+    }
+
+    //-----------------------------------------------------------------------
+
+    void MotionMatrices::add(Transforms* const* nodes, size_t count)
+    {
+        for (size_t i = 0; i < count; ++i)
+        {
+            Transforms* transforms = nodes[i];
+            assert(!transforms->m_motion || (transforms->m_motion == this));
+
+            if (transforms->m_motion == this)
+                continue;
+
+            uint32_t slot;
+            if (!m_freeSlots.empty())
+            {
+                slot = m_freeSlots.back();
+                m_freeSlots.pop_back();
+            }
+            else
+            {
+                slot = uint32_t(m_pairs.size());
+                m_pairs.push_back(pair_t());
+                m_frames.push_back(0);
+                m_nodes.push_back(nullptr);
+            }
+
+            pair_t& pair = m_pairs[slot];
+            pair.current = transforms->getWorldMatrix();
+            pair.previous = pair.current;
+
+            m_frames[slot] = 0;
+            m_nodes[slot] = transforms;
+
+            transforms->m_motion = this;
+            transforms->m_motionSlot = slot;
+        }
+    }
+
+    //-----------------------------------------------------------------------
+
+    void MotionMatrices::remove(Transforms* transforms)
+    {
+        if (transforms->m_motion != this)
+            return;
+
+        m_nodes[transforms->m_motionSlot] = nullptr;
+        m_freeSlots.push_back(transforms->m_motionSlot);
+
+        transforms->m_motion = nullptr;
+    }
+
+    //-----------------------------------------------------------------------
+
+    void MotionMatrices::update(Transforms* const* changed, size_t count)
+    {
+        ++m_frame;
+
+        for (size_t i = 0; i < count; ++i)
+        {
+            Transforms* transforms = changed[i];
+            if (transforms->m_motion != this)
+                continue;
+
+            uint32_t slot = transforms->m_motionSlot;
+
+            // Whether the Transforms changed during the previous frame or before, its
+            // current matrix is the one of the previous frame
+            pair_t& pair = m_pairs[slot];
+            pair.previous = pair.current;
+            pair.current = transforms->getWorldMatrix();
+
+            m_frames[slot] = m_frame;
+        }
+    }
+
+    //-----------------------------------------------------------------------
+
+    void MotionMatrices::getMatrices(Transforms* transforms, mat4& current,
+                                     mat4& previous) const
+    {
+        assert(transforms->m_motion == this);
+
+        uint32_t slot = transforms->m_motionSlot;
+        const pair_t& pair = m_pairs[slot];
+
+        current = pair.current;
+        previous = (m_frames[slot] == m_frame ? pair.previous : pair.current);
+    }
+
+    //-----------------------------------------------------------------------
+
+    void MotionMatrices::write(Transforms* const* nodes, size_t count, mat4* out) const
+    {
+        for (size_t i = 0; i < count; ++i)
+            getMatrices(nodes[i], out[i * 2], out[i * 2 + 1]);
+    }
+
+
+    /**************************************** KERNELS ****************************************/
+
+    //-----------------------------------------------------------------------
+    // Interpolates between two arrays of quaternions along the shortest path (nlerp),
+    // each array holding the x, then y, z and w components of 'n' quaternions
+    //-----------------------------------------------------------------------
+    static void nlerp(const real* KNM_TRANSFORMS_TREE_RESTRICT a,
+                      const real* KNM_TRANSFORMS_TREE_RESTRICT b, real t,
+                      real* KNM_TRANSFORMS_TREE_RESTRICT result, size_t n)
+    {
+        const real u = 1.0f - t;
+
+        // Branch-free, so the loop is vectorized
+        for (size_t i = 0; i < n; ++i)
+        {
+            real dot = a[i] * b[i] + a[n + i] * b[n + i] + a[2 * n + i] * b[2 * n + i] +
+                       a[3 * n + i] * b[3 * n + i];
+            real s = std::copysign(t, dot);
+
+            real x = a[i] * u + b[i] * s;
+            real y = a[n + i] * u + b[n + i] * s;
+            real z = a[2 * n + i] * u + b[2 * n + i] * s;
+            real w = a[3 * n + i] * u + b[3 * n + i] * s;
+
+            real invLength = inverseSqrt(x * x + y * y + z * z + w * w);
+
+            result[i] = x * invLength;
+            result[n + i] = y * invLength;
+            result[2 * n + i] = z * invLength;
+            result[3 * n + i] = w * invLength;
+        }
+    }
+
+    //-----------------------------------------------------------------------
+    // Same as above, with one weight per quaternion, the result replacing the first
+    // array
+    //-----------------------------------------------------------------------
+    static void nlerp(real* KNM_TRANSFORMS_TREE_RESTRICT a,
+                      const real* KNM_TRANSFORMS_TREE_RESTRICT b,
+                      const real* KNM_TRANSFORMS_TREE_RESTRICT weights, size_t n)
+    {
+        for (size_t i = 0; i < n; ++i)
+        {
+            real dot = a[i] * b[i] + a[n + i] * b[n + i] + a[2 * n + i] * b[2 * n + i] +
+                       a[3 * n + i] * b[3 * n + i];
+            real t = weights[i];
+            real u = 1.0f - t;
+            real s = std::copysign(t, dot);
+
+            real x = a[i] * u + b[i] * s;
+            real y = a[n + i] * u + b[n + i] * s;
+            real z = a[2 * n + i] * u + b[2 * n + i] * s;
+            real w = a[3 * n + i] * u + b[3 * n + i] * s;
+
+            real invLength = inverseSqrt(x * x + y * y + z * z + w * w);
+
+            a[i] = x * invLength;
+            a[n + i] = y * invLength;
+            a[2 * n + i] = z * invLength;
+            a[3 * n + i] = w * invLength;
+        }
+    }
+
+    //-----------------------------------------------------------------------
+    // Replaces each quaternion 'q' of an array by 'inverse(r) * q' ('r' being the
+    // unit quaternion at the same index in another array)
+    //-----------------------------------------------------------------------
+    static void multiplyByInverse(real* KNM_TRANSFORMS_TREE_RESTRICT q,
+                                  const real* KNM_TRANSFORMS_TREE_RESTRICT r, size_t n)
+    {
+        for (size_t i = 0; i < n; ++i)
+        {
+            real qx = q[i], qy = q[n + i], qz = q[2 * n + i], qw = q[3 * n + i];
+            real rx = r[i], ry = r[n + i], rz = r[2 * n + i], rw = r[3 * n + i];
+
+            q[i] = rw * qx - rx * qw - ry * qz + rz * qy;
+            q[n + i] = rw * qy + rx * qz - ry * qw - rz * qx;
+            q[2 * n + i] = rw * qz - rx * qy + ry * qx - rz * qw;
+            q[3 * n + i] = rw * qw + rx * qx + ry * qy + rz * qz;
+        }
+    }
+
+    //-----------------------------------------------------------------------
+    // Replaces each quaternion 'q' of an array by 'q * nlerp(identity, d, weight)'
+    // ('d' and 'weight' being at the same index in other arrays)
+    //-----------------------------------------------------------------------
+    static void addWeighted(real* KNM_TRANSFORMS_TREE_RESTRICT q,
+                            const real* KNM_TRANSFORMS_TREE_RESTRICT d,
+                            const real* KNM_TRANSFORMS_TREE_RESTRICT weights, size_t n)
+    {
+        for (size_t i = 0; i < n; ++i)
+        {
+            real t = weights[i];
+            real s = std::copysign(t, d[3 * n + i]);
+
+            real dx = d[i] * s;
+            real dy = d[n + i] * s;
+            real dz = d[2 * n + i] * s;
+            real dw = (1.0f - t) + d[3 * n + i] * s;
+
+            real invLength = inverseSqrt(dx * dx + dy * dy + dz * dz + dw * dw);
+            dx *= invLength;
+            dy *= invLength;
+            dz *= invLength;
+            dw *= invLength;
+
+            real qx = q[i], qy = q[n + i], qz = q[2 * n + i], qw = q[3 * n + i];
+
+            q[i] = qw * dx + qx * dw + qy * dz - qz * dy;
+            q[n + i] = qw * dy - qx * dz + qy * dw + qz * dx;
+            q[2 * n + i] = qw * dz + qx * dy - qy * dx + qz * dw;
+            q[3 * n + i] = qw * dw - qx * dx - qy * dy - qz * dz;
+        }
+    }
+
+
+    /********************************* ANIMATION CLIP ***********************************/
+
+    const size_t AnimationClip::NB_COMPONENTS;
+
+    //-----------------------------------------------------------------------
+
+    AnimationClip::AnimationClip(size_t nbTracks, size_t nbKeys, real frameRate)
+    : m_nbTracks(nbTracks), m_nbKeys(std::max(nbKeys, size_t(1))), m_frameRate(frameRate),
+      m_values(m_nbKeys * NB_COMPONENTS * nbTracks, 0.0f)
+    {
+        assert(frameRate > 0.0f);
+
+        pose_t identity;
+        identity.position = VEC3_ZERO;
+        identity.orientation = QUAT_IDENTITY;
+        identity.scale = VEC3_UNIT_SCALE;
+
+        for (size_t key = 0; key < m_nbKeys; ++key)
+        {
+            for (size_t track = 0; track < m_nbTracks; ++track)
+                setKey(track, key, identity);
+        }
+    }
+
+    //-----------------------------------------------------------------------
+
+    void AnimationClip::setKey(size_t track, size_t key, const pose_t& pose)
+    {
+        assert(track < m_nbTracks);
+        assert(key < m_nbKeys);
+
+        real* values = &m_values[key * NB_COMPONENTS * m_nbTracks + track];
+
+        values[0] = pose.position.x;
+        values[m_nbTracks] = pose.position.y;
+        values[m_nbTracks * 2] = pose.position.z;
+        values[m_nbTracks * 3] = pose.orientation.x;
+        values[m_nbTracks * 4] = pose.orientation.y;
+        values[m_nbTracks * 5] = pose.orientation.z;
+        values[m_nbTracks * 6] = pose.orientation.w;
+        values[m_nbTracks * 7] = pose.scale.x;
+        values[m_nbTracks * 8] = pose.scale.y;
+        values[m_nbTracks * 9] = pose.scale.z;
+    }
+
+    //-----------------------------------------------------------------------
+
+    pose_t AnimationClip::getKey(size_t track, size_t key) const
+    {
+        assert(track < m_nbTracks);
+        assert(key < m_nbKeys);
+
+        const real* values = &m_values[key * NB_COMPONENTS * m_nbTracks + track];
+
+        pose_t pose;
+        pose.position = vec3(values[0], values[m_nbTracks], values[m_nbTracks * 2]);
+        pose.orientation = quat(values[m_nbTracks * 6], values[m_nbTracks * 3],
+                                values[m_nbTracks * 4], values[m_nbTracks * 5]);
+        pose.scale = vec3(values[m_nbTracks * 7], values[m_nbTracks * 8],
+                          values[m_nbTracks * 9]);
+
+        return pose;
+    }
+
+    //-----------------------------------------------------------------------
+
+    void AnimationClip::sample(real time, bool loop, real* values) const
+    {
+        const size_t n = m_nbTracks;
+        const size_t keySize = NB_COMPONENTS * n;
+
+        // Find the two keys surrounding the time
+        real duration = getDuration();
+        if (loop && (duration > 0.0f))
+        {
+            time = std::fmod(time, duration);
+            if (time < 0.0f)
+                time += duration;
+        }
+
+        real position = std::min(std::max(time, 0.0f), duration) * m_frameRate;
+        size_t key = std::min(size_t(position), m_nbKeys - 1);
+        size_t nextKey = std::min(key + 1, m_nbKeys - 1);
+
+        const real t = position - real(key);
+        const real u = 1.0f - t;
+
+        const real* a = &m_values[key * keySize];
+        const real* b = &m_values[nextKey * keySize];
+
+        // Positions
+        for (size_t i = 0; i < n * 3; ++i)
+            values[i] = a[i] * u + b[i] * t;
+
+        // Scales
+        for (size_t i = n * 7; i < n * 10; ++i)
+            values[i] = a[i] * u + b[i] * t;
+
+        // Orientations
+        nlerp(a + n * 3, b + n * 3, t, values + n * 3, n);
+    }
+
+
+    /******************************** ANIMATION SAMPLER *********************************/
+
+    AnimationSampler::AnimationSampler(const AnimationClip* clip, Transforms* const* nodes)
+    : m_clip(clip)
+    {
+        assert(clip);
+
+        for (size_t track = 0; track < clip->getNbTracks(); ++track)
+        {
+            if (nodes[track])
+            {
+                m_nodes.push_back(nodes[track]);
+                m_tracks.push_back(track);
+            }
+        }
+
+        m_values.resize(AnimationClip::NB_COMPONENTS * clip->getNbTracks());
+        m_poses.resize(m_nodes.size());
+    }
+
+    //-----------------------------------------------------------------------
+
+    void AnimationSampler::sample(real time, bool loop)
+    {
+        m_clip->sample(time, loop, m_values.data());
+
+        const size_t n = m_clip->getNbTracks();
+        const real* values = m_values.data();
+
+        for (size_t i = 0; i < m_nodes.size(); ++i)
+        {
+            size_t track = m_tracks[i];
+            pose_t& pose = m_poses[i];
+
+            pose.position = vec3(values[track], values[n + track], values[n * 2 + track]);
+            pose.orientation = quat(values[n * 6 + track], values[n * 3 + track],
+                                    values[n * 4 + track], values[n * 5 + track]);
+            pose.scale = vec3(values[n * 7 + track], values[n * 8 + track],
+                              values[n * 9 + track]);
+        }
+
+        Transforms::setTransforms(m_nodes.data(), m_poses.data(), m_nodes.size());
+    }
+
+
+    /*********************************** POSE BUFFER ************************************/
+
+    PoseBuffer::PoseBuffer(size_t size)
+    {
+        resize(size);
+    }
+
+    //-----------------------------------------------------------------------
+
+    void PoseBuffer::resize(size_t size)
+    {
+        m_size = size;
+        m_values.resize(AnimationClip::NB_COMPONENTS * size);
+        m_weights.resize(size);
+        m_poses.resize(size);
+
+        setIdentity();
+    }
+
+    //-----------------------------------------------------------------------
+
+    void PoseBuffer::setIdentity()
+    {
+        const size_t n = m_size;
+
+        std::fill(m_values.begin(), m_values.begin() + n * 6, 0.0f);
+        std::fill(m_values.begin() + n * 6, m_values.end(), 1.0f);
+    }
+
+    //-----------------------------------------------------------------------
+
+    void PoseBuffer::setPose(size_t index, const pose_t& pose)
+    {
+        assert(index < m_size);
+
+        const size_t n = m_size;
+        real* values = &m_values[index];
+
+        values[0] = pose.position.x;
+        values[n] = pose.position.y;
+        values[n * 2] = pose.position.z;
+        values[n * 3] = pose.orientation.x;
+        values[n * 4] = pose.orientation.y;
+        values[n * 5] = pose.orientation.z;
+        values[n * 6] = pose.orientation.w;
+        values[n * 7] = pose.scale.x;
+        values[n * 8] = pose.scale.y;
+        values[n * 9] = pose.scale.z;
+    }
+
+    //-----------------------------------------------------------------------
+
+    pose_t PoseBuffer::getPose(size_t index) const
+    {
+        assert(index < m_size);
+
+        const size_t n = m_size;
+        const real* values = &m_values[index];
+
+        pose_t pose;
+        pose.position = vec3(values[0], values[n], values[n * 2]);
+        pose.orientation = quat(values[n * 6], values[n * 3], values[n * 4], values[n * 5]);
+        pose.scale = vec3(values[n * 7], values[n * 8], values[n * 9]);
+
+        return pose;
+    }
+
+    //-----------------------------------------------------------------------
+
+    void PoseBuffer::capture(Transforms* const* nodes)
+    {
+        for (size_t i = 0; i < m_size; ++i)
+            setPose(i, nodes[i]->getTransforms());
+    }
+
+    //-----------------------------------------------------------------------
+
+    void PoseBuffer::commit(Transforms* const* nodes)
+    {
+        for (size_t i = 0; i < m_size; ++i)
+            m_poses[i] = getPose(i);
+
+        Transforms::setTransforms(nodes, m_poses.data(), m_size);
+    }
+
+    //-----------------------------------------------------------------------
+
+    void PoseBuffer::blend(const PoseBuffer& other, real weight, const real* mask)
+    {
+        assert(other.m_size == m_size);
+
+        const size_t n = m_size;
+        computeWeights(weight, mask);
+
+        const real* weights = m_weights.data();
+        real* a = m_values.data();
+        const real* b = other.m_values.data();
+
+        // Positions and scales
+        for (size_t c = 0; c < AnimationClip::NB_COMPONENTS; ++c)
+        {
+            if ((c >= 3) && (c < 7))
+                continue;
+
+            real* ac = a + c * n;
+            const real* bc = b + c * n;
+
+            for (size_t i = 0; i < n; ++i)
+                ac[i] += (bc[i] - ac[i]) * weights[i];
+        }
+
+        // Orientations (nlerp along the shortest path)
+        nlerp(a + n * 3, b + n * 3, weights, n);
+    }
+
+    //-----------------------------------------------------------------------
+
+    void PoseBuffer::makeAdditive(const PoseBuffer& reference)
+    {
+        assert(reference.m_size == m_size);
+
+        const size_t n = m_size;
+        real* a = m_values.data();
+        const real* r = reference.m_values.data();
+
+        // Positions
+        for (size_t i = 0; i < n * 3; ++i)
+            a[i] -= r[i];
+
+        // Scales
+        for (size_t i = n * 7; i < n * 10; ++i)
+            a[i] /= r[i];
+
+        // Orientations: inverse(reference) * orientation
+        multiplyByInverse(a + n * 3, r + n * 3, n);
+    }
+
+    //-----------------------------------------------------------------------
+
+    void PoseBuffer::addAdditive(const PoseBuffer& additive, real weight, const real* mask)
+    {
+        assert(additive.m_size == m_size);
+
+        const size_t n = m_size;
+        computeWeights(weight, mask);
+
+        const real* weights = m_weights.data();
+        real* a = m_values.data();
+        const real* d = additive.m_values.data();
+
+        // Positions
+        for (size_t c = 0; c < 3; ++c)
+        {
+            real* ac = a + c * n;
+            const real* dc = d + c * n;
+
+            for (size_t i = 0; i < n; ++i)
+                ac[i] += dc[i] * weights[i];
+        }
+
+        // Scales
+        for (size_t c = 7; c < 10; ++c)
+        {
+            real* ac = a + c * n;
+            const real* dc = d + c * n;
+
+            for (size_t i = 0; i < n; ++i)
+                ac[i] *= 1.0f + (dc[i] - 1.0f) * weights[i];
+        }
+
+        // Orientations: orientation * nlerp(identity, difference, weight)
+        addWeighted(a + n * 3, d + n * 3, weights, n);
+    }
+
+    //-----------------------------------------------------------------------
+
+    void PoseBuffer::computeWeights(real weight, const real* mask)
+    {
+        real* w = m_weights.data();
+
+        if (mask)
+        {
+            for (size_t i = 0; i < m_size; ++i)
+                w[i] = weight * mask[i];
+        }
+        else
+        {
+            std::fill(m_weights.begin(), m_weights.end(), weight);
+        }
+    }
+
+
+    /********************************* KINEMATIC CHAIN **********************************/
+
+    KinematicChain::KinematicChain(Transforms* const* links, const joint_type_t* types,
+                                   const vec3* axes, size_t count)
+    : m_links(links, links + count), m_joints(count), m_poses(count)
+    {
+        assert(count > 0);
+
+        for (size_t i = 0; i < count; ++i)
+        {
+            assert((i == 0) || (links[i]->getParent() == links[i - 1]));
+
+            m_joints[i].type = types[i];
+            m_joints[i].axis = axes[i];
+        }
+
+        captureRestPoses();
+    }
+
+    //-----------------------------------------------------------------------
+
+    void KinematicChain::captureRestPoses()
+    {
+        for (size_t i = 0; i < m_links.size(); ++i)
+        {
+            joint_t& joint = m_joints[i];
+
+            joint.rest = m_links[i]->getTransforms();
+            joint.inheritOrientation = m_links[i]->inheritOrientation();
+            joint.inheritScale = m_links[i]->inheritScale();
+        }
+    }
+
+    //-----------------------------------------------------------------------
+
+    void KinematicChain::computeForwardKinematics(const real* values, size_t nbConfigurations,
+                                                  pose_t* poses, real* jacobians)
+    {
+        const size_t n = m_links.size();
+
+        pose_t base;
+        base.position = VEC3_ZERO;
+        base.orientation = QUAT_IDENTITY;
+        base.scale = VEC3_UNIT_SCALE;
+
+        Transforms* parent = m_links[0]->getParent();
+        if (parent)
+            base = parent->getWorldTransforms();
+
+        for (size_t c = 0; c < nbConfigurations; ++c)
+        {
+            const real* v = values + c * n;
+            pose_t* world = poses + c * n;
+
+            // World transforms, from the base to the end effector
+            const pose_t* parentPose = &base;
+
+            for (size_t i = 0; i < n; ++i)
+            {
+                const joint_t& joint = m_joints[i];
+                pose_t local = getLocalPose(joint, v[i]);
+
+                world[i].orientation = (joint.inheritOrientation ?
+                                            KNM_TRANSFORMS_TREE_NORMALISE(parentPose->orientation * local.orientation) :
+                                            local.orientation);
+
+                world[i].scale = (joint.inheritScale ? parentPose->scale * local.scale : local.scale);
+
+                world[i].position = parentPose->orientation * (parentPose->scale * local.position) +
+                                    parentPose->position;
+
+                parentPose = &world[i];
+            }
+
+            if (!jacobians)
+                continue;
+
+            // Jacobian of the end effector
+            real* jacobian = jacobians + c * n * 6;
+            const vec3& end = world[n - 1].position;
+
+            for (size_t i = 0; i < n; ++i)
+            {
+                const joint_t& joint = m_joints[i];
+
+                vec3 linear = VEC3_ZERO;
+                vec3 angular = VEC3_ZERO;
+
+                if (joint.type == JT_REVOLUTE)
+                {
+                    angular = world[i].orientation * joint.axis;
+                    linear = KNM_TRANSFORMS_TREE_CROSS(angular, end - world[i].position);
+                }
+                else if (joint.type == JT_PRISMATIC)
+                {
+                    const pose_t& parentWorld = (i > 0 ? world[i - 1] : base);
+                    linear = parentWorld.orientation *
+                             (parentWorld.scale * (joint.rest.orientation * joint.axis));
+                }
+
+                real* column = jacobian + i * 6;
+                column[0] = linear.x;
+                column[1] = linear.y;
+                column[2] = linear.z;
+                column[3] = angular.x;
+                column[4] = angular.y;
+                column[5] = angular.z;
+            }
+        }
+    }
+
+    //-----------------------------------------------------------------------
+
+    void KinematicChain::apply(const real* values)
+    {
+        for (size_t i = 0; i < m_links.size(); ++i)
+            m_poses[i] = getLocalPose(m_joints[i], values[i]);
+
+        Transforms::setTransforms(m_links.data(), m_poses.data(), m_links.size());
+    }
+
+    //-----------------------------------------------------------------------
+
+    pose_t KinematicChain::getLocalPose(const joint_t& joint, real value) const
+    {
+        pose_t pose = joint.rest;
+
+        if (joint.type == JT_REVOLUTE)
+            pose.orientation = pose.orientation * KNM_TRANSFORMS_TREE_ANGLE_AXIS(value, joint.axis);
+        else if (joint.type == JT_PRISMATIC)
+            pose.position += pose.orientation * (joint.axis * value);
+
+        return pose;
+    }
+
+
+    /************************************ IK SOLVER *************************************/
+
+    IKSolver::IKSolver(Transforms* const* links, size_t count)
+    : m_links(links, links + count), m_local(count), m_world(count),
+      m_inheritOrientation(count), m_inheritScale(count), m_positions(count),
+      m_lengths(count)
+    {
+        assert(count >= 2);
+
+        for (size_t i = 1; i < count; ++i)
+            assert(links[i]->getParent() == links[i - 1]);
+    }
+
+    //-----------------------------------------------------------------------
+
+    bool IKSolver::solveCCD(const vec3& target, size_t maxIterations, real tolerance)
+    {
+        load();
+
+        const size_t last = m_links.size() - 1;
+        const real squaredTolerance = tolerance * tolerance;
+
+        bool reached = (KNM_TRANSFORMS_TREE_SQUARED_LENGTH(target - m_world[last].position) <= squaredTolerance);
+
+        for (size_t iteration = 0; (iteration < maxIterations) && !reached; ++iteration)
+        {
+            for (size_t i = last; i-- > 0; )
+            {
+                const vec3& joint = m_world[i].position;
+                vec3 toEnd = m_world[last].position - joint;
+                vec3 toTarget = target - joint;
+
+                if ((KNM_TRANSFORMS_TREE_SQUARED_LENGTH(toEnd) < 1e-12f) ||
+                    (KNM_TRANSFORMS_TREE_SQUARED_LENGTH(toTarget) < 1e-12f))
+                    continue;
+
+                rotate(i, Math::getRotationTo(toEnd, toTarget));
+            }
+
+            reached = (KNM_TRANSFORMS_TREE_SQUARED_LENGTH(target - m_world[last].position) <= squaredTolerance);
+        }
+
+        store();
+
+        return reached;
+    }
+
+    //-----------------------------------------------------------------------
+
+    bool IKSolver::solveFABRIK(const vec3& target, size_t maxIterations, real tolerance)
+    {
+        load();
+
+        const size_t last = m_links.size() - 1;
+        const real squaredTolerance = tolerance * tolerance;
+
+        real totalLength = 0.0f;
+        for (size_t i = 0; i <= last; ++i)
+        {
+            m_positions[i] = m_world[i].position;
+
+            if (i < last)
+            {
+                m_lengths[i] = glm::length(m_world[i + 1].position - m_world[i].position);
+                totalLength += m_lengths[i];
+            }
+        }
+
+        const vec3 root = m_positions[0];
+        vec3 toTarget = target - root;
+
+        if (KNM_TRANSFORMS_TREE_SQUARED_LENGTH(toTarget) >= totalLength * totalLength)
+        {
+            // Unreachable target: stretch the chain toward it
+            vec3 direction = KNM_TRANSFORMS_TREE_NORMALISE(toTarget);
+
+            for (size_t i = 0; i < last; ++i)
+                m_positions[i + 1] = m_positions[i] + direction * m_lengths[i];
+        }
+        else
+        {
+            for (size_t iteration = 0; iteration < maxIterations; ++iteration)
+            {
+                if (KNM_TRANSFORMS_TREE_SQUARED_LENGTH(target - m_positions[last]) <= squaredTolerance)
+                    break;
+
+                // Backward: from the end effector to the base
+                m_positions[last] = target;
+                for (size_t i = last; i-- > 0; )
+                {
+                    vec3 direction = m_positions[i] - m_positions[i + 1];
+                    real length = glm::length(direction);
+                    if (length > 1e-6f)
+                        m_positions[i] = m_positions[i + 1] + direction * (m_lengths[i] / length);
+                }
+
+                // Forward: from the base to the end effector
+                m_positions[0] = root;
+                for (size_t i = 0; i < last; ++i)
+                {
+                    vec3 direction = m_positions[i + 1] - m_positions[i];
+                    real length = glm::length(direction);
+                    if (length > 1e-6f)
+                        m_positions[i + 1] = m_positions[i] + direction * (m_lengths[i] / length);
+                }
+            }
+        }
+
+        // Convert the positions into rotations of the links
+        for (size_t i = 0; i < last; ++i)
+        {
+            vec3 current = m_world[i + 1].position - m_world[i].position;
+            vec3 desired = m_positions[i + 1] - m_world[i].position;
+
+            if ((KNM_TRANSFORMS_TREE_SQUARED_LENGTH(current) < 1e-12f) ||
+                (KNM_TRANSFORMS_TREE_SQUARED_LENGTH(desired) < 1e-12f))
+                continue;
+
+            rotate(i, Math::getRotationTo(current, desired));
+        }
+
+        store();
+
+        return (KNM_TRANSFORMS_TREE_SQUARED_LENGTH(target - m_world[last].position) <= squaredTolerance);
+    }
+
+    //-----------------------------------------------------------------------
+
+    void IKSolver::load()
+    {
+        m_base.position = VEC3_ZERO;
+        m_base.orientation = QUAT_IDENTITY;
+        m_base.scale = VEC3_UNIT_SCALE;
+
+        Transforms* parent = m_links[0]->getParent();
+        if (parent)
+            m_base = parent->getWorldTransforms();
+
+        for (size_t i = 0; i < m_links.size(); ++i)
+        {
+            m_local[i] = m_links[i]->getTransforms();
+            m_inheritOrientation[i] = m_links[i]->inheritOrientation();
+            m_inheritScale[i] = m_links[i]->inheritScale();
+        }
+
+        updateWorld(0);
+    }
+
+    //-----------------------------------------------------------------------
+
+    void IKSolver::rotate(size_t link, const quat& rotation)
+    {
+        quat orientation = KNM_TRANSFORMS_TREE_NORMALISE(rotation * m_world[link].orientation);
+
+        if (m_inheritOrientation[link])
+        {
+            const pose_t& parent = (link > 0 ? m_world[link - 1] : m_base);
+            orientation = KNM_TRANSFORMS_TREE_INVERSE(parent.orientation) * orientation;
+        }
+
+        m_local[link].orientation = orientation;
+
+        updateWorld(link);
+    }
+
+    //-----------------------------------------------------------------------
+
+    void IKSolver::updateWorld(size_t first)
+    {
+        for (size_t i = first; i < m_links.size(); ++i)
+        {
+            const pose_t& parent = (i > 0 ? m_world[i - 1] : m_base);
+            const pose_t& local = m_local[i];
+            pose_t& world = m_world[i];
+
+            world.orientation = (m_inheritOrientation[i] ?
+                                    KNM_TRANSFORMS_TREE_NORMALISE(parent.orientation * local.orientation) :
+                                    local.orientation);
+
+            world.scale = (m_inheritScale[i] ? parent.scale * local.scale : local.scale);
+
+            world.position = parent.orientation * (parent.scale * local.position) + parent.position;
+        }
+    }
+
+    //-----------------------------------------------------------------------
+
+    void IKSolver::store()
+    {
+        Transforms::setTransforms(m_links.data(), m_local.data(), m_links.size());
+    }
+
+
+    /******************************** CONSTRAINT SOLVER *********************************/
+
+    void ConstraintSolver::addAimConstraint(Transforms* transforms, Transforms* target,
+                                            const vec3& aimAxis, const vec3& upAxis,
+                                            const vec3& worldUp)
+    {
+        constraint_t& constraint = add(CT_AIM, transforms, &target, nullptr, 1);
+
+        constraint.aimAxis = KNM_TRANSFORMS_TREE_NORMALISE(aimAxis);
+        constraint.upAxis = KNM_TRANSFORMS_TREE_NORMALISE(upAxis);
+        constraint.worldUp = KNM_TRANSFORMS_TREE_NORMALISE(worldUp);
+    }
+
+    //-----------------------------------------------------------------------
+
+    void ConstraintSolver::addPositionConstraint(Transforms* transforms,
+                                                 Transforms* const* targets,
+                                                 const real* weights, size_t count)
+    {
+        add(CT_POSITION, transforms, targets, weights, count);
+    }
+
+    //-----------------------------------------------------------------------
+
+    void ConstraintSolver::addOrientationConstraint(Transforms* transforms,
+                                                    Transforms* const* targets,
+                                                    const real* weights, size_t count)
+    {
+        add(CT_ORIENTATION, transforms, targets, weights, count);
+    }
+
+    //-----------------------------------------------------------------------
+
+    void ConstraintSolver::addParentConstraint(Transforms* transforms,
+                                               Transforms* const* targets,
+                                               const real* weights, size_t count)
+    {
+        constraint_t& constraint = add(CT_PARENT, transforms, targets, weights, count);
+
+        pose_t world = transforms->getWorldTransforms();
+
+        constraint.offsets.resize(count);
+        for (size_t i = 0; i < count; ++i)
+        {
+            pose_t target = targets[i]->getWorldTransforms();
+            quat inverseOrientation = KNM_TRANSFORMS_TREE_INVERSE(target.orientation);
+
+            pose_t& offset = constraint.offsets[i];
+            offset.position = (inverseOrientation * (world.position - target.position)) / target.scale;
+            offset.orientation = inverseOrientation * world.orientation;
+            offset.scale = world.scale;
+        }
+    }
+
+    //-----------------------------------------------------------------------
+
+    void ConstraintSolver::removeConstraint(Transforms* transforms)
+    {
+        auto iter = m_indices.find(transforms);
+        if (iter == m_indices.end())
+            return;
+
+        size_t index = iter->second;
+        m_indices.erase(iter);
+
+        if (index != m_constraints.size() - 1)
+        {
+            m_constraints[index] = std::move(m_constraints.back());
+            m_indices[m_constraints[index].transforms] = index;
+        }
+
+        m_constraints.pop_back();
+    }
+
+    //-----------------------------------------------------------------------
+
+    bool ConstraintSolver::hasConstraint(Transforms* transforms) const
+    {
+        return (m_indices.find(transforms) != m_indices.end());
+    }
+
+    //-----------------------------------------------------------------------
+
+    bool ConstraintSolver::evaluate()
+    {
+        sort();
+
+        for (Transforms* transforms : m_order)
+            apply(m_constraints[m_indices[transforms]]);
+
+        return m_cyclic.empty();
+    }
+
+    //-----------------------------------------------------------------------
+
+    ConstraintSolver::constraint_t& ConstraintSolver::add(constraint_type_t type,
+                                                          Transforms* transforms,
+                                                          Transforms* const* targets,
+                                                          const real* weights, size_t count)
+    {
+        assert(transforms);
+        assert(count > 0);
+
+        removeConstraint(transforms);
+
+        m_indices[transforms] = m_constraints.size();
+        m_constraints.push_back(constraint_t());
+
+        constraint_t& constraint = m_constraints.back();
+        constraint.type = type;
+        constraint.transforms = transforms;
+        constraint.targets.assign(targets, targets + count);
+        constraint.weights.resize(count, 1.0f);
+
+        if (weights)
+            std::copy(weights, weights + count, constraint.weights.begin());
+
+        real total = 0.0f;
+        for (real weight : constraint.weights)
+            total += weight;
+
+        constraint.active = (total > 0.0f);
+
+        if (constraint.active)
+        {
+            for (real& weight : constraint.weights)
+                weight /= total;
+        }
+
+        return constraint;
+    }
+
+    //-----------------------------------------------------------------------
+
+    void ConstraintSolver::sort()
+    {
+        const size_t n = m_constraints.size();
+
+        m_dependents.resize(n);
+        m_nbDependencies.assign(n, 0);
+
+        for (size_t i = 0; i < n; ++i)
+            m_dependents[i].clear();
+
+        // A constraint depends on the ones of the ancestors of its Transforms, and on
+        // the ones of its targets and their ancestors
+        for (size_t i = 0; i < n; ++i)
+        {
+            const constraint_t& constraint = m_constraints[i];
 
-    Transforms::~Transforms()
-    {
-    }
+            addDependencies(i, constraint.transforms->getParent());
 
+            for (Transforms* target : constraint.targets)
+                addDependencies(i, target);
+        }
 
-    /************************** PARENT-CHILDREN RELATIONSHIP ****************************/
+        // Topological sort
+        m_order.clear();
+        m_cyclic.clear();
+        m_ready.clear();
 
-    void Transforms::setParent(Transforms* transforms)
-    {
-        assert(transforms != this);
+        for (size_t i = 0; i < n; ++i)
+        {
+            if (m_nbDependencies[i] == 0)
+                m_ready.push_back(i);
+        }
 
-        if (m_parent)
+        for (size_t i = 0; i < m_ready.size(); ++i)
         {
-            m_parent->m_children.erase(
-                std::find(m_parent->m_children.begin(), m_parent->m_children.end(), this)
-            );
-            m_parent = nullptr;
+            size_t index = m_ready[i];
+            m_order.push_back(m_constraints[index].transforms);
+
+            for (size_t dependent : m_dependents[index])
+            {
+                if (--m_nbDependencies[dependent] == 0)
+                    m_ready.push_back(dependent);
+            }
         }
 
-        if (transforms)
+        for (size_t i = 0; i < n; ++i)
         {
-            m_parent = transforms;
-            transforms->m_children.push_back(this);
+            if (m_nbDependencies[i] > 0)
+                m_cyclic.push_back(m_constraints[i].transforms);
         }
+    }
 
-        needUpdate();
+    //-----------------------------------------------------------------------
+
+    void ConstraintSolver::addDependencies(size_t constraint, Transforms* transforms)
+    {
+        while (transforms)
+        {
+            auto iter = m_indices.find(transforms);
+            if (iter != m_indices.end())
+            {
+                std::vector<size_t>& dependents = m_dependents[iter->second];
+                if (std::find(dependents.begin(), dependents.end(), constraint) == dependents.end())
+                {
+                    dependents.push_back(constraint);
+                    ++m_nbDependencies[constraint];
+                }
+            }
+
+            transforms = transforms->getParent();
+        }
     }
 
     //-----------------------------------------------------------------------
 
-    std::vector<Transforms*> Transforms::findChildren(const std::string& tag,
-                                                      bool recursive) const
+    void ConstraintSolver::apply(const constraint_t& constraint)
     {
-        assert(!tag.empty());
+        if (!constraint.active)
+            return;
 
-        std::vector<Transforms*> result;
+        Transforms* transforms = constraint.transforms;
+        pose_t world = transforms->getWorldTransforms();
 
-        for (Transforms* child : m_children)
+        switch (constraint.type)
         {
-            if (child->hasTag(tag))
-                result.push_back(child);
-
-            if (recursive)
+            case CT_AIM:
             {
-                auto result2 = child->findChildren(tag, true);
-                result.insert(result.end(), result2.begin(), result2.end());
-            }
-        }
+                vec3 direction = constraint.targets[0]->getWorldPosition() - world.position;
+                if (KNM_TRANSFORMS_TREE_SQUARED_LENGTH(direction) < 1e-12f)
+                    return;
 
-        return result;
-    }
+                direction = KNM_TRANSFORMS_TREE_NORMALISE(direction);
 
+                quat orientation = Math::getRotationTo(constraint.aimAxis, direction);
 
-    /******************************** MATRIX CONVERSIONS ********************************/
+                // Twist around the aim direction to bring the up axis toward the world one
+                vec3 up = orientation * constraint.upAxis;
+                up -= direction * KNM_TRANSFORMS_TREE_DOT(up, direction);
 
-    void Transforms::set(const mat4& matrix)
-    {
-        glm::vec3 skew;
-        glm::vec4 perspective;
+                vec3 worldUp = constraint.worldUp - direction * KNM_TRANSFORMS_TREE_DOT(constraint.worldUp, direction);
 
-        glm::decompose(matrix, m_scale, m_orientation, m_position, skew, perspective);
+                if ((KNM_TRANSFORMS_TREE_SQUARED_LENGTH(up) > 1e-12f) &&
+                    (KNM_TRANSFORMS_TREE_SQUARED_LENGTH(worldUp) > 1e-12f))
+                {
+                    orientation = Math::getRotationTo(up, worldUp, direction) * orientation;
+                }
 
-        needUpdate();
-    }
+                world.orientation = KNM_TRANSFORMS_TREE_NORMALISE(orientation);
+                break;
+            }
 
+            case CT_POSITION:
+            {
+                world.position = VEC3_ZERO;
+                for (size_t i = 0; i < constraint.targets.size(); ++i)
+                    world.position += constraint.targets[i]->getWorldPosition() * constraint.weights[i];
+                break;
+            }
 
-    mat4 Transforms::getWorldMatrix()
-    {
-        if (m_bDirty)
-            update();
+            case CT_ORIENTATION:
+            case CT_PARENT:
+            {
+                vec3 position = VEC3_ZERO;
+                quat orientation(0.0f, 0.0f, 0.0f, 0.0f);
+                quat first;
 
-        mat3 rot3x3(m_fullOrientation);
+                for (size_t i = 0; i < constraint.targets.size(); ++i)
+                {
+                    pose_t target = constraint.targets[i]->getWorldTransforms();
+                    real weight = constraint.weights[i];
 
-        return mat4(
-            m_fullScale.x * rot3x3[0][0], m_fullScale.x * rot3x3[0][1], m_fullScale.x * rot3x3[0][2], 0.0f,
-            m_fullScale.y * rot3x3[1][0], m_fullScale.y * rot3x3[1][1], m_fullScale.y * rot3x3[1][2], 0.0f,
-            m_fullScale.z * rot3x3[2][0], m_fullScale.z * rot3x3[2][1], m_fullScale.z * rot3x3[2][2], 0.0f,
-            m_fullPosition.x, m_fullPosition.y, m_fullPosition.z, 1.0f
-        );
-    }
+                    if (constraint.type == CT_PARENT)
+                    {
+                        const pose_t& offset = constraint.offsets[i];
 
+                        position += (target.orientation * (target.scale * offset.position) +
+                                     target.position) * weight;
+                        target.orientation = target.orientation * offset.orientation;
+                    }
 
-    mat4 Transforms::getMatrix()
-    {
-        mat3 rot3x3(m_orientation);
+                    // Blend along the shortest path from the first orientation
+                    if (i == 0)
+                        first = target.orientation;
+                    else if (KNM_TRANSFORMS_TREE_DOT(first, target.orientation) < 0.0f)
+                        weight = -weight;
 
-        return mat4(
-            m_scale.x * rot3x3[0][0], m_scale.x * rot3x3[0][1], m_scale.x * rot3x3[0][2], 0.0f,
-            m_scale.y * rot3x3[1][0], m_scale.y * rot3x3[1][1], m_scale.y * rot3x3[1][2], 0.0f,
-            m_scale.z * rot3x3[2][0], m_scale.z * rot3x3[2][1], m_scale.z * rot3x3[2][2], 0.0f,
-            m_position.x, m_position.y, m_position.z, 1.0f
-        );
-    }
+                    orientation.x += target.orientation.x * weight;
+                    orientation.y += target.orientation.y * weight;
+                    orientation.z += target.orientation.z * weight;
+                    orientation.w += target.orientation.w * weight;
+                }
 
+                world.orientation = KNM_TRANSFORMS_TREE_NORMALISE(orientation);
 
-    /************************************* POSITION *************************************/
+                if (constraint.type == CT_PARENT)
+                    world.position = position;
 
-    void Transforms::setPosition(const vec3& pos)
-    {
-        m_position = pos;
-        needUpdate();
+                break;
+            }
+        }
+
+        transforms->setWorldTransforms(world);
     }
 
-    //-----------------------------------------------------------------------
 
-    void Transforms::setPosition(real x, real y, real z)
+    /******************************* VELOCITY INTEGRATOR ********************************/
+
+    // Advances positions and orientations by velocities expressed in parent space. The
+    // values are stored as [component][node], the components being the position (3)
+    // and orientation (4: x, y, z, w) for the poses, and the linear velocity (3),
+    // angular velocity (3) and time step (1) for the velocities.
+    static void advance(real* KNM_TRANSFORMS_TREE_RESTRICT poses,
+                        const real* KNM_TRANSFORMS_TREE_RESTRICT velocities, size_t n)
     {
-        m_position.x = x;
-        m_position.y = y;
-        m_position.z = z;
-        needUpdate();
+        real* px = poses;
+        real* qx = poses + n * 3;
+        real* qy = poses + n * 4;
+        real* qz = poses + n * 5;
+        real* qw = poses + n * 6;
+        const real* wx = velocities + n * 3;
+        const real* wy = velocities + n * 4;
+        const real* wz = velocities + n * 5;
+        const real* dt = velocities + n * 6;
+
+        // Positions
+        for (size_t c = 0; c < 3; ++c)
+        {
+            real* p = px + c * n;
+            const real* v = velocities + c * n;
+
+            for (size_t i = 0; i < n; ++i)
+                p[i] += v[i] * dt[i];
+        }
+
+        // Orientations: rotation of (angular speed * dt) around the axis, in parent space.
+        // Branch-free, so the loop is vectorized.
+        for (size_t i = 0; i < n; ++i)
+        {
+            real speed2 = wx[i] * wx[i] + wy[i] * wy[i] + wz[i] * wz[i];
+            real speed = speed2 * inverseSqrt(speed2);  // 0 if there is no rotation
+            real halfAngle = speed * dt[i] * 0.5f;
+
+            real sine;
+            real rw;
+            sinCos(halfAngle, sine, rw);
+
+            // The sine is 0 if the speed is, whatever it is divided by
+            const real MIN_SPEED = std::numeric_limits<real>::min();
+            real s = sine / (speed > MIN_SPEED ? speed : MIN_SPEED);
+            real rx = wx[i] * s;
+            real ry = wy[i] * s;
+            real rz = wz[i] * s;
+
+            real x = rw * qx[i] + rx * qw[i] + ry * qz[i] - rz * qy[i];
+            real y = rw * qy[i] - rx * qz[i] + ry * qw[i] + rz * qx[i];
+            real z = rw * qz[i] + rx * qy[i] - ry * qx[i] + rz * qw[i];
+            real w = rw * qw[i] - rx * qx[i] - ry * qy[i] - rz * qz[i];
+
+            real invLength = inverseSqrt(x * x + y * y + z * z + w * w);
+
+            qx[i] = x * invLength;
+            qy[i] = y * invLength;
+            qz[i] = z * invLength;
+            qw[i] = w * invLength;
+        }
     }
 
     //-----------------------------------------------------------------------
 
-    void Transforms::setPosition(real* pos)
+    void VelocityIntegrator::setVelocity(Transforms* transforms, const vec3& linear,
+                                         const vec3& angular, transform_space_t relativeTo)
     {
-        m_position.x = pos[0];
-        m_position.y = pos[1];
-        m_position.z = pos[2];
-        needUpdate();
+        assert(transforms);
+
+        auto iter = m_indices.find(transforms);
+        if (iter == m_indices.end())
+        {
+            iter = m_indices.insert(std::make_pair(transforms, m_nodes.size())).first;
+
+            m_nodes.push_back(transforms);
+            m_linear.push_back(linear);
+            m_angular.push_back(angular);
+            m_spaces.push_back(relativeTo);
+        }
+        else
+        {
+            size_t index = iter->second;
+
+            m_linear[index] = linear;
+            m_angular[index] = angular;
+            m_spaces[index] = relativeTo;
+        }
     }
 
     //-----------------------------------------------------------------------
 
-    void Transforms::translate(const vec3& d, transform_space_t relativeTo)
+    void VelocityIntegrator::removeVelocity(Transforms* transforms)
     {
-        switch(relativeTo)
-        {
-        case TS_LOCAL:
-            // Position is relative to parent so transform downwards
-            m_position += m_orientation * d;
-            break;
+        auto iter = m_indices.find(transforms);
+        if (iter == m_indices.end())
+            return;
 
-        case TS_PARENT:
-            m_position += d;
-            break;
+        size_t index = iter->second;
+        m_indices.erase(iter);
 
-        case TS_WORLD:
-            {
-                // Position is relative to parent so transform upwards
-                if (m_parent)
-                    m_position += (KNM_TRANSFORMS_TREE_INVERSE(m_parent->getWorldOrientation()) * d) / m_parent->getWorldScale();
-                else
-                    m_position += d;
-                break;
-            }
+        size_t last = m_nodes.size() - 1;
+        if (index != last)
+        {
+            m_nodes[index] = m_nodes[last];
+            m_linear[index] = m_linear[last];
+            m_angular[index] = m_angular[last];
+            m_spaces[index] = m_spaces[last];
+
+            m_indices[m_nodes[index]] = index;
         }
 
-        needUpdate();
+        m_nodes.pop_back();
+        m_linear.pop_back();
+        m_angular.pop_back();
+        m_spaces.pop_back();
     }
 
     //-----------------------------------------------------------------------
 
-    void Transforms::translate(real x, real y, real z, transform_space_t relativeTo)
+    bool VelocityIntegrator::hasVelocity(Transforms* transforms) const
     {
-        translate(vec3(x, y, z), relativeTo);
+        return (m_indices.find(transforms) != m_indices.end());
     }
 
     //-----------------------------------------------------------------------
 
-    void Transforms::translate(real* d, transform_space_t relativeTo)
+    vec3 VelocityIntegrator::getLinearVelocity(Transforms* transforms) const
     {
-        translate(vec3(d[0], d[1], d[2]), relativeTo);
+        auto iter = m_indices.find(transforms);
+        return (iter != m_indices.end() ? m_linear[iter->second] : VEC3_ZERO);
     }
 
     //-----------------------------------------------------------------------
 
-    vec3 Transforms::getWorldPosition()
+    vec3 VelocityIntegrator::getAngularVelocity(Transforms* transforms) const
     {
-        if (m_bDirty)
-            update();
-
-        return m_fullPosition;
+        auto iter = m_indices.find(transforms);
+        return (iter != m_indices.end() ? m_angular[iter->second] : VEC3_ZERO);
     }
 
+    //-----------------------------------------------------------------------
 
-    /*************************************** ORIENTATION ***************************************/
-
-    void Transforms::setDirection(const vec3& vec, transform_space_t relativeTo,
-                                  const vec3& localDirectionVector)
+    void VelocityIntegrator::integrate(real dt)
     {
-        // Do nothing if given a zero vector
-        if (vec == VEC3_ZERO)
+        const size_t n = m_nodes.size();
+        if (n == 0)
             return;
 
-        // The direction we want the local direction point to
-        vec3 targetDir = KNM_TRANSFORMS_TREE_NORMALISE(vec);
-
-        // Transform target direction to world space
-        switch (relativeTo)
+        m_values.resize(n * 14);
+        m_poses.resize(n);
+
+        real* px = m_values.data();
+        real* py = px + n;
+        real* pz = px + n * 2;
+        real* qx = px + n * 3;
+        real* qy = px + n * 4;
+        real* qz = px + n * 5;
+        real* qw = px + n * 6;
+        real* vx = px + n * 7;
+        real* vy = px + n * 8;
+        real* vz = px + n * 9;
+        real* wx = px + n * 10;
+        real* wy = px + n * 11;
+        real* wz = px + n * 12;
+        real* steps = px + n * 13;
+
+        // Gather the local transforms, with the velocities expressed in parent space
+        for (size_t i = 0; i < n; ++i)
         {
-        case TS_LOCAL:
-            targetDir = getWorldOrientation() * targetDir;
-            break;
+            Transforms* transforms = m_nodes[i];
+            pose_t& pose = m_poses[i];
 
-        case TS_PARENT:
-            if (m_bInheritOrientation && m_parent)
-                targetDir = m_parent->getWorldOrientation() * targetDir;
-            break;
+            pose = transforms->getTransforms();
 
-        case TS_WORLD:
-            // default orientation
-            break;
-        }
+            vec3 linear = m_linear[i];
+            vec3 angular = m_angular[i];
 
-        // Calculate target orientation relative to world space
-        quat targetOrientation;
+            switch (m_spaces[i])
+            {
+            case TS_LOCAL:
+                linear = pose.orientation * linear;
+                angular = pose.orientation * angular;
+                break;
 
-        // Get current local direction relative to world space
-        const quat& currentOrient = getWorldOrientation();
-        vec3 currentDir = currentOrient * localDirectionVector;
+            case TS_PARENT:
+                break;
 
-        if (KNM_TRANSFORMS_TREE_SQUARED_LENGTH(currentDir + targetDir) < 0.00005f)
-        {
-            // Oops, a 180 degree turn (infinite possible rotation axes)
-            // Default to pitch i.e. use current UP
-            targetOrientation =
-                quat(-currentOrient.y, -currentOrient.z, currentOrient.w, currentOrient.x);
-        }
-        else
-        {
-            // Derive shortest arc to new direction
-            quat rotQuat = Math::getRotationTo(currentDir, targetDir);
-            targetOrientation = rotQuat * currentOrient;
-        }
+            case TS_WORLD:
+                {
+                    Transforms* parent = transforms->getParent();
+                    if (parent)
+                    {
+                        quat inverseOrientation = KNM_TRANSFORMS_TREE_INVERSE(parent->getWorldOrientation());
 
-        // Set target orientation, transformed to parent space
-        if (m_parent && m_bInheritOrientation)
-        {
-            quat q = m_parent->getWorldOrientation();
-            setOrientation(quat(q.w, -q.x, -q.y, -q.z) * targetOrientation);
+                        linear = (inverseOrientation * linear) / parent->getWorldScale();
+
+                        if (transforms->inheritOrientation())
+                            angular = inverseOrientation * angular;
+                    }
+                    break;
+                }
+            }
+
+            px[i] = pose.position.x;
+            py[i] = pose.position.y;
+            pz[i] = pose.position.z;
+            qx[i] = pose.orientation.x;
+            qy[i] = pose.orientation.y;
+            qz[i] = pose.orientation.z;
+            qw[i] = pose.orientation.w;
+            vx[i] = linear.x;
+            vy[i] = linear.y;
+            vz[i] = linear.z;
+            wx[i] = angular.x;
+            wy[i] = angular.y;
+            wz[i] = angular.z;
+            steps[i] = dt;
         }
-        else
+
+        advance(m_values.data(), m_values.data() + n * 7, n);
+
+        // Write back the local transforms
+        for (size_t i = 0; i < n; ++i)
         {
-            setOrientation(targetOrientation);
+            pose_t& pose = m_poses[i];
+
+            pose.position = vec3(px[i], py[i], pz[i]);
+            pose.orientation = quat(qw[i], qx[i], qy[i], qz[i]);
         }
+
+        Transforms::setTransforms(m_nodes.data(), m_poses.data(), n);
     }
 
-    //-----------------------------------------------------------------------
 
-    void Transforms::lookAt(const vec3& targetPoint, transform_space_t relativeTo,
-                            const vec3& localDirectionVector)
+    /*********************************** EXTRAPOLATOR ***********************************/
+
+    // Combines local transforms with the world transforms of the parent
+    static pose_t combine(const pose_t& parent, const pose_t& local, bool inheritOrientation,
+                          bool inheritScale)
     {
-        // Calculate our self origin relative to the given transform space
-        vec3 origin;
-        switch (relativeTo)
-        {
-        case TS_WORLD:
-            origin = getWorldPosition();
-            break;
+        pose_t world;
 
-        case TS_PARENT:
-            origin = m_position;
-            break;
+        world.orientation = (inheritOrientation ?
+                                KNM_TRANSFORMS_TREE_NORMALISE(parent.orientation * local.orientation) :
+                                local.orientation);
 
-        case TS_LOCAL:
-            origin = VEC3_ZERO;
-            break;
-        }
+        world.scale = (inheritScale ? parent.scale * local.scale : local.scale);
 
-        setDirection(targetPoint - origin, relativeTo, localDirectionVector);
+        world.position = parent.orientation * (parent.scale * local.position) + parent.position;
+
+        return world;
     }
 
     //-----------------------------------------------------------------------
 
-    void Transforms::setOrientation(const quat& q)
+    void Extrapolator::setReference(Transforms* transforms, double time, const pose_t& pose,
+                                    const vec3& linear, const vec3& angular)
     {
-        m_orientation = q;
-        needUpdate();
-    }
+        assert(transforms);
 
-    //-----------------------------------------------------------------------
+        reference_t reference;
+        reference.time = time;
+        reference.pose = pose;
+        reference.linear = linear;
+        reference.angular = angular;
 
-    void Transforms::setOrientation(real x, real y, real z, real w)
-    {
-        m_orientation.w = w;
-        m_orientation.x = x;
-        m_orientation.y = y;
-        m_orientation.z = z;
-        needUpdate();
+        auto iter = m_indices.find(transforms);
+        if (iter == m_indices.end())
+        {
+            m_indices[transforms] = m_nodes.size();
+            m_nodes.push_back(transforms);
+            m_references.push_back(reference);
+        }
+        else
+        {
+            m_references[iter->second] = reference;
+        }
     }
 
     //-----------------------------------------------------------------------
 
-    void Transforms::setOrientation(real* q)
+    void Extrapolator::remove(Transforms* transforms)
     {
-        m_orientation.w = q[0];
-        m_orientation.x = q[1];
-        m_orientation.y = q[2];
-        m_orientation.z = q[3];
-        needUpdate();
+        auto iter = m_indices.find(transforms);
+        if (iter == m_indices.end())
+            return;
+
+        size_t index = iter->second;
+        m_indices.erase(iter);
+
+        size_t last = m_nodes.size() - 1;
+        if (index != last)
+        {
+            m_nodes[index] = m_nodes[last];
+            m_references[index] = m_references[last];
+
+            m_indices[m_nodes[index]] = index;
+        }
+
+        m_nodes.pop_back();
+        m_references.pop_back();
     }
 
     //-----------------------------------------------------------------------
 
-    void Transforms::roll(real angle, transform_space_t relativeTo)
+    bool Extrapolator::contains(Transforms* transforms) const
     {
-        rotate(VEC3_UNIT_X, angle, relativeTo);
+        return (m_indices.find(transforms) != m_indices.end());
     }
 
     //-----------------------------------------------------------------------
 
-    void Transforms::pitch(real angle, transform_space_t relativeTo)
+    bool Extrapolator::getTransforms(Transforms* transforms, double time, pose_t& pose) const
     {
-        rotate(VEC3_UNIT_Y, angle, relativeTo);
-    }
+        auto iter = m_indices.find(transforms);
+        if (iter == m_indices.end())
+            return false;
 
-    //-----------------------------------------------------------------------
+        const reference_t& reference = m_references[iter->second];
+        const real dt = real(time - reference.time);
 
-    void Transforms::yaw(real angle, transform_space_t relativeTo)
-    {
-        rotate(VEC3_UNIT_Z, angle, relativeTo);
+        pose = reference.pose;
+        pose.position += reference.linear * dt;
+
+        real speed = glm::length(reference.angular);
+        if (speed > 1e-12f)
+        {
+            quat rotation = KNM_TRANSFORMS_TREE_ANGLE_AXIS(speed * dt, reference.angular / speed);
+            pose.orientation = KNM_TRANSFORMS_TREE_NORMALISE(rotation * pose.orientation);
+        }
+
+        return true;
     }
 
     //-----------------------------------------------------------------------
 
-    void Transforms::rotate(const vec3& axis, real angle,
-                            transform_space_t relativeTo)
+    pose_t Extrapolator::getWorldTransforms(Transforms* transforms, double time)
     {
-        rotate(KNM_TRANSFORMS_TREE_ANGLE_AXIS(angle, axis), relativeTo);
+        pose_t world;
+        if (!computeWorld(transforms, time, false, world))
+            world = transforms->getWorldTransforms();
+
+        return world;
     }
 
     //-----------------------------------------------------------------------
 
-    void Transforms::rotate(const quat& q, transform_space_t relativeTo)
+    void Extrapolator::getWorldTransforms(double time, pose_t* poses)
     {
-        switch (relativeTo)
+        const size_t n = m_nodes.size();
+        if (n == 0)
+            return;
+
+        m_values.resize(n * 14);
+        m_local.resize(n);
+        m_world.resize(n);
+        m_resolved.assign(n, 0);
+
+        // Extrapolate all the local transforms
+        real* values = m_values.data();
+
+        for (size_t i = 0; i < n; ++i)
         {
-        case TS_PARENT:
-            // Rotations are normally relative to local axes, transform up
-            m_orientation = q * m_orientation;
-            break;
+            const reference_t& reference = m_references[i];
+
+            values[i] = reference.pose.position.x;
+            values[n + i] = reference.pose.position.y;
+            values[n * 2 + i] = reference.pose.position.z;
+            values[n * 3 + i] = reference.pose.orientation.x;
+            values[n * 4 + i] = reference.pose.orientation.y;
+            values[n * 5 + i] = reference.pose.orientation.z;
+            values[n * 6 + i] = reference.pose.orientation.w;
+            values[n * 7 + i] = reference.linear.x;
+            values[n * 8 + i] = reference.linear.y;
+            values[n * 9 + i] = reference.linear.z;
+            values[n * 10 + i] = reference.angular.x;
+            values[n * 11 + i] = reference.angular.y;
+            values[n * 12 + i] = reference.angular.z;
+            values[n * 13 + i] = real(time - reference.time);
+        }
 
-        case TS_WORLD:
-            // Rotations are normally relative to local axes, transform up
-            m_orientation = m_orientation * KNM_TRANSFORMS_TREE_INVERSE(getWorldOrientation()) * q * getWorldOrientation();
-            break;
+        advance(values, values + n * 7, n);
 
-        case TS_LOCAL:
-            // Note the order of the mult, i.e. q comes after
-            m_orientation = m_orientation * q;
-            break;
+        for (size_t i = 0; i < n; ++i)
+        {
+            pose_t& pose = m_local[i];
+
+            pose.position = vec3(values[i], values[n + i], values[n * 2 + i]);
+            pose.orientation = quat(values[n * 6 + i], values[n * 3 + i], values[n * 4 + i],
+                                    values[n * 5 + i]);
+            pose.scale = m_references[i].pose.scale;
         }
 
-        needUpdate();
+        // Combine them with the world transforms of the parents
+        m_intermediates.clear();
+
+        for (size_t i = 0; i < n; ++i)
+            computeWorld(m_nodes[i], time, true, poses[i]);
     }
 
     //-----------------------------------------------------------------------
 
-    void Transforms::resetOrientation()
+    bool Extrapolator::computeWorld(Transforms* transforms, double time, bool batch,
+                                    pose_t& world)
     {
-        m_orientation = QUAT_IDENTITY;
-        needUpdate();
-    }
+        Transforms* parent = transforms->getParent();
 
-    //-----------------------------------------------------------------------
+        auto iter = m_indices.find(transforms);
+        if (iter == m_indices.end())
+        {
+            // During a batch evaluation, the intermediate Transforms are only processed
+            // once, whatever the number of extrapolated Transforms below them
+            if (batch)
+            {
+                auto memo = m_intermediates.find(transforms);
+                if (memo != m_intermediates.end())
+                {
+                    world = memo->second.world;
+                    return memo->second.affected;
+                }
+            }
 
-    void Transforms::setInheritOrientation(bool bInherit)
-    {
-        m_bInheritOrientation = bInherit;
-        needUpdate();
+            pose_t parentWorld;
+            bool affected = (parent && computeWorld(parent, time, batch, parentWorld));
+
+            if (affected)
+            {
+                world = combine(parentWorld, transforms->getTransforms(),
+                                transforms->inheritOrientation(), transforms->inheritScale());
+            }
+
+            if (batch)
+            {
+                intermediate_t& intermediate = m_intermediates[transforms];
+                intermediate.affected = affected;
+                intermediate.world = world;
+            }
+
+            return affected;
+        }
+
+        size_t index = iter->second;
+        if (batch && m_resolved[index])
+        {
+            world = m_world[index];
+            return true;
+        }
+
+        pose_t local;
+        if (batch)
+            local = m_local[index];
+        else
+            getTransforms(transforms, time, local);
+
+        world = local;
+        if (parent)
+        {
+            // Use the world transforms of the tree if no ancestor is extrapolated
+            pose_t parentWorld;
+            if (!computeWorld(parent, time, batch, parentWorld))
+                parentWorld = parent->getWorldTransforms();
+
+            world = combine(parentWorld, local, transforms->inheritOrientation(),
+                            transforms->inheritScale());
+        }
+
+        if (batch)
+        {
+            m_world[index] = world;
+            m_resolved[index] = 1;
+        }
+
+        return true;
     }
 
+
+    /******************************* SHARED EXPORT WRITER *******************************/
+
+    const uint32_t SharedExportWriter::MAGIC = 0x5058544B;      // "KTXP"
+    const uint32_t SharedExportWriter::VERSION = 1;
+
     //-----------------------------------------------------------------------
 
-    quat Transforms::getWorldOrientation()
+    SharedExportWriter::SharedExportWriter(void* memory, size_t capacity, size_t nbSlots,
+                                           export_format_t format)
+    : m_header(static_cast<header_t*>(memory)), m_format(format), m_frame(0)
     {
-        if (m_bDirty)
-            update();
+        assert(memory);
+        assert((reinterpret_cast<uintptr_t>(memory) % 8) == 0);
+        assert(nbSlots >= 2);
 
-        return m_fullOrientation;
-    }
+        const size_t slotSize = (getRequiredSize(capacity, 1, format) - sizeof(header_t));
 
+        m_header = new (memory) header_t();
+        assert(m_header->lastFrame.is_lock_free());
 
-    /**************************************** SCALE *****************************************/
+        m_header->magic = MAGIC;
+        m_header->version = VERSION;
+        m_header->capacity = uint32_t(capacity);
+        m_header->nbSlots = uint32_t(nbSlots);
+        m_header->format = uint32_t(format);
+        m_header->slotSize = uint32_t(slotSize);
 
-    void Transforms::setScale(const vec3& scale)
-    {
-        m_scale = scale;
-        needUpdate();
+        m_slots = static_cast<uint8_t*>(memory) + sizeof(header_t);
+
+        for (size_t i = 0; i < nbSlots; ++i)
+        {
+            slot_t* slot = new (m_slots + i * slotSize) slot_t();
+            slot->sequence.store(0, std::memory_order_relaxed);
+            slot->frame = 0;
+            slot->nbNodes = 0;
+        }
+
+        m_header->lastFrame.store(0, std::memory_order_release);
     }
 
     //-----------------------------------------------------------------------
 
-    void Transforms::setScale(real x, real y, real z)
+    size_t SharedExportWriter::getRequiredSize(size_t capacity, size_t nbSlots,
+                                               export_format_t format)
     {
-        m_scale.x = x;
-        m_scale.y = y;
-        m_scale.z = z;
-        needUpdate();
+        size_t slotSize = sizeof(slot_t) + capacity * getValuesPerNode(format) * sizeof(float);
+        slotSize = (slotSize + 7) & ~size_t(7);
+
+        return sizeof(header_t) + nbSlots * slotSize;
     }
 
     //-----------------------------------------------------------------------
 
-    void Transforms::setScale(real scale)
+    uint64_t SharedExportWriter::write(Transforms* const* nodes, size_t count)
     {
-        m_scale.x = scale;
-        m_scale.y = scale;
-        m_scale.z = scale;
-        needUpdate();
+        assert(count <= m_header->capacity);
+
+        ++m_frame;
+
+        slot_t* slot = reinterpret_cast<slot_t*>(
+            m_slots + (m_frame % m_header->nbSlots) * m_header->slotSize
+        );
+
+        // Retrieve the world transforms first (which might update the Transforms), so
+        // the slot is only locked during the copy
+        m_values.resize(count * getValuesPerNode(m_format));
+
+        for (size_t i = 0; i < count; ++i)
+        {
+            pose_t pose = nodes[i]->getWorldTransforms();
+
+            if (m_format == EF_POSES)
+            {
+                float* dest = m_values.data() + i * 10;
+                dest[0] = pose.position.x;
+                dest[1] = pose.position.y;
+                dest[2] = pose.position.z;
+                dest[3] = pose.orientation.x;
+                dest[4] = pose.orientation.y;
+                dest[5] = pose.orientation.z;
+                dest[6] = pose.orientation.w;
+                dest[7] = pose.scale.x;
+                dest[8] = pose.scale.y;
+                dest[9] = pose.scale.z;
+            }
+            else
+            {
+                float* dest = m_values.data() + i * 12;
+                mat3 rot3x3(pose.orientation);
+
+                for (int row = 0; row < 3; ++row)
+                {
+                    dest[row * 4] = rot3x3[0][row] * pose.scale.x;
+                    dest[row * 4 + 1] = rot3x3[1][row] * pose.scale.y;
+                    dest[row * 4 + 2] = rot3x3[2][row] * pose.scale.z;
+                    dest[row * 4 + 3] = pose.position[row];
+                }
+            }
+        }
+
+        // Mark the slot as being written
+        uint64_t sequence = slot->sequence.load(std::memory_order_relaxed);
+        slot->sequence.store(sequence + 1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+
+        slot->frame = m_frame;
+        slot->nbNodes = uint32_t(count);
+
+        std::memcpy(slot + 1, m_values.data(), m_values.size() * sizeof(float));
+
+        // Publish the frame
+        slot->sequence.store(sequence + 2, std::memory_order_release);
+        m_header->lastFrame.store(m_frame, std::memory_order_release);
+
+        return m_frame;
     }
 
     //-----------------------------------------------------------------------
 
-    void Transforms::setScale(real* scale)
+    size_t SharedExportWriter::getValuesPerNode(export_format_t format)
     {
-        m_scale.x = scale[0];
-        m_scale.y = scale[1];
-        m_scale.z = scale[2];
-        needUpdate();
+        return (format == EF_POSES ? 10 : 12);
     }
 
-    //-----------------------------------------------------------------------
 
-    void Transforms::scale(const vec3& scale)
+    /******************************* SHARED EXPORT READER *******************************/
+
+    SharedExportReader::SharedExportReader(const void* memory, size_t size)
+    : m_header(nullptr), m_slots(nullptr)
     {
-        m_scale = m_scale * scale;
-        needUpdate();
+        typedef SharedExportWriter::header_t header_t;
+
+        if (!memory || (size < sizeof(header_t)))
+            return;
+
+        const header_t* header = static_cast<const header_t*>(memory);
+
+        if ((header->magic != SharedExportWriter::MAGIC) ||
+            (header->version != SharedExportWriter::VERSION) || (header->nbSlots < 2) ||
+            (header->format > EF_MATRICES))
+        {
+            return;
+        }
+
+        export_format_t format = export_format_t(header->format);
+
+        if ((header->slotSize != SharedExportWriter::getRequiredSize(header->capacity, 1,
+                                                                     format) -
+                                 sizeof(header_t)) ||
+            (size < SharedExportWriter::getRequiredSize(header->capacity, header->nbSlots,
+                                                        format)))
+        {
+            return;
+        }
+
+        m_header = header;
+        m_slots = static_cast<const uint8_t*>(memory) + sizeof(header_t);
     }
 
     //-----------------------------------------------------------------------
 
-    void Transforms::scale(real x, real y, real z)
+    export_format_t SharedExportReader::getFormat() const
     {
-        scale(vec3(x, y, z));
+        assert(isValid());
+        return export_format_t(m_header->format);
     }
 
     //-----------------------------------------------------------------------
 
-    void Transforms::scale(real* scales)
+    size_t SharedExportReader::getValuesPerNode() const
     {
-        scale(vec3(scales[0], scales[1], scales[2]));
+        return SharedExportWriter::getValuesPerNode(getFormat());
     }
 
     //-----------------------------------------------------------------------
 
-    void Transforms::setInheritScale(bool bInherit)
+    uint64_t SharedExportReader::getLastFrame() const
     {
-        m_bInheritScale = bInherit;
-        needUpdate();
+        assert(isValid());
+        return m_header->lastFrame.load(std::memory_order_acquire);
     }
 
     //-----------------------------------------------------------------------
 
-    vec3 Transforms::getWorldScale()
+    bool SharedExportReader::read(std::vector<float>& values, uint64_t& frame,
+                                  size_t maxRetries) const
     {
-        if (m_bDirty)
-            update();
+        assert(isValid());
 
-        return m_fullScale;
-    }
+        const size_t valuesPerNode = getValuesPerNode();
 
+        exported_frame_t exported;
 
-    /********************************* PRIVATE METHODS **********************************/
+        for (size_t attempt = 0; attempt <= maxRetries; ++attempt)
+        {
+            if (!beginRead(exported, maxRetries - attempt))
+                return false;
 
-    void Transforms::needUpdate()
-    {
-        m_bDirty = true;
+            values.resize(exported.nbNodes * valuesPerNode);
+            std::memcpy(values.data(), exported.values, values.size() * sizeof(float));
 
-        for (Transforms* child : m_children)
-            child->needUpdate();
+            if (endRead(exported))
+            {
+                frame = exported.frame;
+                return true;
+            }
+        }
+
+        return false;
     }
 
     //-----------------------------------------------------------------------
 
-    void Transforms::update()
+    bool SharedExportReader::beginRead(exported_frame_t& frame, size_t maxRetries) const
     {
-        if (!m_bDirty)
-            return;
+        typedef SharedExportWriter::slot_t slot_t;
 
-        if (m_parent)
+        assert(isValid());
+
+        for (size_t attempt = 0; attempt <= maxRetries; ++attempt)
         {
-            // Update orientation
-            const quat& parentOrientation = m_parent->getWorldOrientation();
-            if (m_bInheritOrientation)
-            {
-                // Combine orientation with that of parent
-                m_fullOrientation = KNM_TRANSFORMS_TREE_NORMALISE(parentOrientation * m_orientation);
-            }
-            else
-            {
-                // No inheritence
-                m_fullOrientation = m_orientation;
-            }
+            uint64_t last = m_header->lastFrame.load(std::memory_order_acquire);
+            if (last == 0)
+                return false;
 
-            // Update scale
-            const vec3& parentScale = m_parent->getWorldScale();
-            if (m_bInheritScale)
-            {
-                // Scale own position by parent scale, NB just combine
-                // as equivalent axes, no shearing
-                m_fullScale = parentScale * m_scale;
-            }
-            else
-            {
-                // No inheritence
-                m_fullScale = m_scale;
-            }
+            const slot_t* slot = reinterpret_cast<const slot_t*>(
+                m_slots + (last % m_header->nbSlots) * m_header->slotSize
+            );
 
-            // Change position vector based on parent's orientation & scale
-            m_fullPosition = parentOrientation * (parentScale * m_position);
+            uint64_t sequence = slot->sequence.load(std::memory_order_acquire);
+            if (sequence & 1)
+                continue;
 
-            // Add altered position vector to parents
-            m_fullPosition += m_parent->getWorldPosition();
-        }
-        else
-        {
-            // No parent
-            m_fullPosition      = m_position;
-            m_fullOrientation   = m_orientation;
-            m_fullScale         = m_scale;
+            // Already overwritten by a more recent frame (only valid if the sequence
+            // doesn't change until endRead())
+            if (slot->frame != last)
+                continue;
+
+            frame.frame = last;
+            frame.values = reinterpret_cast<const float*>(slot + 1);
+            frame.nbNodes = std::min(slot->nbNodes, m_header->capacity);
+            frame.slot = slot;
+            frame.sequence = sequence;
+
+            return true;
         }
 
-        m_bDirty = false;
+        return false;
     }
 
+    //-----------------------------------------------------------------------
 
-    /************************************** MATH ****************************************/
-
-    quat Math::getRotationTo(const vec3& from, const vec3& dest,
-                             const vec3& fallbackAxis)
+    bool SharedExportReader::endRead(const exported_frame_t& frame) const
     {
-        // Based on Stan Melax's article in Game Programming Gems
-        quat q;
-        vec3 v0 = KNM_TRANSFORMS_TREE_NORMALISE(from);
-        vec3 v1 = KNM_TRANSFORMS_TREE_NORMALISE(dest);
-
-        real d = KNM_TRANSFORMS_TREE_DOT(v0, v1);
-        // If dot == 1, vectors are the same
-        if (d >= 1.0f)
-        {
-            return QUAT_IDENTITY;
-        }
-        if (d < (1e-6f - 1.0f))
-        {
-            if (fallbackAxis != VEC3_ZERO)
-            {
-                // rotate 180 degrees about the fallback axis
-                q = KNM_TRANSFORMS_TREE_ANGLE_AXIS(PI, fallbackAxis);
-            }
-            else
-            {
-                // Generate an axis
-                vec3 axis = KNM_TRANSFORMS_TREE_CROSS(VEC3_UNIT_X, from);
-                if (KNM_TRANSFORMS_TREE_SQUARED_LENGTH(axis) < 1e-6f) // pick another if colinear
-                    axis = KNM_TRANSFORMS_TREE_CROSS(VEC3_UNIT_Y, from);
-                axis = KNM_TRANSFORMS_TREE_NORMALISE(axis);
-                q = KNM_TRANSFORMS_TREE_ANGLE_AXIS(PI, axis);
-            }
-        }
-        else
-        {
-            real s = sqrt((1.0f + d) * 2.0f);
-            real invs = 1.0f / s;
-
-            vec3 c = KNM_TRANSFORMS_TREE_CROSS(v0, v1);
+        typedef SharedExportWriter::slot_t slot_t;
 
-            q.x = c.x * invs;
-            q.y = c.y * invs;
-            q.z = c.z * invs;
-            q.w = s * 0.5f;
+        const slot_t* slot = static_cast<const slot_t*>(frame.slot);
 
-            q = KNM_TRANSFORMS_TREE_NORMALISE(q);
-        }
+        // The frame is consistent only if the slot wasn't modified meanwhile
+        std::atomic_thread_fence(std::memory_order_acquire);
 
-        return q;
+        return (slot->sequence.load(std::memory_order_relaxed) == frame.sequence);
     }
 
+    #undef KNM_TRANSFORMS_TREE_RESTRICT
+
 #endif // KNM_TRANSFORMS_TREE_IMPLEMENTATION
 
 
@@ -0,0 +1,87 @@
+#include <catch.hpp>
+#include "common.h"
+
+using namespace knm::tr2;
+
+
+TEST_CASE( "Animation clip keys", "[animation]" )
+{
+    AnimationClip clip(2, 3, 10.0f);
+
+    REQUIRE( clip.getNbTracks() == 2 );
+    REQUIRE( clip.getNbKeys() == 3 );
+    REQUIRE( clip.getDuration() == Approx(0.2f) );
+
+    pose_t key = clip.getKey(1, 2);
+    REQUIRE( equals(key.position, VEC3_ZERO) );
+    REQUIRE( equals(key.orientation, QUAT_IDENTITY) );
+    REQUIRE( equals(key.scale, VEC3_UNIT_SCALE) );
+
+    quat orientation = KNM_TRANSFORMS_TREE_ANGLE_AXIS(0.5f, VEC3_UNIT_Y);
+    clip.setKey(1, 2, makePose(vec3(1.0f, 2.0f, 3.0f), orientation, vec3(2.0f, 3.0f, 4.0f)));
+
+    key = clip.getKey(1, 2);
+    REQUIRE( equals(key.position, vec3(1.0f, 2.0f, 3.0f)) );
+    REQUIRE( equals(key.orientation, orientation) );
+    REQUIRE( equals(key.scale, vec3(2.0f, 3.0f, 4.0f)) );
+
+    key = clip.getKey(0, 2);
+    REQUIRE( equals(key.position, VEC3_ZERO) );
+}
+
+
+TEST_CASE( "Animation sampling", "[animation]" )
+{
+    AnimationClip clip(3, 2, 1.0f);
+
+    quat orientation = KNM_TRANSFORMS_TREE_ANGLE_AXIS(1.0f, VEC3_UNIT_Y);
+
+    clip.setKey(0, 1, makePose(vec3(10.0f, 0.0f, 0.0f), QUAT_IDENTITY, VEC3_UNIT_SCALE));
+    clip.setKey(1, 1, makePose(VEC3_ZERO, orientation, vec3(3.0f, 3.0f, 3.0f)));
+    clip.setKey(2, 1, makePose(vec3(0.0f, 5.0f, 0.0f), QUAT_IDENTITY, VEC3_UNIT_SCALE));
+
+    Transforms root;
+    Transforms child;
+    child.setParent(&root);
+
+    // The third track isn't bound
+    Transforms* nodes[3] = { &root, &child, nullptr };
+
+    AnimationSampler sampler(&clip, nodes);
+    REQUIRE( sampler.getNbBound() == 2 );
+
+    sampler.sample(0.5f, false);
+
+    REQUIRE( equals(root.getPosition(), vec3(5.0f, 0.0f, 0.0f)) );
+    REQUIRE( equals(child.getScale(), vec3(2.0f, 2.0f, 2.0f)) );
+    REQUIRE( equals(child.getOrientation(), KNM_TRANSFORMS_TREE_ANGLE_AXIS(0.5f, VEC3_UNIT_Y)) );
+    REQUIRE( equals(child.getWorldPosition(), vec3(5.0f, 0.0f, 0.0f)) );
+
+    // Clamped to the end of the clip
+    sampler.sample(3.0f, false);
+    REQUIRE( equals(root.getPosition(), vec3(10.0f, 0.0f, 0.0f)) );
+
+    // Wrapped around the clip
+    sampler.sample(2.25f, true);
+    REQUIRE( equals(root.getPosition(), vec3(2.5f, 0.0f, 0.0f)) );
+
+    sampler.sample(-0.25f, true);
+    REQUIRE( equals(root.getPosition(), vec3(7.5f, 0.0f, 0.0f)) );
+}
+
+
+TEST_CASE( "Animation sampling uses the shortest path", "[animation]" )
+{
+    AnimationClip clip(1, 2, 1.0f);
+
+    quat orientation = KNM_TRANSFORMS_TREE_ANGLE_AXIS(0.5f, VEC3_UNIT_Y);
+
+    clip.setKey(0, 0, makePose(VEC3_ZERO, QUAT_IDENTITY, VEC3_UNIT_SCALE));
+    clip.setKey(0, 1, makePose(VEC3_ZERO, -orientation, VEC3_UNIT_SCALE));
+
+    real values[AnimationClip::NB_COMPONENTS];
+    clip.sample(0.5f, false, values);
+
+    quat result(values[6], values[3], values[4], values[5]);
+    REQUIRE( equals(result, KNM_TRANSFORMS_TREE_ANGLE_AXIS(0.25f, VEC3_UNIT_Y)) );
+}
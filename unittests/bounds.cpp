@@ -0,0 +1,171 @@
+#include <catch.hpp>
+#include "common.h"
+
+using namespace knm::tr2;
+
+
+TEST_CASE( "No bounds by default", "[bounds]" )
+{
+    Transforms t;
+
+    REQUIRE( !t.hasBounds() );
+    REQUIRE( t.getLocalBounds().isEmpty() );
+    REQUIRE( t.getWorldBounds().isEmpty() );
+    REQUIRE( t.getSubtreeBounds().isEmpty() );
+}
+
+
+TEST_CASE( "World bounds", "[bounds]" )
+{
+    Transforms p;
+    Transforms c;
+
+    c.setParent(&p);
+
+    c.setLocalBounds(aabb_t(vec3(-1.0f, -2.0f, -3.0f), vec3(1.0f, 2.0f, 3.0f)));
+
+    REQUIRE( c.hasBounds() );
+    REQUIRE( equals(vec3(-1.0f, -2.0f, -3.0f), c.getWorldBounds().min) );
+    REQUIRE( equals(vec3(1.0f, 2.0f, 3.0f), c.getWorldBounds().max) );
+
+    p.setPosition(10.0f, 0.0f, 0.0f);
+    p.setOrientation(KNM_TRANSFORMS_TREE_ANGLE_AXIS(PI / 2.0f, VEC3_UNIT_Y));
+    p.setScale(2.0f);
+
+    REQUIRE( equals(vec3(4.0f, -4.0f, -2.0f), c.getWorldBounds().min) );
+    REQUIRE( equals(vec3(16.0f, 4.0f, 2.0f), c.getWorldBounds().max) );
+
+    c.clearLocalBounds();
+
+    REQUIRE( !c.hasBounds() );
+    REQUIRE( c.getWorldBounds().isEmpty() );
+}
+
+
+TEST_CASE( "World bounds with a negative scale", "[bounds]" )
+{
+    Transforms p;
+    Transforms c;
+
+    c.setParent(&p);
+    c.setLocalBounds(aabb_t(vec3(0.0f, -1.0f, -1.0f), vec3(2.0f, 1.0f, 1.0f)));
+
+    p.setScale(vec3(-1.0f, 1.0f, 1.0f));
+
+    REQUIRE( !c.getWorldBounds().isEmpty() );
+    REQUIRE( equals(vec3(-2.0f, -1.0f, -1.0f), c.getWorldBounds().min) );
+    REQUIRE( equals(vec3(0.0f, 1.0f, 1.0f), c.getWorldBounds().max) );
+
+    REQUIRE( !p.getSubtreeBounds().isEmpty() );
+    REQUIRE( equals(vec3(-2.0f, -1.0f, -1.0f), p.getSubtreeBounds().min) );
+
+    std::vector<Transforms*> found;
+    REQUIRE( p.findInBox(aabb_t(vec3(-1.5f, -0.5f, -0.5f), vec3(-1.0f, 0.5f, 0.5f)), found) == 1 );
+}
+
+
+TEST_CASE( "Subtree bounds", "[bounds]" )
+{
+    Transforms a;
+    Transforms b;
+    Transforms c;
+    Transforms d;
+
+    b.setParent(&a);
+    c.setParent(&b);
+    d.setParent(&a);
+
+    aabb_t unit(vec3(-1.0f, -1.0f, -1.0f), vec3(1.0f, 1.0f, 1.0f));
+
+    c.setLocalBounds(unit);
+    d.setLocalBounds(unit);
+
+    b.setPosition(10.0f, 0.0f, 0.0f);
+    d.setPosition(0.0f, -10.0f, 0.0f);
+
+    REQUIRE( equals(vec3(-1.0f, -11.0f, -1.0f), a.getSubtreeBounds().min) );
+    REQUIRE( equals(vec3(11.0f, 1.0f, 1.0f), a.getSubtreeBounds().max) );
+    REQUIRE( equals(vec3(9.0f, -1.0f, -1.0f), b.getSubtreeBounds().min) );
+    REQUIRE( equals(vec3(11.0f, 1.0f, 1.0f), b.getSubtreeBounds().max) );
+
+    SECTION("after a modification deep in the hierarchy")
+    {
+        c.setPosition(0.0f, 0.0f, 20.0f);
+
+        REQUIRE( equals(vec3(-1.0f, -11.0f, -1.0f), a.getSubtreeBounds().min) );
+        REQUIRE( equals(vec3(11.0f, 1.0f, 21.0f), a.getSubtreeBounds().max) );
+    }
+
+    SECTION("after a modification of the root")
+    {
+        a.setPosition(0.0f, 100.0f, 0.0f);
+
+        REQUIRE( equals(vec3(-1.0f, 89.0f, -1.0f), a.getSubtreeBounds().min) );
+        REQUIRE( equals(vec3(11.0f, 101.0f, 1.0f), a.getSubtreeBounds().max) );
+    }
+
+    SECTION("after a change of bounds")
+    {
+        c.setLocalBounds(aabb_t(vec3(-5.0f, -5.0f, -5.0f), vec3(5.0f, 5.0f, 5.0f)));
+
+        REQUIRE( equals(vec3(-1.0f, -11.0f, -5.0f), a.getSubtreeBounds().min) );
+        REQUIRE( equals(vec3(15.0f, 5.0f, 5.0f), a.getSubtreeBounds().max) );
+    }
+
+    SECTION("after a change of parent")
+    {
+        Transforms e;
+        c.setParent(&e);
+
+        REQUIRE( equals(vec3(-1.0f, -11.0f, -1.0f), a.getSubtreeBounds().min) );
+        REQUIRE( equals(vec3(1.0f, -9.0f, 1.0f), a.getSubtreeBounds().max) );
+
+        REQUIRE( equals(vec3(-1.0f, -1.0f, -1.0f), e.getSubtreeBounds().min) );
+        REQUIRE( equals(vec3(1.0f, 1.0f, 1.0f), e.getSubtreeBounds().max) );
+
+        c.setParent(nullptr);
+    }
+}
+
+
+TEST_CASE( "Find by bounds", "[bounds]" )
+{
+    Transforms a;
+    Transforms b;
+    Transforms c;
+    Transforms d;
+
+    b.setParent(&a);
+    c.setParent(&b);
+    d.setParent(&a);
+
+    aabb_t unit(vec3(-1.0f, -1.0f, -1.0f), vec3(1.0f, 1.0f, 1.0f));
+
+    b.setLocalBounds(unit);
+    c.setLocalBounds(unit);
+    d.setLocalBounds(unit);
+
+    b.setPosition(10.0f, 0.0f, 0.0f);
+    c.setPosition(5.0f, 0.0f, 0.0f);
+    d.setPosition(0.0f, -10.0f, 0.0f);
+
+    std::vector<Transforms*> result;
+
+    SECTION("in box")
+    {
+        REQUIRE( a.findInBox(aabb_t(vec3(12.0f, -1.0f, -1.0f), vec3(20.0f, 1.0f, 1.0f)), result) == 1 );
+        REQUIRE( result[0] == &c );
+
+        REQUIRE( a.findInBox(aabb_t(vec3(-20.0f, -20.0f, -20.0f), vec3(20.0f, 20.0f, 20.0f)), result) == 3 );
+
+        REQUIRE( a.findInBox(aabb_t(vec3(100.0f, 100.0f, 100.0f), vec3(200.0f, 200.0f, 200.0f)), result) == 0 );
+    }
+
+    SECTION("in sphere")
+    {
+        REQUIRE( a.findInSphere(vec3(0.0f, -8.0f, 0.0f), 1.5f, result) == 1 );
+        REQUIRE( result[0] == &d );
+
+        REQUIRE( a.findInSphere(vec3(12.5f, 0.0f, 0.0f), 2.0f, result) == 2 );
+    }
+}
@@ -0,0 +1,346 @@
+#include <catch.hpp>
+#include "common.h"
+
+using namespace knm::tr2;
+
+
+TEST_CASE( "Update pass", "[change_log]" )
+{
+    Transforms a;
+    Transforms b;
+    Transforms c;
+    Transforms d;
+
+    b.setParent(&a);
+    c.setParent(&b);
+    d.setParent(&a);
+
+    std::vector<Transforms*> changed;
+
+    // Everything changed at creation
+    REQUIRE( a.updateHierarchy(changed) == 4 );
+    REQUIRE( changed[0] == &a );
+
+    changed.clear();
+    REQUIRE( a.updateHierarchy(changed) == 0 );
+
+    c.setPosition(vec3(1.0f, 0.0f, 0.0f));
+
+    REQUIRE( a.updateHierarchy(changed) == 1 );
+    REQUIRE( changed[0] == &c );
+
+    changed.clear();
+    b.translate(vec3(0.0f, 2.0f, 0.0f));
+
+    REQUIRE( a.updateHierarchy(changed) == 2 );
+    REQUIRE( changed[0] == &b );
+    REQUIRE( changed[1] == &c );
+    REQUIRE( equals(c.getWorldPosition(), vec3(1.0f, 2.0f, 0.0f)) );
+
+    // Reparenting
+    changed.clear();
+    c.setParent(&d);
+
+    REQUIRE( a.updateHierarchy(changed) == 1 );
+    REQUIRE( changed[0] == &c );
+}
+
+
+TEST_CASE( "Update pass with values read in-between", "[change_log]" )
+{
+    Transforms a;
+    Transforms b;
+
+    b.setParent(&a);
+
+    std::vector<Transforms*> changed;
+    a.updateHierarchy(changed);
+
+    // Reading the world transforms doesn't hide the modification
+    a.setPosition(vec3(0.0f, 0.0f, 5.0f));
+    REQUIRE( equals(b.getWorldPosition(), vec3(0.0f, 0.0f, 5.0f)) );
+
+    changed.clear();
+    REQUIRE( a.updateHierarchy(changed) == 2 );
+}
+
+
+TEST_CASE( "Change log frames", "[change_log]" )
+{
+    Transforms a;
+    Transforms b;
+
+    b.setParent(&a);
+
+    ChangeLog log;
+    log.track(&a);
+
+    REQUIRE( log.getFrame() == 0 );
+    REQUIRE( log.getChanges().empty() );
+
+    REQUIRE( log.update() == 1 );
+    REQUIRE( log.getChanges().size() == 2 );
+
+    REQUIRE( log.update() == 2 );
+    REQUIRE( log.getChanges().empty() );
+
+    b.setScale(2.0f);
+
+    REQUIRE( log.update() == 3 );
+    REQUIRE( log.getChanges().size() == 1 );
+    REQUIRE( log.getChanges()[0] == &b );
+
+    log.untrack(&a);
+    b.setScale(3.0f);
+
+    REQUIRE( log.update() == 4 );
+    REQUIRE( log.getChanges().empty() );
+}
+
+
+TEST_CASE( "Change log consumers", "[change_log]" )
+{
+    Transforms a;
+    Transforms b;
+    Transforms c;
+
+    b.setParent(&a);
+    c.setParent(&a);
+
+    ChangeLog log(2);
+    log.track(&a);
+    log.update();
+
+    size_t consumer1 = log.addConsumer();
+    size_t consumer2 = log.addConsumer();
+
+    REQUIRE( consumer1 != consumer2 );
+    REQUIRE( log.getCursor(consumer1) == 1 );
+
+    std::vector<Transforms*> changed;
+
+    REQUIRE( log.read(consumer1, changed) == 0 );
+
+    b.translate(vec3(1.0f, 0.0f, 0.0f));
+    log.update();
+
+    REQUIRE( log.read(consumer1, changed) == 1 );
+    REQUIRE( changed[0] == &b );
+    REQUIRE( log.getCursor(consumer1) == 2 );
+
+    b.translate(vec3(1.0f, 0.0f, 0.0f));
+    c.translate(vec3(1.0f, 0.0f, 0.0f));
+    log.update();
+
+    // Changes from several frames are merged
+    REQUIRE( log.read(consumer2, changed) == 2 );
+    REQUIRE( std::find(changed.begin(), changed.end(), &b) != changed.end() );
+    REQUIRE( std::find(changed.begin(), changed.end(), &c) != changed.end() );
+
+    REQUIRE( log.read(consumer1, changed) == 2 );
+
+    // A consumer too far behind retrieves everything
+    log.update();
+    log.update();
+    log.update();
+
+    REQUIRE( log.read(consumer1, changed) == 3 );
+
+    log.removeConsumer(consumer2);
+    REQUIRE( log.addConsumer() == consumer2 );
+    REQUIRE( log.getCursor(consumer2) == log.getFrame() );
+}
+
+
+class TestListener : public ChangeListener
+{
+public:
+    virtual void onWorldTransformsChanged(const std::vector<Transforms*>& changed)
+    {
+        ++nbCalls;
+        received = changed;
+    }
+
+    size_t nbCalls = 0;
+    std::vector<Transforms*> received;
+};
+
+
+TEST_CASE( "Change listeners on Transforms", "[change_log]" )
+{
+    Transforms a;
+    Transforms b;
+    Transforms c;
+
+    b.setParent(&a);
+    c.setParent(&a);
+
+    ChangeLog log;
+    log.track(&a);
+    log.update();
+
+    TestListener listener;
+    log.addListener(&listener, &b);
+    log.addListener(&listener, &c);
+
+    log.update();
+    REQUIRE( listener.nbCalls == 0 );
+
+    b.translate(vec3(1.0f, 0.0f, 0.0f));
+    c.translate(vec3(1.0f, 0.0f, 0.0f));
+    log.update();
+
+    // One call for all the changes
+    REQUIRE( listener.nbCalls == 1 );
+    REQUIRE( listener.received.size() == 2 );
+
+    log.removeListener(&listener, &b);
+    b.translate(vec3(1.0f, 0.0f, 0.0f));
+    log.update();
+
+    REQUIRE( listener.nbCalls == 1 );
+
+    log.removeListener(&listener);
+    c.translate(vec3(1.0f, 0.0f, 0.0f));
+    log.update();
+
+    REQUIRE( listener.nbCalls == 1 );
+}
+
+
+TEST_CASE( "Change listeners on subtrees", "[change_log]" )
+{
+    Transforms a;
+    Transforms b;
+    Transforms c;
+    Transforms d;
+
+    b.setParent(&a);
+    c.setParent(&b);
+    d.setParent(&a);
+
+    ChangeLog log;
+    log.track(&a);
+    log.update();
+
+    TestListener listener1;
+    TestListener listener2;
+    log.addListener(&listener1, &b, true);
+    log.addListener(&listener1, &c);
+    log.addListener(&listener2, &b);
+
+    b.translate(vec3(1.0f, 0.0f, 0.0f));
+    d.translate(vec3(1.0f, 0.0f, 0.0f));
+    log.update();
+
+    REQUIRE( listener1.nbCalls == 1 );
+    REQUIRE( listener1.received.size() == 2 );
+    REQUIRE( listener1.received[0] == &b );
+    REQUIRE( listener1.received[1] == &c );
+
+    REQUIRE( listener2.nbCalls == 1 );
+    REQUIRE( listener2.received.size() == 1 );
+    REQUIRE( listener2.received[0] == &b );
+
+    c.translate(vec3(1.0f, 0.0f, 0.0f));
+    log.update();
+
+    REQUIRE( listener1.nbCalls == 2 );
+    REQUIRE( listener1.received.size() == 1 );
+    REQUIRE( listener2.nbCalls == 1 );
+}
+
+
+TEST_CASE( "Change listeners on subtrees after reparenting", "[change_log]" )
+{
+    Transforms a;
+    Transforms b;
+    Transforms c;
+    Transforms d;
+
+    b.setParent(&a);
+    c.setParent(&a);
+    d.setParent(&c);
+
+    ChangeLog log;
+    log.track(&a);
+    log.update();
+
+    TestListener listener1;
+    TestListener listener2;
+    log.addListener(&listener1, &b, true);
+    log.addListener(&listener2, &d);
+
+    // Moved into the subscribed subtree, with its child
+    c.setParent(&b);
+    log.update();
+
+    REQUIRE( listener1.nbCalls == 1 );
+    REQUIRE( listener1.received.size() == 2 );
+    REQUIRE( listener1.received[0] == &c );
+    REQUIRE( listener1.received[1] == &d );
+
+    REQUIRE( listener2.nbCalls == 1 );
+    REQUIRE( listener2.received.size() == 1 );
+
+    // Moved out of it
+    c.setParent(&a);
+    log.update();
+
+    REQUIRE( listener1.nbCalls == 1 );
+    REQUIRE( listener2.nbCalls == 2 );
+
+    // Subscription changed to only the Transforms
+    c.setParent(&b);
+    log.addListener(&listener1, &b, false);
+    log.update();
+
+    REQUIRE( listener1.nbCalls == 1 );
+    REQUIRE( listener2.nbCalls == 3 );
+
+    // Slot of a removed listener reused
+    log.removeListener(&listener1);
+    log.addListener(&listener1, &d);
+    d.translate(vec3(1.0f, 0.0f, 0.0f));
+    log.update();
+
+    REQUIRE( listener1.nbCalls == 2 );
+    REQUIRE( listener1.received.size() == 1 );
+    REQUIRE( listener1.received[0] == &d );
+    REQUIRE( listener2.nbCalls == 4 );
+}
+
+
+TEST_CASE( "Change listeners on built hierarchies", "[change_log]" )
+{
+    Transforms nodes[3];
+    Transforms* pointers[3] = { &nodes[0], &nodes[1], &nodes[2] };
+    int32_t parents[3] = { -1, 0, 1 };
+
+    pose_t poses[3];
+    for (int i = 0; i < 3; ++i)
+    {
+        poses[i].position = VEC3_ZERO;
+        poses[i].orientation = QUAT_IDENTITY;
+        poses[i].scale = VEC3_UNIT_SCALE;
+    }
+
+    ChangeLog log;
+    log.track(&nodes[0]);
+
+    TestListener listener;
+    log.addListener(&listener, &nodes[0], true);
+
+    REQUIRE( Transforms::buildHierarchy(pointers, parents, poses, 3) );
+    log.update();
+
+    REQUIRE( listener.nbCalls == 1 );
+    REQUIRE( listener.received.size() == 3 );
+
+    nodes[2].translate(vec3(1.0f, 0.0f, 0.0f));
+    log.update();
+
+    REQUIRE( listener.nbCalls == 2 );
+    REQUIRE( listener.received.size() == 1 );
+    REQUIRE( listener.received[0] == &nodes[2] );
+}
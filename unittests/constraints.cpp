@@ -0,0 +1,272 @@
+#include <catch.hpp>
+#include "common.h"
+
+using namespace knm::tr2;
+
+
+TEST_CASE( "Position constraint", "[constraints]" )
+{
+    Transforms a;
+    Transforms b;
+    Transforms parent;
+    Transforms constrained;
+
+    a.setPosition(vec3(4.0f, 0.0f, 0.0f));
+    b.setPosition(vec3(0.0f, 8.0f, 0.0f));
+    parent.setPosition(vec3(1.0f, 1.0f, 1.0f));
+    constrained.setParent(&parent);
+
+    ConstraintSolver solver;
+
+    Transforms* targets[2] = { &a, &b };
+    real weights[2] = { 3.0f, 1.0f };
+    solver.addPositionConstraint(&constrained, targets, weights, 2);
+
+    REQUIRE( solver.getNbConstraints() == 1 );
+    REQUIRE( solver.hasConstraint(&constrained) );
+    REQUIRE( solver.evaluate() );
+
+    REQUIRE( equals(constrained.getWorldPosition(), vec3(3.0f, 2.0f, 0.0f)) );
+    REQUIRE( equals(constrained.getPosition(), vec3(2.0f, 1.0f, -1.0f)) );
+
+    solver.removeConstraint(&constrained);
+    REQUIRE( solver.getNbConstraints() == 0 );
+    REQUIRE( !solver.hasConstraint(&constrained) );
+}
+
+
+TEST_CASE( "Constraints with a total weight of 0", "[constraints]" )
+{
+    Transforms a;
+    Transforms b;
+    Transforms constrained;
+
+    a.setPosition(vec3(4.0f, 0.0f, 0.0f));
+    a.setOrientation(KNM_TRANSFORMS_TREE_ANGLE_AXIS(1.0f, VEC3_UNIT_Y));
+    b.setPosition(vec3(0.0f, 8.0f, 0.0f));
+    constrained.setPosition(vec3(1.0f, 2.0f, 3.0f));
+    constrained.setOrientation(KNM_TRANSFORMS_TREE_ANGLE_AXIS(0.5f, VEC3_UNIT_X));
+
+    ConstraintSolver solver;
+
+    Transforms* targets[2] = { &a, &b };
+    real weights[2] = { 0.0f, 0.0f };
+
+    // The Transforms is left untouched
+    solver.addPositionConstraint(&constrained, targets, weights, 2);
+    REQUIRE( solver.evaluate() );
+    REQUIRE( equals(constrained.getWorldPosition(), vec3(1.0f, 2.0f, 3.0f)) );
+
+    solver.addOrientationConstraint(&constrained, targets, weights, 2);
+    REQUIRE( solver.evaluate() );
+    REQUIRE( equals(constrained.getWorldOrientation(), KNM_TRANSFORMS_TREE_ANGLE_AXIS(0.5f, VEC3_UNIT_X)) );
+
+    solver.addParentConstraint(&constrained, targets, weights, 2);
+    a.translate(vec3(1.0f, 0.0f, 0.0f));
+    REQUIRE( solver.evaluate() );
+    REQUIRE( equals(constrained.getWorldPosition(), vec3(1.0f, 2.0f, 3.0f)) );
+    REQUIRE( equals(constrained.getWorldScale(), VEC3_UNIT_SCALE) );
+}
+
+
+TEST_CASE( "Orientation constraint", "[constraints]" )
+{
+    Transforms a;
+    Transforms b;
+    Transforms constrained;
+
+    a.setOrientation(KNM_TRANSFORMS_TREE_ANGLE_AXIS(1.0f, VEC3_UNIT_Y));
+    b.setOrientation(-KNM_TRANSFORMS_TREE_ANGLE_AXIS(0.0f, VEC3_UNIT_Y));
+
+    ConstraintSolver solver;
+
+    Transforms* targets[2] = { &a, &b };
+    solver.addOrientationConstraint(&constrained, targets, nullptr, 2);
+    solver.evaluate();
+
+    REQUIRE( equals(constrained.getWorldOrientation(), KNM_TRANSFORMS_TREE_ANGLE_AXIS(0.5f, VEC3_UNIT_Y)) );
+}
+
+
+TEST_CASE( "Aim constraint", "[constraints]" )
+{
+    Transforms target;
+    Transforms constrained;
+
+    target.setPosition(vec3(5.0f, 0.0f, 0.0f));
+    constrained.setPosition(vec3(0.0f, 0.0f, 0.0f));
+
+    ConstraintSolver solver;
+    solver.addAimConstraint(&constrained, &target);
+    solver.evaluate();
+
+    quat orientation = constrained.getWorldOrientation();
+    REQUIRE( equals(orientation * VEC3_NEGATIVE_UNIT_Z, VEC3_UNIT_X) );
+    REQUIRE( equals(orientation * VEC3_UNIT_Y, VEC3_UNIT_Y) );
+
+    target.setPosition(vec3(0.0f, 0.0f, 5.0f));
+    solver.evaluate();
+
+    orientation = constrained.getWorldOrientation();
+    REQUIRE( equals(orientation * VEC3_NEGATIVE_UNIT_Z, VEC3_UNIT_Z) );
+    REQUIRE( equals(orientation * VEC3_UNIT_Y, VEC3_UNIT_Y) );
+}
+
+
+TEST_CASE( "Parent constraint", "[constraints]" )
+{
+    Transforms a;
+    Transforms b;
+    Transforms constrained;
+
+    a.setPosition(vec3(0.0f, 0.0f, 0.0f));
+    b.setPosition(vec3(10.0f, 0.0f, 0.0f));
+    constrained.setPosition(vec3(1.0f, 0.0f, 0.0f));
+
+    ConstraintSolver solver;
+
+    SECTION( "One target" )
+    {
+        Transforms* targets[1] = { &a };
+        solver.addParentConstraint(&constrained, targets, nullptr, 1);
+
+        a.setPosition(vec3(0.0f, 2.0f, 0.0f));
+        a.setOrientation(KNM_TRANSFORMS_TREE_ANGLE_AXIS(1.5707963f, VEC3_UNIT_Z));
+        solver.evaluate();
+
+        REQUIRE( equals(constrained.getWorldPosition(), vec3(0.0f, 3.0f, 0.0f)) );
+        REQUIRE( equals(constrained.getWorldOrientation(), a.getWorldOrientation()) );
+    }
+
+    SECTION( "Weighted targets" )
+    {
+        Transforms* targets[2] = { &a, &b };
+        real weights[2] = { 1.0f, 1.0f };
+        solver.addParentConstraint(&constrained, targets, weights, 2);
+
+        a.setPosition(vec3(0.0f, 2.0f, 0.0f));
+        solver.evaluate();
+
+        REQUIRE( equals(constrained.getWorldPosition(), vec3(1.0f, 1.0f, 0.0f)) );
+    }
+}
+
+
+TEST_CASE( "Constraints dependency order", "[constraints]" )
+{
+    Transforms source;
+    Transforms a;
+    Transforms b;
+    Transforms parent;
+    Transforms child;
+
+    source.setPosition(vec3(3.0f, 0.0f, 0.0f));
+    child.setParent(&parent);
+    child.setPosition(vec3(0.0f, 1.0f, 0.0f));
+
+    ConstraintSolver solver;
+
+    // Registered in the wrong order on purpose
+    Transforms* targetsChild[1] = { &a };
+    solver.addPositionConstraint(&child, targetsChild, nullptr, 1);
+
+    Transforms* targetsA[1] = { &b };
+    solver.addPositionConstraint(&a, targetsA, nullptr, 1);
+
+    Transforms* targetsParent[1] = { &a };
+    solver.addOrientationConstraint(&parent, targetsParent, nullptr, 1);
+
+    Transforms* targetsB[1] = { &source };
+    solver.addPositionConstraint(&b, targetsB, nullptr, 1);
+
+    REQUIRE( solver.evaluate() );
+    REQUIRE( solver.getCyclicTransforms().empty() );
+
+    const std::vector<Transforms*>& order = solver.getEvaluationOrder();
+    REQUIRE( order.size() == 4 );
+
+    auto position = [&order](Transforms* transforms) {
+        return std::find(order.begin(), order.end(), transforms) - order.begin();
+    };
+
+    REQUIRE( position(&b) < position(&a) );
+    REQUIRE( position(&a) < position(&parent) );
+    REQUIRE( position(&parent) < position(&child) );
+
+    REQUIRE( equals(a.getWorldPosition(), vec3(3.0f, 0.0f, 0.0f)) );
+    REQUIRE( equals(child.getWorldPosition(), vec3(3.0f, 0.0f, 0.0f)) );
+}
+
+
+TEST_CASE( "Constraints cycles", "[constraints]" )
+{
+    Transforms a;
+    Transforms b;
+    Transforms c;
+    Transforms free;
+    Transforms other;
+
+    ConstraintSolver solver;
+
+    Transforms* targetsFree[1] = { &other };
+    solver.addPositionConstraint(&free, targetsFree, nullptr, 1);
+
+    SECTION( "Between two Transforms" )
+    {
+        Transforms* targetsA[1] = { &b };
+        solver.addPositionConstraint(&a, targetsA, nullptr, 1);
+
+        Transforms* targetsB[1] = { &a };
+        solver.addPositionConstraint(&b, targetsB, nullptr, 1);
+
+        Transforms* targetsC[1] = { &b };
+        solver.addPositionConstraint(&c, targetsC, nullptr, 1);
+
+        REQUIRE( !solver.evaluate() );
+        REQUIRE( solver.getEvaluationOrder().size() == 1 );
+        REQUIRE( solver.getCyclicTransforms().size() == 3 );
+    }
+
+    SECTION( "Targeting a descendant" )
+    {
+        b.setParent(&a);
+
+        Transforms* targetsA[1] = { &b };
+        solver.addPositionConstraint(&a, targetsA, nullptr, 1);
+
+        REQUIRE( !solver.evaluate() );
+        REQUIRE( solver.getCyclicTransforms().size() == 1 );
+        REQUIRE( solver.getCyclicTransforms()[0] == &a );
+    }
+
+    REQUIRE( solver.getEvaluationOrder()[0] == &free );
+}
+
+
+TEST_CASE( "Constraints evaluated by the update pass", "[constraints]" )
+{
+    Transforms root;
+    Transforms target;
+    Transforms constrained;
+
+    target.setParent(&root);
+    constrained.setParent(&root);
+
+    ChangeLog log;
+    log.track(&root);
+    log.update();
+
+    ConstraintSolver solver;
+    Transforms* targets[1] = { &target };
+    solver.addPositionConstraint(&constrained, targets, nullptr, 1);
+
+    log.setConstraints(&solver);
+    REQUIRE( log.getConstraints() == &solver );
+
+    target.setPosition(vec3(1.0f, 2.0f, 3.0f));
+    log.update();
+
+    const std::vector<Transforms*>& changes = log.getChanges();
+    REQUIRE( std::find(changes.begin(), changes.end(), &constrained) != changes.end() );
+    REQUIRE( equals(constrained.getWorldPosition(), vec3(1.0f, 2.0f, 3.0f)) );
+}
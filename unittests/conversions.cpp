@@ -0,0 +1,167 @@
+#include <catch.hpp>
+#include "common.h"
+
+using namespace knm::tr2;
+
+
+TEST_CASE( "Convert points from world to world", "[conversions]" )
+{
+    std::vector<vec3> in = { vec3(1.0f, 2.0f, 3.0f), vec3(-4.0f, 5.0f, -6.0f) };
+    std::vector<vec3> out;
+
+    Transforms::convertPoints(nullptr, nullptr, in, out);
+
+    REQUIRE( out.size() == 2 );
+    REQUIRE( equals(in[0], out[0]) );
+    REQUIRE( equals(in[1], out[1]) );
+}
+
+
+TEST_CASE( "Convert points between spaces", "[conversions]" )
+{
+    Transforms p;
+    Transforms a;
+    Transforms b;
+
+    a.setParent(&p);
+    b.setParent(&p);
+
+    p.setPosition(10.0f, 0.0f, 0.0f);
+    p.setOrientation(KNM_TRANSFORMS_TREE_ANGLE_AXIS(PI / 2.0f, VEC3_UNIT_Y));
+    p.setScale(2.0f);
+
+    a.setPosition(0.0f, 5.0f, 0.0f);
+    a.setOrientation(KNM_TRANSFORMS_TREE_ANGLE_AXIS(-PI / 4.0f, VEC3_UNIT_X));
+    a.setScale(1.0f, 2.0f, 3.0f);
+
+    b.setPosition(-3.0f, 0.0f, 1.0f);
+    b.setOrientation(KNM_TRANSFORMS_TREE_ANGLE_AXIS(PI / 3.0f, VEC3_UNIT_Z));
+    b.setScale(0.5f, 4.0f, 1.0f);
+
+    std::vector<vec3> in = { vec3(1.0f, 2.0f, 3.0f), vec3(-4.0f, 5.0f, -6.0f) };
+
+    SECTION("from local to world")
+    {
+        std::vector<vec3> out;
+        Transforms::convertPoints(&a, nullptr, in, out);
+
+        for (size_t i = 0; i < in.size(); ++i)
+            REQUIRE( equals(vec3(a.getWorldMatrix() * glm::vec4(in[i], 1.0f)), out[i]) );
+    }
+
+    SECTION("from world to local")
+    {
+        std::vector<vec3> out;
+        Transforms::convertPoints(nullptr, &a, in, out);
+
+        for (size_t i = 0; i < in.size(); ++i)
+            REQUIRE( equals(vec3(glm::inverse(a.getWorldMatrix()) * glm::vec4(in[i], 1.0f)), out[i]) );
+    }
+
+    SECTION("from local to local")
+    {
+        std::vector<vec3> out;
+        Transforms::convertPoints(&a, &b, in, out);
+
+        std::vector<vec3> back;
+        Transforms::convertPoints(&b, &a, out, back);
+
+        for (size_t i = 0; i < in.size(); ++i)
+        {
+            vec3 world = vec3(a.getWorldMatrix() * glm::vec4(in[i], 1.0f));
+            REQUIRE( equals(vec3(b.getWorldMatrix() * glm::vec4(out[i], 1.0f)), world) );
+            REQUIRE( equals(in[i], back[i]) );
+        }
+    }
+
+    SECTION("in place")
+    {
+        std::vector<vec3> out = in;
+        Transforms::convertPoints(&a, &b, out.data(), out.data(), out.size());
+
+        std::vector<vec3> expected;
+        Transforms::convertPoints(&a, &b, in, expected);
+
+        for (size_t i = 0; i < in.size(); ++i)
+            REQUIRE( equals(expected[i], out[i]) );
+    }
+}
+
+
+TEST_CASE( "Convert vectors between spaces", "[conversions]" )
+{
+    Transforms p;
+    Transforms c;
+
+    c.setParent(&p);
+
+    p.setOrientation(KNM_TRANSFORMS_TREE_ANGLE_AXIS(PI / 2.0f, VEC3_UNIT_Y));
+    p.setScale(2.0f, 4.0f, 8.0f);
+    p.setPosition(10.0f, 20.0f, 30.0f);
+
+    std::vector<vec3> in = { vec3(10.0f, 20.0f, 30.0f) };
+    std::vector<vec3> out;
+
+    // Same conversion as the one performed by a translation in world space
+    Transforms::convertVectors(nullptr, &p, in, out);
+
+    c.translate(in[0], TS_WORLD);
+
+    REQUIRE( equals(c.getPosition(), out[0]) );
+    REQUIRE( equals(c.getWorldPosition(), p.getWorldPosition() + in[0]) );
+}
+
+
+TEST_CASE( "Convert directions between spaces", "[conversions]" )
+{
+    Transforms a;
+    Transforms b;
+
+    a.setOrientation(KNM_TRANSFORMS_TREE_ANGLE_AXIS(PI / 2.0f, VEC3_UNIT_Y));
+    a.setScale(2.0f, 4.0f, 8.0f);
+    a.setPosition(10.0f, 20.0f, 30.0f);
+
+    b.setOrientation(KNM_TRANSFORMS_TREE_ANGLE_AXIS(-PI / 2.0f, VEC3_UNIT_Y));
+    b.setScale(3.0f);
+
+    std::vector<vec3> in = { VEC3_NEGATIVE_UNIT_Z, VEC3_UNIT_X };
+    std::vector<vec3> out;
+
+    Transforms::convertDirections(&a, nullptr, in, out);
+
+    REQUIRE( equals(VEC3_NEGATIVE_UNIT_X, out[0]) );
+    REQUIRE( equals(VEC3_NEGATIVE_UNIT_Z, out[1]) );
+
+    Transforms::convertDirections(&a, &b, in, out);
+
+    REQUIRE( equals(VEC3_UNIT_Z, out[0]) );
+    REQUIRE( equals(VEC3_NEGATIVE_UNIT_X, out[1]) );
+}
+
+
+TEST_CASE( "Convert orientations between spaces", "[conversions]" )
+{
+    Transforms p;
+    Transforms a;
+    Transforms b;
+
+    a.setParent(&p);
+    b.setParent(&p);
+
+    p.setOrientation(KNM_TRANSFORMS_TREE_ANGLE_AXIS(PI / 2.0f, VEC3_UNIT_Y));
+    a.setOrientation(KNM_TRANSFORMS_TREE_ANGLE_AXIS(-PI / 4.0f, VEC3_UNIT_X));
+    b.setOrientation(KNM_TRANSFORMS_TREE_ANGLE_AXIS(PI / 3.0f, VEC3_UNIT_Z));
+
+    std::vector<quat> in = { QUAT_IDENTITY, KNM_TRANSFORMS_TREE_ANGLE_AXIS(PI / 5.0f, VEC3_UNIT_X) };
+    std::vector<quat> out;
+
+    Transforms::convertOrientations(&a, nullptr, in, out);
+
+    REQUIRE( equals(a.getWorldOrientation(), out[0]) );
+    REQUIRE( equals(a.getWorldOrientation() * in[1], out[1]) );
+
+    Transforms::convertOrientations(&a, &b, in, out);
+
+    REQUIRE( equals(a.getWorldOrientation() * in[0], b.getWorldOrientation() * out[0]) );
+    REQUIRE( equals(a.getWorldOrientation() * in[1], b.getWorldOrientation() * out[1]) );
+}
@@ -0,0 +1,164 @@
+#include <catch.hpp>
+#include "common.h"
+
+#include <glm/gtc/matrix_transform.hpp>
+
+using namespace knm::tr2;
+
+
+TEST_CASE( "Frustum from view-projection matrix", "[culling]" )
+{
+    Frustum frustum(glm::ortho(-10.0f, 10.0f, -10.0f, 10.0f, -10.0f, 10.0f));
+
+    REQUIRE( frustum.test(aabb_t(vec3(-1.0f, -1.0f, -1.0f), vec3(1.0f, 1.0f, 1.0f))) == FT_INSIDE );
+    REQUIRE( frustum.test(aabb_t(vec3(9.0f, -1.0f, -1.0f), vec3(11.0f, 1.0f, 1.0f))) == FT_INTERSECTS );
+    REQUIRE( frustum.test(aabb_t(vec3(-1.0f, 19.0f, -1.0f), vec3(1.0f, 21.0f, 1.0f))) == FT_OUTSIDE );
+    REQUIRE( frustum.test(aabb_t(vec3(-1.0f, -1.0f, -21.0f), vec3(1.0f, 1.0f, -19.0f))) == FT_OUTSIDE );
+    REQUIRE( frustum.test(aabb_t()) == FT_OUTSIDE );
+}
+
+
+TEST_CASE( "Frustum test of spheres", "[culling]" )
+{
+    vec4 planes[] = {
+        vec4(1.0f, 0.0f, 0.0f, 10.0f), vec4(-1.0f, 0.0f, 0.0f, 10.0f),
+        vec4(0.0f, 1.0f, 0.0f, 10.0f), vec4(0.0f, -1.0f, 0.0f, 10.0f),
+        vec4(0.0f, 0.0f, 2.0f, 20.0f), vec4(0.0f, 0.0f, -2.0f, 20.0f),
+    };
+
+    Frustum frustum(planes);
+
+    REQUIRE( equals(vec3(0.0f, 0.0f, 1.0f), vec3(frustum.getPlane(4))) );
+    REQUIRE( frustum.getPlane(4).w == 10.0f );
+
+    // More than one batch
+    const size_t count = 11;
+    real x[count];
+    real y[count];
+    real z[count];
+    real radius[count];
+
+    for (size_t i = 0; i < count; ++i)
+    {
+        x[i] = real(i) * 2.0f;
+        y[i] = 0.0f;
+        z[i] = 0.0f;
+        radius[i] = 1.5f;
+    }
+
+    frustum_test_t results[count];
+    frustum.testSpheres(x, y, z, radius, count, results);
+
+    for (size_t i = 0; i < 5; ++i)
+        REQUIRE( results[i] == FT_INSIDE );
+
+    REQUIRE( results[5] == FT_INTERSECTS );
+
+    for (size_t i = 6; i < count; ++i)
+        REQUIRE( results[i] == FT_OUTSIDE );
+}
+
+
+TEST_CASE( "Frustum culling of a hierarchy", "[culling]" )
+{
+    Frustum frustum(glm::ortho(-10.0f, 10.0f, -10.0f, 10.0f, -10.0f, 10.0f));
+
+    aabb_t unit(vec3(-1.0f, -1.0f, -1.0f), vec3(1.0f, 1.0f, 1.0f));
+
+    Transforms root;
+    Transforms inside;
+    Transforms outside;
+    Transforms border;
+    Transforms insideChild;
+    Transforms outsideChild;
+
+    inside.setParent(&root);
+    outside.setParent(&root);
+    border.setParent(&root);
+    insideChild.setParent(&inside);
+    outsideChild.setParent(&outside);
+
+    inside.setLocalBounds(unit);
+    outside.setLocalBounds(unit);
+    border.setLocalBounds(unit);
+    insideChild.setLocalBounds(unit);
+    outsideChild.setLocalBounds(unit);
+
+    inside.setPosition(-3.0f, 0.0f, 0.0f);
+    insideChild.setPosition(0.0f, 2.0f, 0.0f);
+    outside.setPosition(50.0f, 0.0f, 0.0f);
+    border.setPosition(0.0f, 0.0f, 10.0f);
+
+    std::vector<Transforms*> visible;
+
+    REQUIRE( frustum.cull(&root, visible) == 3 );
+    REQUIRE( std::find(visible.begin(), visible.end(), &inside) != visible.end() );
+    REQUIRE( std::find(visible.begin(), visible.end(), &insideChild) != visible.end() );
+    REQUIRE( std::find(visible.begin(), visible.end(), &border) != visible.end() );
+
+    SECTION("after moving a branch")
+    {
+        outside.setPosition(0.0f, -5.0f, 0.0f);
+
+        REQUIRE( frustum.cull(&root, visible) == 5 );
+    }
+
+    SECTION("after moving the root")
+    {
+        root.setPosition(100.0f, 0.0f, 0.0f);
+
+        REQUIRE( frustum.cull(&root, visible) == 0 );
+    }
+}
+
+
+TEST_CASE( "Frustum culling of a hierarchy without bounds", "[culling]" )
+{
+    Frustum frustum(glm::ortho(-10.0f, 10.0f, -10.0f, 10.0f, -10.0f, 10.0f));
+
+    Transforms root;
+    Transforms child;
+
+    child.setParent(&root);
+
+    std::vector<Transforms*> visible;
+
+    REQUIRE( frustum.cull(&root, visible) == 0 );
+}
+
+
+TEST_CASE( "Frustum culling of a deep hierarchy", "[culling]" )
+{
+    Frustum frustum(glm::ortho(-10.0f, 10.0f, -10.0f, 10.0f, -10.0f, 10.0f));
+
+    aabb_t unit(vec3(-1.0f, -1.0f, -1.0f), vec3(1.0f, 1.0f, 1.0f));
+
+    // A chain crossing the border of the frustum, each link with a sibling outside
+    const size_t NB_LINKS = 20;
+
+    std::vector<Transforms> links(NB_LINKS);
+    std::vector<Transforms> siblings(NB_LINKS);
+
+    for (size_t i = 0; i < NB_LINKS; ++i)
+    {
+        if (i > 0)
+        {
+            links[i].setParent(&links[i - 1]);
+            siblings[i].setParent(&links[i - 1]);
+        }
+
+        links[i].setPosition(1.0f, 0.0f, 0.0f);
+        links[i].setLocalBounds(unit);
+
+        siblings[i].setPosition(0.0f, 50.0f, 0.0f);
+        siblings[i].setLocalBounds(unit);
+    }
+
+    std::vector<Transforms*> visible;
+
+    // Links 0 to 9 are at x = 1 to 10, link 10 touches the border at x = 11 - 1
+    REQUIRE( frustum.cull(&links[0], visible) == 11 );
+
+    for (size_t i = 0; i < 11; ++i)
+        REQUIRE( std::find(visible.begin(), visible.end(), &links[i]) != visible.end() );
+}
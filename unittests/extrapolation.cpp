@@ -0,0 +1,154 @@
+#include <catch.hpp>
+#include "common.h"
+
+using namespace knm::tr2;
+
+
+TEST_CASE( "Extrapolation of local transforms", "[extrapolation]" )
+{
+    Transforms node;
+    Transforms other;
+
+    Extrapolator extrapolator;
+    extrapolator.setReference(&node, 10.0, makePose(vec3(1.0f, 0.0f, 0.0f), QUAT_IDENTITY),
+                              vec3(0.0f, 2.0f, 0.0f), vec3(0.0f, 0.0f, 1.0f));
+
+    REQUIRE( extrapolator.size() == 1 );
+    REQUIRE( extrapolator.contains(&node) );
+    REQUIRE( !extrapolator.contains(&other) );
+
+    pose_t pose;
+    REQUIRE( !extrapolator.getTransforms(&other, 10.0, pose) );
+
+    REQUIRE( extrapolator.getTransforms(&node, 10.5, pose) );
+    REQUIRE( equals(pose.position, vec3(1.0f, 1.0f, 0.0f)) );
+    REQUIRE( equals(pose.orientation, KNM_TRANSFORMS_TREE_ANGLE_AXIS(0.5f, VEC3_UNIT_Z)) );
+
+    // The Transforms isn't modified
+    REQUIRE( equals(node.getPosition(), VEC3_ZERO) );
+
+    // New reference
+    extrapolator.setReference(&node, 11.0, makePose(vec3(5.0f, 0.0f, 0.0f), QUAT_IDENTITY),
+                              VEC3_ZERO, VEC3_ZERO);
+    REQUIRE( extrapolator.size() == 1 );
+
+    REQUIRE( extrapolator.getTransforms(&node, 20.0, pose) );
+    REQUIRE( equals(pose.position, vec3(5.0f, 0.0f, 0.0f)) );
+
+    extrapolator.remove(&node);
+    REQUIRE( extrapolator.size() == 0 );
+    REQUIRE( !extrapolator.contains(&node) );
+}
+
+
+TEST_CASE( "Extrapolation of world transforms", "[extrapolation]" )
+{
+    Transforms root;
+    Transforms vehicle;
+    Transforms turret;
+    Transforms barrel;
+
+    root.setPosition(vec3(0.0f, 0.0f, 10.0f));
+    vehicle.setParent(&root);
+    turret.setParent(&vehicle);
+    turret.setPosition(vec3(0.0f, 1.0f, 0.0f));
+    barrel.setParent(&turret);
+    barrel.setPosition(vec3(0.0f, 0.0f, -2.0f));
+
+    Extrapolator extrapolator;
+    extrapolator.setReference(&barrel, 0.0, makePose(vec3(0.0f, 0.0f, -2.0f), QUAT_IDENTITY),
+                              VEC3_ZERO, vec3(0.0f, 1.5707963f, 0.0f));
+    extrapolator.setReference(&vehicle, 0.0, makePose(VEC3_ZERO, QUAT_IDENTITY),
+                              vec3(4.0f, 0.0f, 0.0f), VEC3_ZERO);
+
+    // Not extrapolated, below an extrapolated Transforms
+    pose_t turretPose = extrapolator.getWorldTransforms(&turret, 0.5);
+    REQUIRE( equals(turretPose.position, vec3(2.0f, 1.0f, 10.0f)) );
+
+    pose_t barrelPose = extrapolator.getWorldTransforms(&barrel, 1.0);
+    REQUIRE( equals(barrelPose.position, vec3(4.0f, 1.0f, 8.0f)) );
+    REQUIRE( equals(barrelPose.orientation, KNM_TRANSFORMS_TREE_ANGLE_AXIS(1.5707963f, VEC3_UNIT_Y)) );
+
+    // Without extrapolated ancestor
+    pose_t rootPose = extrapolator.getWorldTransforms(&root, 1.0);
+    REQUIRE( equals(rootPose.position, vec3(0.0f, 0.0f, 10.0f)) );
+
+    // Batch evaluation
+    pose_t poses[2];
+    extrapolator.getWorldTransforms(1.0, poses);
+
+    const std::vector<Transforms*>& nodes = extrapolator.getNodes();
+    REQUIRE( nodes.size() == 2 );
+
+    for (size_t i = 0; i < nodes.size(); ++i)
+    {
+        pose_t expected = extrapolator.getWorldTransforms(nodes[i], 1.0);
+
+        REQUIRE( equals(poses[i].position, expected.position) );
+        REQUIRE( equals(poses[i].orientation, expected.orientation) );
+        REQUIRE( equals(poses[i].scale, expected.scale) );
+    }
+
+    // The hierarchy isn't modified
+    REQUIRE( equals(barrel.getWorldPosition(), vec3(0.0f, 1.0f, 8.0f)) );
+}
+
+
+TEST_CASE( "Batch extrapolation through intermediate Transforms", "[extrapolation]" )
+{
+    Transforms root;
+    Transforms vehicle;
+    Transforms chassis;
+    Transforms wheel1;
+    Transforms wheel2;
+    Transforms other;
+    Transforms idle;
+
+    root.setPosition(vec3(0.0f, 0.0f, 10.0f));
+    vehicle.setParent(&root);
+    chassis.setParent(&vehicle);
+    chassis.setPosition(vec3(0.0f, 1.0f, 0.0f));
+    wheel1.setParent(&chassis);
+    wheel1.setPosition(vec3(1.0f, 0.0f, 0.0f));
+    wheel2.setParent(&chassis);
+    wheel2.setPosition(vec3(-1.0f, 0.0f, 0.0f));
+    other.setPosition(vec3(5.0f, 0.0f, 0.0f));
+    idle.setParent(&other);
+
+    Extrapolator extrapolator;
+    extrapolator.setReference(&wheel1, 0.0, makePose(vec3(1.0f, 0.0f, 0.0f), QUAT_IDENTITY),
+                              VEC3_ZERO, vec3(1.0f, 0.0f, 0.0f));
+    extrapolator.setReference(&vehicle, 0.0, makePose(VEC3_ZERO, QUAT_IDENTITY),
+                              vec3(4.0f, 0.0f, 0.0f), vec3(0.0f, 1.0f, 0.0f));
+    extrapolator.setReference(&wheel2, 0.0, makePose(vec3(-1.0f, 0.0f, 0.0f), QUAT_IDENTITY),
+                              VEC3_ZERO, vec3(-1.0f, 0.0f, 0.0f));
+    extrapolator.setReference(&idle, 0.0, makePose(VEC3_ZERO, QUAT_IDENTITY),
+                              vec3(0.0f, 1.0f, 0.0f), VEC3_ZERO);
+
+    const std::vector<Transforms*>& nodes = extrapolator.getNodes();
+    pose_t poses[4];
+
+    for (int step = 0; step < 2; ++step)
+    {
+        extrapolator.getWorldTransforms(2.0, poses);
+
+        for (size_t i = 0; i < nodes.size(); ++i)
+        {
+            pose_t expected = extrapolator.getWorldTransforms(nodes[i], 2.0);
+
+            REQUIRE( equals(poses[i].position, expected.position) );
+            REQUIRE( equals(poses[i].orientation, expected.orientation) );
+        }
+
+        REQUIRE( equals(poses[1].position, vec3(8.0f, 0.0f, 10.0f)) );
+        REQUIRE( equals(poses[3].position, vec3(5.0f, 2.0f, 0.0f)) );
+
+        // The hierarchy can be modified between two evaluations
+        other.setParent(&chassis);
+        other.setPosition(VEC3_ZERO);
+    }
+
+    // Now below the vehicle
+    REQUIRE( equals(poses[3].position, extrapolator.getWorldTransforms(&chassis, 2.0).position +
+                                       vec3(0.0f, 2.0f, 0.0f)) );
+}
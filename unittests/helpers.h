@@ -17,3 +17,15 @@ inline bool equals(const knm::tr2::quat& lhs, const knm::tr2::quat& rhs, float t
 
     return (abs(angle) <= tolerance) || (abs(angle - knm::tr2::PI) < tolerance);
 }
+
+
+inline knm::tr2::pose_t makePose(const knm::tr2::vec3& position,
+                                 const knm::tr2::quat& orientation,
+                                 const knm::tr2::vec3& scale = knm::tr2::VEC3_UNIT_SCALE)
+{
+    knm::tr2::pose_t pose;
+    pose.position = position;
+    pose.orientation = orientation;
+    pose.scale = scale;
+    return pose;
+}
@@ -131,3 +131,134 @@ TEST_CASE( "Find children by unknown tag", "[hierarchy]" )
 
     REQUIRE( children.size() == 0 );
 }
+
+
+TEST_CASE( "Build hierarchy", "[hierarchy]" )
+{
+    Transforms nodes[4];
+    Transforms* pointers[4] = { &nodes[0], &nodes[1], &nodes[2], &nodes[3] };
+
+    // Children before their parent on purpose
+    int32_t parents[4] = { 2, -1, 1, 1 };
+
+    pose_t poses[4];
+    for (int i = 0; i < 4; ++i)
+    {
+        poses[i].position = vec3(1.0f, 0.0f, 0.0f);
+        poses[i].orientation = QUAT_IDENTITY;
+        poses[i].scale = VEC3_UNIT_SCALE;
+    }
+
+    poses[1].scale = vec3(2.0f, 2.0f, 2.0f);
+
+    std::string tags[4] = { "leaf", "", "", "leaf" };
+
+    REQUIRE( Transforms::buildHierarchy(pointers, parents, poses, 4, tags) );
+
+    REQUIRE( nodes[1].getParent() == nullptr );
+    REQUIRE( nodes[1].getChildren().size() == 2 );
+    REQUIRE( nodes[1].getChildren()[0] == &nodes[2] );
+    REQUIRE( nodes[1].getChildren()[1] == &nodes[3] );
+    REQUIRE( nodes[2].getChildren().size() == 1 );
+    REQUIRE( nodes[0].getParent() == &nodes[2] );
+
+    REQUIRE( nodes[1].findChildren("leaf", true).size() == 2 );
+    REQUIRE( nodes[1].getTags().empty() );
+
+    REQUIRE( equals(nodes[1].getWorldPosition(), vec3(1.0f, 0.0f, 0.0f)) );
+    REQUIRE( equals(nodes[2].getWorldPosition(), vec3(3.0f, 0.0f, 0.0f)) );
+    REQUIRE( equals(nodes[0].getWorldPosition(), vec3(5.0f, 0.0f, 0.0f)) );
+    REQUIRE( equals(nodes[0].getWorldScale(), vec3(2.0f, 2.0f, 2.0f)) );
+
+    // The built hierarchy behaves like any other
+    nodes[2].translate(vec3(0.0f, 1.0f, 0.0f));
+
+    REQUIRE( equals(nodes[0].getWorldPosition(), vec3(5.0f, 2.0f, 0.0f)) );
+
+    std::vector<Transforms*> changed;
+    REQUIRE( nodes[1].updateHierarchy(changed) == 4 );
+}
+
+
+TEST_CASE( "Build hierarchy with a journal", "[hierarchy]" )
+{
+    StructureJournal journal;
+
+    Transforms nodes[2];
+    Transforms* pointers[2] = { &nodes[0], &nodes[1] };
+    int32_t parents[2] = { -1, 0 };
+
+    pose_t poses[2];
+    poses[0].position = poses[1].position = VEC3_ZERO;
+    poses[0].orientation = poses[1].orientation = QUAT_IDENTITY;
+    poses[0].scale = poses[1].scale = VEC3_UNIT_SCALE;
+
+    nodes[0].setJournal(&journal);
+
+    REQUIRE( Transforms::buildHierarchy(pointers, parents, poses, 2) );
+
+    REQUIRE( nodes[1].getJournal() == &journal );
+
+    std::vector<structure_event_t> events;
+    REQUIRE( journal.read(0, events) == 1 );
+    REQUIRE( events[0].type == SE_ATTACHED );
+    REQUIRE( events[0].transforms == &nodes[1] );
+}
+
+
+TEST_CASE( "Reparent the children while iterating over them", "[hierarchy]" )
+{
+    Transforms p1;
+    Transforms p2;
+    Transforms c1;
+    Transforms c2;
+    Transforms c3;
+
+    c1.setParent(&p1);
+    c2.setParent(&p1);
+    c3.setParent(&p1);
+
+    for (Transforms* child : p1.getChildren())
+        child->setParent(&p2);
+
+    REQUIRE( p1.getChildren().size() == 0 );
+    REQUIRE( p2.getChildren().size() == 3 );
+}
+
+
+TEST_CASE( "Build hierarchy with invalid parent indices", "[hierarchy]" )
+{
+    Transforms nodes[4];
+    Transforms* pointers[4] = { &nodes[0], &nodes[1], &nodes[2], &nodes[3] };
+
+    pose_t poses[4];
+    for (int i = 0; i < 4; ++i)
+    {
+        poses[i].position = VEC3_ZERO;
+        poses[i].orientation = QUAT_IDENTITY;
+        poses[i].scale = VEC3_UNIT_SCALE;
+    }
+
+    // Cycle not reachable from the root
+    int32_t cycle[4] = { -1, 0, 3, 2 };
+    REQUIRE( !Transforms::buildHierarchy(pointers, cycle, poses, 4) );
+
+    // Transforms being its own parent
+    int32_t self[4] = { -1, 1, 0, 0 };
+    REQUIRE( !Transforms::buildHierarchy(pointers, self, poses, 4) );
+
+    // Index out of range
+    int32_t range[4] = { -1, 0, 4, 0 };
+    REQUIRE( !Transforms::buildHierarchy(pointers, range, poses, 4) );
+
+    // Nothing was modified
+    for (int i = 0; i < 4; ++i)
+    {
+        REQUIRE( nodes[i].getParent() == nullptr );
+        REQUIRE( nodes[i].getChildren().empty() );
+    }
+
+    int32_t valid[4] = { -1, 0, 3, 0 };
+    REQUIRE( Transforms::buildHierarchy(pointers, valid, poses, 4) );
+    REQUIRE( nodes[2].getParent() == &nodes[3] );
+}
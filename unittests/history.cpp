@@ -0,0 +1,160 @@
+#include <catch.hpp>
+#include "common.h"
+
+using namespace knm::tr2;
+
+
+TEST_CASE( "History of world transforms", "[history]" )
+{
+    Transforms a;
+    Transforms b;
+
+    TransformsHistory history(4);
+
+    Transforms* nodes[2] = { &a, &b };
+    history.record(1.0, nodes, 2);
+
+    REQUIRE( history.getNbTracked() == 2 );
+    REQUIRE( history.getOldestTime() == 1.0 );
+    REQUIRE( history.getNewestTime() == 1.0 );
+
+    // Tick 2: nothing changed
+    history.record(2.0, nodes, 0);
+
+    // Tick 3: 'a' moved
+    a.setPosition(vec3(10.0f, 0.0f, 0.0f));
+    history.record(3.0, nodes, 1);
+
+    pose_t pose;
+
+    REQUIRE( !history.getWorldTransforms(&a, 0.5, pose) );
+
+    REQUIRE( history.getWorldTransforms(&a, 1.5, pose) );
+    REQUIRE( equals(pose.position, VEC3_ZERO) );
+
+    REQUIRE( history.getWorldTransforms(&a, 2.0, pose) );
+    REQUIRE( equals(pose.position, VEC3_ZERO) );
+
+    // Between the tick before the change and the change
+    REQUIRE( history.getWorldTransforms(&a, 2.5, pose) );
+    REQUIRE( equals(pose.position, vec3(5.0f, 0.0f, 0.0f)) );
+
+    REQUIRE( history.getWorldTransforms(&a, 3.0, pose) );
+    REQUIRE( equals(pose.position, vec3(10.0f, 0.0f, 0.0f)) );
+
+    // After the last tick
+    REQUIRE( history.getWorldTransforms(&a, 10.0, pose) );
+    REQUIRE( equals(pose.position, vec3(10.0f, 0.0f, 0.0f)) );
+
+    // Never recorded
+    Transforms c;
+    REQUIRE( !history.getWorldTransforms(&c, 2.0, pose) );
+
+    history.forget(&a);
+    REQUIRE( history.getNbTracked() == 1 );
+    REQUIRE( !history.getWorldTransforms(&a, 2.0, pose) );
+}
+
+
+TEST_CASE( "History interpolation of orientations", "[history]" )
+{
+    Transforms a;
+    Transforms* node = &a;
+
+    TransformsHistory history;
+
+    history.record(0.0, &node, 1);
+
+    a.setOrientation(KNM_TRANSFORMS_TREE_ANGLE_AXIS(PI / 2.0f, VEC3_UNIT_Y));
+    a.setScale(vec3(3.0f, 3.0f, 3.0f));
+    history.record(1.0, &node, 1);
+
+    pose_t pose;
+    REQUIRE( history.getWorldTransforms(&a, 0.5, pose) );
+    REQUIRE( equals(pose.orientation, KNM_TRANSFORMS_TREE_ANGLE_AXIS(PI / 4.0f, VEC3_UNIT_Y)) );
+    REQUIRE( equals(pose.scale, vec3(2.0f, 2.0f, 2.0f)) );
+}
+
+
+TEST_CASE( "History depth", "[history]" )
+{
+    Transforms a;
+    Transforms* node = &a;
+
+    TransformsHistory history(3);
+
+    for (int i = 0; i < 5; ++i)
+    {
+        a.setPosition(vec3(real(i), 0.0f, 0.0f));
+        history.record(double(i), &node, 1);
+    }
+
+    REQUIRE( history.getOldestTime() == 2.0 );
+    REQUIRE( history.getNewestTime() == 4.0 );
+
+    pose_t pose;
+    REQUIRE( !history.getWorldTransforms(&a, 1.5, pose) );
+
+    REQUIRE( history.getWorldTransforms(&a, 2.5, pose) );
+    REQUIRE( equals(pose.position, vec3(2.5f, 0.0f, 0.0f)) );
+
+    REQUIRE( history.getWorldTransforms(&a, 4.0, pose) );
+    REQUIRE( equals(pose.position, vec3(4.0f, 0.0f, 0.0f)) );
+}
+
+
+TEST_CASE( "History of relative transforms", "[history]" )
+{
+    Transforms a;
+    Transforms b;
+
+    a.setPosition(vec3(1.0f, 0.0f, 0.0f));
+    a.setOrientation(KNM_TRANSFORMS_TREE_ANGLE_AXIS(PI / 2.0f, VEC3_UNIT_Y));
+    b.setPosition(vec3(1.0f, 0.0f, -1.0f));
+
+    Transforms* nodes[2] = { &a, &b };
+
+    TransformsHistory history;
+    history.record(0.0, nodes, 2);
+
+    a.setPosition(vec3(5.0f, 0.0f, 0.0f));
+    history.record(1.0, nodes, 1);
+
+    pose_t pose;
+    REQUIRE( history.getRelativeTransforms(&b, &a, 0.0, pose) );
+    REQUIRE( equals(pose.position, vec3(1.0f, 0.0f, 0.0f)) );
+
+    // Same as converting the world position of 'b' to the space of 'a'
+    REQUIRE( history.getRelativeTransforms(&b, &a, 1.0, pose) );
+
+    vec3 expected;
+    vec3 worldPosition = b.getWorldPosition();
+    Transforms::convertPoints(nullptr, &a, &worldPosition, &expected, 1);
+    REQUIRE( equals(pose.position, expected) );
+}
+
+
+TEST_CASE( "History of a change log", "[history]" )
+{
+    Transforms a;
+    Transforms b;
+    b.setParent(&a);
+
+    ChangeLog log;
+    log.track(&a);
+
+    TransformsHistory history;
+
+    log.update();
+    history.record(0.0, log);
+
+    REQUIRE( history.getNbTracked() == 2 );
+
+    a.translate(vec3(0.0f, 2.0f, 0.0f));
+    log.update();
+    history.record(1.0, log);
+
+    pose_t pose;
+    REQUIRE( history.getWorldTransforms(&b, 0.5, pose) );
+    REQUIRE( equals(pose.position, vec3(0.0f, 1.0f, 0.0f)) );
+}
@@ -0,0 +1,113 @@
+#include <catch.hpp>
+#include "common.h"
+
+using namespace knm::tr2;
+
+
+TEST_CASE( "IK on a two-bone chain", "[ik]" )
+{
+    Transforms base;
+    Transforms shoulder;
+    Transforms elbow;
+    Transforms hand;
+
+    base.setPosition(vec3(0.0f, 0.0f, 3.0f));
+    shoulder.setParent(&base);
+    elbow.setParent(&shoulder);
+    elbow.setPosition(vec3(1.0f, 0.0f, 0.0f));
+    hand.setParent(&elbow);
+    hand.setPosition(vec3(1.0f, 0.0f, 0.0f));
+
+    Transforms* links[3] = { &shoulder, &elbow, &hand };
+
+    IKSolver solver(links, 3);
+    REQUIRE( solver.getNbLinks() == 3 );
+
+    const vec3 target(1.0f, 1.0f, 3.0f);
+
+    SECTION( "CCD" )
+    {
+        REQUIRE( solver.solveCCD(target, 64) );
+        REQUIRE( equals(hand.getWorldPosition(), target, 1e-3f) );
+    }
+
+    SECTION( "FABRIK" )
+    {
+        REQUIRE( solver.solveFABRIK(target, 64) );
+        REQUIRE( equals(hand.getWorldPosition(), target, 1e-3f) );
+    }
+
+    // Only the orientations were modified
+    REQUIRE( equals(elbow.getPosition(), vec3(1.0f, 0.0f, 0.0f)) );
+    REQUIRE( glm::length(elbow.getWorldPosition() - shoulder.getWorldPosition()) == Approx(1.0f) );
+    REQUIRE( glm::length(hand.getWorldPosition() - elbow.getWorldPosition()) == Approx(1.0f) );
+}
+
+
+TEST_CASE( "IK with an unreachable target", "[ik]" )
+{
+    Transforms shoulder;
+    Transforms elbow;
+    Transforms hand;
+
+    elbow.setParent(&shoulder);
+    elbow.setPosition(vec3(1.0f, 0.0f, 0.0f));
+    hand.setParent(&elbow);
+    hand.setPosition(vec3(1.0f, 0.0f, 0.0f));
+
+    Transforms* links[3] = { &shoulder, &elbow, &hand };
+    IKSolver solver(links, 3);
+
+    const vec3 target(0.0f, 5.0f, 0.0f);
+
+    SECTION( "CCD" )
+    {
+        REQUIRE( !solver.solveCCD(target, 64) );
+    }
+
+    SECTION( "FABRIK" )
+    {
+        REQUIRE( !solver.solveFABRIK(target) );
+    }
+
+    REQUIRE( equals(hand.getWorldPosition(), vec3(0.0f, 2.0f, 0.0f), 1e-3f) );
+}
+
+
+TEST_CASE( "IK on a long chain", "[ik]" )
+{
+    const size_t NB_LINKS = 10;
+
+    Transforms nodes[NB_LINKS];
+    Transforms* links[NB_LINKS];
+
+    for (size_t i = 0; i < NB_LINKS; ++i)
+    {
+        links[i] = &nodes[i];
+
+        if (i > 0)
+        {
+            nodes[i].setParent(&nodes[i - 1]);
+            nodes[i].setPosition(vec3(0.0f, 0.5f, 0.0f));
+        }
+    }
+
+    IKSolver solver(links, NB_LINKS);
+
+    const vec3 target(2.0f, 2.0f, 1.0f);
+
+    SECTION( "CCD" )
+    {
+        REQUIRE( solver.solveCCD(target, 64) );
+    }
+
+    SECTION( "FABRIK" )
+    {
+        REQUIRE( solver.solveFABRIK(target, 64) );
+    }
+
+    REQUIRE( equals(nodes[NB_LINKS - 1].getWorldPosition(), target, 1e-3f) );
+
+    for (size_t i = 1; i < NB_LINKS; ++i)
+        REQUIRE( glm::length(nodes[i].getWorldPosition() - nodes[i - 1].getWorldPosition()) == Approx(0.5f) );
+}
@@ -0,0 +1,142 @@
+#include <catch.hpp>
+#include "common.h"
+
+using namespace knm::tr2;
+
+
+TEST_CASE( "Interest manager observers", "[interest]" )
+{
+    SpatialIndex index(10.0f);
+    InterestManager manager(&index);
+
+    Transforms a;
+    Transforms b;
+
+    manager.addObserver(&a, 5.0f);
+    manager.addObserver(&b, 5.0f);
+    manager.addObserver(&a, 10.0f);
+
+    REQUIRE( manager.getNbObservers() == 2 );
+
+    manager.removeObserver(&a);
+
+    REQUIRE( manager.getNbObservers() == 1 );
+
+    manager.update();
+
+    REQUIRE( manager.getChanges(&b).entering.empty() );
+    REQUIRE( manager.getInterest(&b).empty() );
+}
+
+
+TEST_CASE( "Interest manager entering and leaving", "[interest]" )
+{
+    SpatialIndex index(10.0f);
+    InterestManager manager(&index);
+
+    Transforms observer;
+    Transforms a;
+    Transforms b;
+
+    a.setPosition(vec3(3.0f, 0.0f, 0.0f));
+    b.setPosition(vec3(30.0f, 0.0f, 0.0f));
+
+    index.add(&observer);
+    index.add(&a);
+    index.add(&b);
+
+    manager.addObserver(&observer, 5.0f);
+    manager.update();
+
+    const InterestManager::changes_t& changes = manager.getChanges(&observer);
+
+    REQUIRE( changes.entering.size() == 1 );
+    REQUIRE( changes.entering[0] == &a );
+    REQUIRE( changes.leaving.empty() );
+    REQUIRE( changes.changed.empty() );
+
+    a.setPosition(vec3(40.0f, 0.0f, 0.0f));
+    b.setPosition(vec3(0.0f, 4.0f, 0.0f));
+    index.refresh();
+    manager.update();
+
+    REQUIRE( changes.entering.size() == 1 );
+    REQUIRE( changes.entering[0] == &b );
+    REQUIRE( changes.leaving.size() == 1 );
+    REQUIRE( changes.leaving[0] == &a );
+    REQUIRE( changes.changed.empty() );
+
+    std::vector<Transforms*> interest = manager.getInterest(&observer);
+    REQUIRE( interest.size() == 1 );
+    REQUIRE( interest[0] == &b );
+}
+
+
+TEST_CASE( "Interest manager changes", "[interest]" )
+{
+    SpatialIndex index(10.0f);
+    InterestManager manager(&index);
+
+    Transforms observer;
+    Transforms a;
+    Transforms b;
+
+    a.setPosition(vec3(3.0f, 0.0f, 0.0f));
+    b.setPosition(vec3(0.0f, 3.0f, 0.0f));
+
+    index.add(&a);
+    index.add(&b);
+
+    // The observer isn't in the index: its world position is used
+    manager.addObserver(&observer, 5.0f);
+    manager.update();
+
+    const InterestManager::changes_t& changes = manager.getChanges(&observer);
+
+    REQUIRE( changes.entering.size() == 2 );
+
+    manager.update();
+
+    REQUIRE( changes.entering.empty() );
+    REQUIRE( changes.leaving.empty() );
+    REQUIRE( changes.changed.empty() );
+
+    a.rotate(VEC3_UNIT_Y, 0.5f);
+    index.refresh();
+    manager.update();
+
+    REQUIRE( changes.entering.empty() );
+    REQUIRE( changes.leaving.empty() );
+    REQUIRE( changes.changed.size() == 1 );
+    REQUIRE( changes.changed[0] == &a );
+
+    observer.setPosition(vec3(100.0f, 0.0f, 0.0f));
+    manager.update();
+
+    REQUIRE( changes.entering.empty() );
+    REQUIRE( changes.leaving.size() == 2 );
+    REQUIRE( changes.changed.empty() );
+}
+
+
+TEST_CASE( "Interest manager radius", "[interest]" )
+{
+    SpatialIndex index(10.0f);
+    InterestManager manager(&index);
+
+    Transforms observer;
+    Transforms a;
+
+    a.setPosition(vec3(8.0f, 0.0f, 0.0f));
+    index.add(&a);
+
+    manager.addObserver(&observer, 5.0f);
+    manager.update();
+
+    REQUIRE( manager.getChanges(&observer).entering.empty() );
+
+    manager.setRadius(&observer, 10.0f);
+    manager.update();
+
+    REQUIRE( manager.getChanges(&observer).entering.size() == 1 );
+}
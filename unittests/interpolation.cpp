@@ -0,0 +1,80 @@
+#include <catch.hpp>
+#include "common.h"
+
+using namespace knm::tr2;
+
+
+TEST_CASE( "Render interpolation", "[interpolation]" )
+{
+    Transforms a;
+    Transforms b;
+    Transforms c;
+
+    b.setParent(&a);
+    c.setPosition(vec3(0.0f, 0.0f, 7.0f));
+
+    Transforms* nodes[3] = { &a, &b, &c };
+
+    RenderInterpolator interpolator;
+    interpolator.add(nodes, 3);
+
+    REQUIRE( interpolator.size() == 3 );
+
+    // The initial transforms are written by the first sample
+    pose_t out[3];
+    interpolator.sample(0.5f, out);
+
+    REQUIRE( equals(out[2].position, vec3(0.0f, 0.0f, 7.0f)) );
+
+    // Tick: 'a' (and thus 'b') moves
+    a.setPosition(vec3(2.0f, 0.0f, 0.0f));
+    a.setOrientation(KNM_TRANSFORMS_TREE_ANGLE_AXIS(PI / 2.0f, VEC3_UNIT_Y));
+    interpolator.capture();
+
+    REQUIRE( interpolator.getNbMoving() == 2 );
+
+    interpolator.sample(0.5f, out);
+
+    REQUIRE( equals(out[0].position, vec3(1.0f, 0.0f, 0.0f)) );
+    REQUIRE( equals(out[0].orientation, KNM_TRANSFORMS_TREE_ANGLE_AXIS(PI / 4.0f, VEC3_UNIT_Y)) );
+    REQUIRE( equals(out[1].position, vec3(1.0f, 0.0f, 0.0f)) );
+    REQUIRE( equals(out[2].position, vec3(0.0f, 0.0f, 7.0f)) );
+
+    interpolator.sample(1.0f, out);
+    REQUIRE( equals(out[0].position, vec3(2.0f, 0.0f, 0.0f)) );
+
+    // Tick: nothing moves, the last transforms are written once
+    interpolator.capture();
+    REQUIRE( interpolator.getNbMoving() == 0 );
+
+    out[0].position = VEC3_ZERO;
+    interpolator.sample(0.0f, out);
+    REQUIRE( equals(out[0].position, vec3(2.0f, 0.0f, 0.0f)) );
+
+    // Static Transforms aren't written anymore
+    out[0].position = VEC3_ZERO;
+    interpolator.sample(0.0f, out);
+    REQUIRE( equals(out[0].position, VEC3_ZERO) );
+}
+
+
+TEST_CASE( "Render interpolation along the shortest path", "[interpolation]" )
+{
+    Transforms a;
+    a.setOrientation(KNM_TRANSFORMS_TREE_ANGLE_AXIS(0.1f, VEC3_UNIT_Z));
+
+    Transforms* node = &a;
+
+    RenderInterpolator interpolator;
+    interpolator.add(&node, 1);
+
+    // Same rotation, opposite quaternion
+    quat q = KNM_TRANSFORMS_TREE_ANGLE_AXIS(0.3f, VEC3_UNIT_Z);
+    a.setOrientation(quat(-q.w, -q.x, -q.y, -q.z));
+    interpolator.capture();
+
+    pose_t out;
+    interpolator.sample(0.5f, &out);
+
+    REQUIRE( equals(out.orientation, KNM_TRANSFORMS_TREE_ANGLE_AXIS(0.2f, VEC3_UNIT_Z)) );
+}
@@ -0,0 +1,164 @@
+#include <catch.hpp>
+#include "common.h"
+
+using namespace knm::tr2;
+
+
+TEST_CASE( "Journal of parent-children modifications", "[journal]" )
+{
+    StructureJournal journal;
+
+    Transforms a;
+    Transforms b;
+    Transforms c;
+
+    a.setJournal(&journal);
+    b.setParent(&a);
+
+    REQUIRE( b.getJournal() == &journal );
+    REQUIRE( journal.getSequence() == 1 );
+
+    c.setParent(&b);
+    REQUIRE( c.getJournal() == &journal );
+
+    c.setParent(&a);
+    c.setParent(nullptr);
+
+    std::vector<structure_event_t> events;
+    REQUIRE( journal.read(0, events) == 4 );
+
+    REQUIRE( events[0].sequence == 1 );
+    REQUIRE( events[0].type == SE_ATTACHED );
+    REQUIRE( events[0].transforms == &b );
+    REQUIRE( events[0].parent == &a );
+    REQUIRE( events[0].previousParent == nullptr );
+
+    REQUIRE( events[1].type == SE_ATTACHED );
+    REQUIRE( events[1].transforms == &c );
+
+    REQUIRE( events[2].type == SE_REPARENTED );
+    REQUIRE( events[2].parent == &a );
+    REQUIRE( events[2].previousParent == &b );
+
+    REQUIRE( events[3].type == SE_DETACHED );
+    REQUIRE( events[3].parent == nullptr );
+    REQUIRE( events[3].previousParent == &a );
+
+    // Only the events after a given one
+    REQUIRE( journal.read(3, events) == 1 );
+    REQUIRE( events[0].sequence == 4 );
+
+    REQUIRE( journal.read(4, events) == 0 );
+}
+
+
+TEST_CASE( "Journal of tags modifications", "[journal]" )
+{
+    StructureJournal journal;
+
+    Transforms a;
+    a.setJournal(&journal);
+
+    a.addTag("tag1");
+    a.removeTag("tag2");
+    a.removeTag("tag1");
+
+    std::vector<structure_event_t> events;
+    REQUIRE( journal.read(0, events) == 2 );
+
+    REQUIRE( events[0].type == SE_TAG_ADDED );
+    REQUIRE( events[0].tag == "tag1" );
+    REQUIRE( events[1].type == SE_TAG_REMOVED );
+    REQUIRE( events[1].tag == "tag1" );
+}
+
+
+TEST_CASE( "Journal of destructions", "[journal]" )
+{
+    StructureJournal journal;
+
+    Transforms a;
+    a.setJournal(&journal);
+
+    Transforms* b = new Transforms();
+    b->setParent(&a);
+    b->setParent(nullptr);
+    b->setJournal(&journal);
+    delete b;
+
+    std::vector<structure_event_t> events;
+    REQUIRE( journal.read(0, events) == 3 );
+    REQUIRE( events[2].type == SE_DESTROYED );
+    REQUIRE( events[2].transforms == b );
+}
+
+
+TEST_CASE( "Journal of detached Transforms", "[journal]" )
+{
+    StructureJournal journal;
+
+    Transforms a;
+    Transforms b;
+    Transforms c;
+
+    a.setJournal(&journal);
+    b.setParent(&a);
+    c.setParent(&b);
+
+    b.setParent(nullptr);
+    REQUIRE( b.getJournal() == nullptr );
+    REQUIRE( c.getJournal() == nullptr );
+
+    // Not recorded anymore
+    c.addTag("tag");
+    c.setParent(nullptr);
+
+    std::vector<structure_event_t> events;
+    REQUIRE( journal.read(0, events) == 3 );
+    REQUIRE( events[2].type == SE_DETACHED );
+    REQUIRE( events[2].transforms == &b );
+
+    // Attached again
+    b.setParent(&a);
+    REQUIRE( b.getJournal() == &journal );
+    REQUIRE( journal.read(3, events) == 1 );
+    REQUIRE( events[0].type == SE_ATTACHED );
+}
+
+
+TEST_CASE( "Hierarchy without journal", "[journal]" )
+{
+    Transforms a;
+    Transforms b;
+
+    b.setParent(&a);
+    a.addTag("tag");
+
+    REQUIRE( a.getJournal() == nullptr );
+    REQUIRE( b.getJournal() == nullptr );
+}
+
+
+TEST_CASE( "Journal overflow", "[journal]" )
+{
+    StructureJournal journal(4);
+
+    Transforms a;
+    a.setJournal(&journal);
+
+    for (int i = 0; i < 6; ++i)
+        a.addTag("tag");
+
+    REQUIRE( journal.getSequence() == 6 );
+    REQUIRE( journal.getCapacity() == 4 );
+
+    REQUIRE( journal.hasOverflowed(0) );
+    REQUIRE( journal.hasOverflowed(1) );
+    REQUIRE( !journal.hasOverflowed(2) );
+    REQUIRE( !journal.hasOverflowed(6) );
+
+    std::vector<structure_event_t> events;
+    REQUIRE( journal.read(0, events) == 4 );
+    REQUIRE( events[0].sequence == 3 );
+    REQUIRE( events[3].sequence == 6 );
+}
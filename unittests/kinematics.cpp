@@ -0,0 +1,119 @@
+#include <catch.hpp>
+#include "common.h"
+
+using namespace knm::tr2;
+
+
+TEST_CASE( "Forward kinematics", "[kinematics]" )
+{
+    Transforms base;
+    Transforms shoulder;
+    Transforms elbow;
+    Transforms hand;
+
+    base.setPosition(vec3(0.0f, 0.0f, 5.0f));
+    shoulder.setParent(&base);
+    elbow.setParent(&shoulder);
+    elbow.setPosition(vec3(1.0f, 0.0f, 0.0f));
+    hand.setParent(&elbow);
+    hand.setPosition(vec3(1.0f, 0.0f, 0.0f));
+
+    Transforms* links[3] = { &shoulder, &elbow, &hand };
+    joint_type_t types[3] = { JT_REVOLUTE, JT_REVOLUTE, JT_FIXED };
+    vec3 axes[3] = { VEC3_UNIT_Z, VEC3_UNIT_Z, VEC3_ZERO };
+
+    KinematicChain chain(links, types, axes, 3);
+    REQUIRE( chain.getNbLinks() == 3 );
+
+    const real halfPi = 1.5707963f;
+
+    SECTION( "Several configurations" )
+    {
+        real values[6] = { halfPi, 0.0f, 0.0f,
+                           0.0f, halfPi, 0.0f };
+        pose_t poses[6];
+
+        chain.computeForwardKinematics(values, 2, poses);
+
+        REQUIRE( equals(poses[1].position, vec3(0.0f, 1.0f, 5.0f)) );
+        REQUIRE( equals(poses[2].position, vec3(0.0f, 2.0f, 5.0f)) );
+        REQUIRE( equals(poses[5].position, vec3(1.0f, 1.0f, 5.0f)) );
+
+        // The Transforms weren't modified
+        REQUIRE( equals(hand.getWorldPosition(), vec3(2.0f, 0.0f, 5.0f)) );
+    }
+
+    SECTION( "Jacobian" )
+    {
+        real values[3] = { 0.3f, 0.7f, 0.0f };
+        pose_t poses[3];
+        real jacobian[18];
+
+        chain.computeForwardKinematics(values, 1, poses, jacobian);
+
+        // Compare with finite differences
+        const real delta = 1e-3f;
+
+        for (size_t joint = 0; joint < 2; ++joint)
+        {
+            real moved[3] = { values[0], values[1], values[2] };
+            moved[joint] += delta;
+
+            pose_t movedPoses[3];
+            chain.computeForwardKinematics(moved, 1, movedPoses);
+
+            vec3 velocity = (movedPoses[2].position - poses[2].position) / delta;
+            const real* column = jacobian + joint * 6;
+
+            REQUIRE( equals(vec3(column[0], column[1], column[2]), velocity, 1e-2f) );
+            REQUIRE( equals(vec3(column[3], column[4], column[5]), VEC3_UNIT_Z) );
+        }
+
+        const real* column = jacobian + 12;
+        REQUIRE( equals(vec3(column[0], column[1], column[2]), VEC3_ZERO) );
+        REQUIRE( equals(vec3(column[3], column[4], column[5]), VEC3_ZERO) );
+    }
+
+    SECTION( "Apply" )
+    {
+        real values[3] = { halfPi, halfPi, 0.0f };
+        chain.apply(values);
+
+        REQUIRE( equals(hand.getWorldPosition(), vec3(-1.0f, 1.0f, 5.0f)) );
+
+        pose_t poses[3];
+        chain.computeForwardKinematics(values, 1, poses);
+
+        REQUIRE( equals(poses[2].position, hand.getWorldPosition()) );
+        REQUIRE( equals(poses[2].orientation, hand.getWorldOrientation()) );
+    }
+}
+
+
+TEST_CASE( "Forward kinematics with a prismatic joint", "[kinematics]" )
+{
+    Transforms base;
+    Transforms slider;
+    Transforms tip;
+
+    base.setScale(vec3(2.0f, 2.0f, 2.0f));
+    slider.setParent(&base);
+    tip.setParent(&slider);
+    tip.setPosition(vec3(0.0f, 1.0f, 0.0f));
+
+    Transforms* links[2] = { &slider, &tip };
+    joint_type_t types[2] = { JT_PRISMATIC, JT_FIXED };
+    vec3 axes[2] = { VEC3_UNIT_X, VEC3_ZERO };
+
+    KinematicChain chain(links, types, axes, 2);
+
+    real values[2] = { 3.0f, 0.0f };
+    pose_t poses[2];
+    real jacobian[12];
+
+    chain.computeForwardKinematics(values, 1, poses, jacobian);
+
+    REQUIRE( equals(poses[1].position, vec3(6.0f, 2.0f, 0.0f)) );
+    REQUIRE( equals(vec3(jacobian[0], jacobian[1], jacobian[2]), vec3(2.0f, 0.0f, 0.0f)) );
+    REQUIRE( equals(vec3(jacobian[3], jacobian[4], jacobian[5]), VEC3_ZERO) );
+}
@@ -0,0 +1,95 @@
+#include <catch.hpp>
+#include "common.h"
+
+using namespace knm::tr2;
+
+
+TEST_CASE( "Motion matrices", "[motion]" )
+{
+    Transforms a;
+    Transforms b;
+    Transforms c;
+
+    b.setParent(&a);
+
+    Transforms* nodes[3] = { &a, &b, &c };
+
+    MotionMatrices motion;
+    motion.add(nodes, 3);
+
+    REQUIRE( motion.size() == 3 );
+    REQUIRE( motion.contains(&b) );
+
+    ChangeLog log;
+    log.track(&a);
+    log.track(&c);
+    log.update();
+    motion.update(log);
+
+    // Frame 2: 'a' (and thus 'b') moves
+    a.setPosition(vec3(1.0f, 0.0f, 0.0f));
+    log.update();
+    motion.update(log);
+
+    mat4 current;
+    mat4 previous;
+
+    motion.getMatrices(&b, current, previous);
+    REQUIRE( equals(vec3(current[3]), vec3(1.0f, 0.0f, 0.0f)) );
+    REQUIRE( equals(vec3(previous[3]), VEC3_ZERO) );
+
+    motion.getMatrices(&c, current, previous);
+    REQUIRE( equals(vec3(current[3]), VEC3_ZERO) );
+    REQUIRE( equals(vec3(previous[3]), VEC3_ZERO) );
+
+    // Frame 3: 'a' moves again
+    a.setPosition(vec3(3.0f, 0.0f, 0.0f));
+    log.update();
+    motion.update(log);
+
+    mat4 out[4];
+    motion.write(nodes, 2, out);
+
+    REQUIRE( equals(vec3(out[0][3]), vec3(3.0f, 0.0f, 0.0f)) );
+    REQUIRE( equals(vec3(out[1][3]), vec3(1.0f, 0.0f, 0.0f)) );
+    REQUIRE( equals(vec3(out[2][3]), vec3(3.0f, 0.0f, 0.0f)) );
+    REQUIRE( equals(vec3(out[3][3]), vec3(1.0f, 0.0f, 0.0f)) );
+
+    // Frame 4: nothing moves, the previous matrices are the current ones
+    log.update();
+    motion.update(log);
+
+    motion.getMatrices(&a, current, previous);
+    REQUIRE( equals(vec3(current[3]), vec3(3.0f, 0.0f, 0.0f)) );
+    REQUIRE( equals(vec3(previous[3]), vec3(3.0f, 0.0f, 0.0f)) );
+    REQUIRE( motion.getFrame() == 4 );
+}
+
+
+TEST_CASE( "Motion matrices removal", "[motion]" )
+{
+    Transforms a;
+    Transforms* node = &a;
+
+    MotionMatrices motion;
+
+    {
+        Transforms b;
+        Transforms* nodes[2] = { &a, &b };
+        motion.add(nodes, 2);
+
+        REQUIRE( motion.size() == 2 );
+    }
+
+    // Destroyed Transforms are removed automatically
+    REQUIRE( motion.size() == 1 );
+
+    motion.remove(&a);
+    REQUIRE( motion.size() == 0 );
+    REQUIRE( !motion.contains(&a) );
+
+    // The slots are reused
+    motion.add(&node, 1);
+    REQUIRE( motion.size() == 1 );
+    REQUIRE( motion.contains(&a) );
+}
@@ -0,0 +1,127 @@
+#include <catch.hpp>
+#include "common.h"
+
+using namespace knm::tr2;
+
+
+TEST_CASE( "Pose buffer capture and commit", "[pose_buffer]" )
+{
+    Transforms root;
+    Transforms child;
+    child.setParent(&root);
+
+    root.setPosition(vec3(1.0f, 2.0f, 3.0f));
+    child.setScale(vec3(2.0f, 2.0f, 2.0f));
+
+    Transforms* nodes[2] = { &root, &child };
+
+    PoseBuffer buffer(2);
+    REQUIRE( buffer.size() == 2 );
+    REQUIRE( equals(buffer.getPose(0).position, VEC3_ZERO) );
+    REQUIRE( equals(buffer.getPose(1).scale, VEC3_UNIT_SCALE) );
+
+    buffer.capture(nodes);
+    REQUIRE( equals(buffer.getPose(0).position, vec3(1.0f, 2.0f, 3.0f)) );
+    REQUIRE( equals(buffer.getPose(1).scale, vec3(2.0f, 2.0f, 2.0f)) );
+
+    buffer.setPose(1, makePose(vec3(0.0f, 1.0f, 0.0f), QUAT_IDENTITY, VEC3_UNIT_SCALE));
+    buffer.commit(nodes);
+
+    REQUIRE( equals(child.getScale(), VEC3_UNIT_SCALE) );
+    REQUIRE( equals(child.getWorldPosition(), vec3(1.0f, 3.0f, 3.0f)) );
+}
+
+
+TEST_CASE( "Pose buffer weighted blending", "[pose_buffer]" )
+{
+    PoseBuffer a(2);
+    PoseBuffer b(2);
+
+    quat orientation = KNM_TRANSFORMS_TREE_ANGLE_AXIS(1.0f, VEC3_UNIT_Y);
+
+    b.setPose(0, makePose(vec3(4.0f, 0.0f, 0.0f), orientation, vec3(3.0f, 3.0f, 3.0f)));
+    b.setPose(1, makePose(vec3(4.0f, 0.0f, 0.0f), -orientation, VEC3_UNIT_SCALE));
+
+    SECTION( "Without mask" )
+    {
+        a.blend(b, 0.5f);
+
+        REQUIRE( equals(a.getPose(0).position, vec3(2.0f, 0.0f, 0.0f)) );
+        REQUIRE( equals(a.getPose(0).scale, vec3(2.0f, 2.0f, 2.0f)) );
+        REQUIRE( equals(a.getPose(0).orientation, KNM_TRANSFORMS_TREE_ANGLE_AXIS(0.5f, VEC3_UNIT_Y)) );
+
+        // Shortest path
+        REQUIRE( equals(a.getPose(1).orientation, KNM_TRANSFORMS_TREE_ANGLE_AXIS(0.5f, VEC3_UNIT_Y)) );
+    }
+
+    SECTION( "With mask" )
+    {
+        real mask[2] = { 1.0f, 0.0f };
+        a.blend(b, 0.5f, mask);
+
+        REQUIRE( equals(a.getPose(0).position, vec3(2.0f, 0.0f, 0.0f)) );
+        REQUIRE( equals(a.getPose(1).position, VEC3_ZERO) );
+        REQUIRE( equals(a.getPose(1).orientation, QUAT_IDENTITY) );
+    }
+}
+
+
+TEST_CASE( "Pose buffer additive blending", "[pose_buffer]" )
+{
+    quat rotation = KNM_TRANSFORMS_TREE_ANGLE_AXIS(0.4f, VEC3_UNIT_X);
+    quat base = KNM_TRANSFORMS_TREE_ANGLE_AXIS(0.3f, VEC3_UNIT_Y);
+
+    PoseBuffer reference(1);
+    reference.setPose(0, makePose(vec3(1.0f, 0.0f, 0.0f), base, vec3(2.0f, 2.0f, 2.0f)));
+
+    PoseBuffer additive(1);
+    additive.setPose(0, makePose(vec3(1.0f, 1.0f, 0.0f), base * rotation, vec3(4.0f, 4.0f, 4.0f)));
+    additive.makeAdditive(reference);
+
+    REQUIRE( equals(additive.getPose(0).position, vec3(0.0f, 1.0f, 0.0f)) );
+    REQUIRE( equals(additive.getPose(0).orientation, rotation) );
+    REQUIRE( equals(additive.getPose(0).scale, vec3(2.0f, 2.0f, 2.0f)) );
+
+    PoseBuffer pose(1);
+    pose.setPose(0, makePose(vec3(5.0f, 0.0f, 0.0f), base, VEC3_UNIT_SCALE));
+
+    SECTION( "Full weight" )
+    {
+        pose.addAdditive(additive, 1.0f);
+
+        REQUIRE( equals(pose.getPose(0).position, vec3(5.0f, 1.0f, 0.0f)) );
+        REQUIRE( equals(pose.getPose(0).orientation, base * rotation) );
+        REQUIRE( equals(pose.getPose(0).scale, vec3(2.0f, 2.0f, 2.0f)) );
+    }
+
+    SECTION( "Half weight" )
+    {
+        pose.addAdditive(additive, 0.5f);
+
+        REQUIRE( equals(pose.getPose(0).position, vec3(5.0f, 0.5f, 0.0f)) );
+        REQUIRE( equals(pose.getPose(0).orientation, base * KNM_TRANSFORMS_TREE_ANGLE_AXIS(0.2f, VEC3_UNIT_X)) );
+        REQUIRE( equals(pose.getPose(0).scale, vec3(1.5f, 1.5f, 1.5f)) );
+    }
+
+    SECTION( "Masked" )
+    {
+        real mask[1] = { 0.0f };
+        pose.addAdditive(additive, 1.0f, mask);
+
+        REQUIRE( equals(pose.getPose(0).position, vec3(5.0f, 0.0f, 0.0f)) );
+        REQUIRE( equals(pose.getPose(0).orientation, base) );
+    }
+}
+
+
+TEST_CASE( "Pose buffer sampled from an animation clip", "[pose_buffer]" )
+{
+    AnimationClip clip(2, 2, 1.0f);
+    clip.setKey(1, 1, makePose(vec3(2.0f, 0.0f, 0.0f), QUAT_IDENTITY, VEC3_UNIT_SCALE));
+
+    PoseBuffer buffer(2);
+    clip.sample(0.5f, false, buffer.getValues());
+
+    REQUIRE( equals(buffer.getPose(1).position, vec3(1.0f, 0.0f, 0.0f)) );
+    REQUIRE( equals(buffer.getPose(0).orientation, QUAT_IDENTITY) );
+}
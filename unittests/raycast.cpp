@@ -0,0 +1,105 @@
+#include <catch.hpp>
+#include "common.h"
+
+using namespace knm::tr2;
+
+
+TEST_CASE( "Ray intersection with a box", "[raycast]" )
+{
+    aabb_t box(vec3(-1.0f, -1.0f, -1.0f), vec3(1.0f, 1.0f, 1.0f));
+    real distance = -1.0f;
+
+    REQUIRE( Math::intersects(vec3(-5.0f, 0.0f, 0.0f), VEC3_UNIT_X, box, 100.0f, distance) );
+    REQUIRE( distance == Approx(4.0f) );
+
+    REQUIRE( Math::intersects(VEC3_ZERO, VEC3_UNIT_X, box, 100.0f, distance) );
+    REQUIRE( distance == Approx(0.0f) );
+
+    REQUIRE( !Math::intersects(vec3(-5.0f, 0.0f, 0.0f), VEC3_NEGATIVE_UNIT_X, box, 100.0f, distance) );
+    REQUIRE( !Math::intersects(vec3(-5.0f, 2.0f, 0.0f), VEC3_UNIT_X, box, 100.0f, distance) );
+    REQUIRE( !Math::intersects(vec3(-5.0f, 0.0f, 0.0f), VEC3_UNIT_X, box, 3.0f, distance) );
+    REQUIRE( !Math::intersects(vec3(-5.0f, 0.0f, 0.0f), VEC3_UNIT_X, aabb_t(), 100.0f, distance) );
+}
+
+
+TEST_CASE( "Raycast on a hierarchy", "[raycast]" )
+{
+    Transforms root;
+    Transforms a;
+    Transforms b;
+    Transforms c;
+
+    a.setParent(&root);
+    b.setParent(&root);
+    c.setParent(&a);
+
+    aabb_t unit(vec3(-1.0f, -1.0f, -1.0f), vec3(1.0f, 1.0f, 1.0f));
+
+    a.setLocalBounds(unit);
+    b.setLocalBounds(unit);
+    c.setLocalBounds(unit);
+
+    a.setPosition(10.0f, 0.0f, 0.0f);
+    b.setPosition(20.0f, 0.0f, 0.0f);
+    c.setPosition(-5.0f, 0.0f, 0.0f);
+
+    ray_t ray;
+    ray.origin = VEC3_ZERO;
+    ray.direction = vec3(2.0f, 0.0f, 0.0f);
+
+    std::vector<ray_hit_t> hits;
+
+    SECTION("all hits, sorted")
+    {
+        REQUIRE( root.raycast(ray, hits) == 3 );
+        REQUIRE( hits[0].transforms == &c );
+        REQUIRE( hits[0].distance == Approx(4.0f) );
+        REQUIRE( hits[1].transforms == &a );
+        REQUIRE( hits[1].distance == Approx(9.0f) );
+        REQUIRE( hits[2].transforms == &b );
+        REQUIRE( hits[2].distance == Approx(19.0f) );
+    }
+
+    SECTION("maximum distance")
+    {
+        REQUIRE( root.raycast(ray, hits, 10.0f) == 2 );
+    }
+
+    SECTION("oriented boxes")
+    {
+        // Rotated by 45 degrees around Y and scaled: the oriented box is hit later
+        // than its world-space axis-aligned box would be
+        b.setOrientation(KNM_TRANSFORMS_TREE_ANGLE_AXIS(PI / 4.0f, VEC3_UNIT_Y));
+        b.setScale(2.0f, 1.0f, 1.0f);
+
+        ray.origin = vec3(20.0f, 0.0f, -5.0f);
+        ray.direction = VEC3_UNIT_Z;
+
+        REQUIRE( root.raycast(ray, hits) == 1 );
+        REQUIRE( hits[0].transforms == &b );
+        REQUIRE( hits[0].distance == Approx(5.0f - std::sqrt(2.0f)) );
+    }
+
+    SECTION("missed")
+    {
+        ray.direction = VEC3_UNIT_Y;
+
+        REQUIRE( root.raycast(ray, hits) == 0 );
+    }
+
+    SECTION("several rays")
+    {
+        ray_t rays[2];
+        rays[0] = ray;
+        rays[1].origin = vec3(20.0f, 10.0f, 0.0f);
+        rays[1].direction = VEC3_NEGATIVE_UNIT_Y;
+
+        std::vector<ray_hit_t> results[2];
+        root.raycast(rays, 2, results);
+
+        REQUIRE( results[0].size() == 3 );
+        REQUIRE( results[1].size() == 1 );
+        REQUIRE( results[1][0].transforms == &b );
+        REQUIRE( results[1][0].distance == Approx(9.0f) );
+    }
+}
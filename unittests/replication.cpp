@@ -0,0 +1,126 @@
+#include <catch.hpp>
+#include "common.h"
+
+using namespace knm::tr2;
+
+
+TEST_CASE( "Bits writing and reading", "[replication]" )
+{
+    std::vector<uint8_t> buffer;
+
+    BitWriter writer(buffer);
+    writer.write(5, 3);
+    writer.write(0xFFFFFFFF, 32);
+    writer.write(1, 1);
+    writer.write(0x1234, 13);
+    writer.flush();
+
+    REQUIRE( buffer.size() == 7 );
+
+    BitReader reader(buffer.data(), buffer.size());
+    uint32_t value;
+
+    REQUIRE( reader.read(3, value) );
+    REQUIRE( value == 5 );
+    REQUIRE( reader.read(32, value) );
+    REQUIRE( value == 0xFFFFFFFF );
+    REQUIRE( reader.read(1, value) );
+    REQUIRE( value == 1 );
+    REQUIRE( reader.read(13, value) );
+    REQUIRE( value == (0x1234 & 0x1FFF) );
+    REQUIRE( !reader.read(8, value) );
+}
+
+
+TEST_CASE( "Quantization", "[replication]" )
+{
+    REQUIRE( Math::quantize(-10.0f, -1.0f, 1.0f, 8) == 0 );
+    REQUIRE( Math::quantize(10.0f, -1.0f, 1.0f, 8) == 255 );
+    REQUIRE( Math::dequantize(255, -1.0f, 1.0f, 8) == Approx(1.0f) );
+    REQUIRE( Math::dequantize(Math::quantize(0.3f, -1.0f, 1.0f, 16), -1.0f, 1.0f, 16) ==
+             Approx(0.3f).epsilon(1e-4) );
+}
+
+
+TEST_CASE( "Replication", "[replication]" )
+{
+    Transforms source[3];
+    Transforms destination[3];
+
+    source[1].setParent(&source[0]);
+    source[2].setParent(&source[0]);
+    destination[1].setParent(&destination[0]);
+    destination[2].setParent(&destination[0]);
+
+    Transforms* sourceNodes[3] = { &source[0], &source[1], &source[2] };
+    Transforms* destinationNodes[3] = { &destination[0], &destination[1], &destination[2] };
+
+    ReplicationEncoder encoder(sourceNodes, 3);
+    ReplicationDecoder decoder(destinationNodes, 3);
+
+    source[0].setPosition(vec3(10.0f, 20.0f, -30.0f));
+    source[1].setOrientation(KNM_TRANSFORMS_TREE_ANGLE_AXIS(0.7f, VEC3_UNIT_Y));
+    source[2].setScale(vec3(1.5f, 2.0f, 0.5f));
+    source[2].setOrientation(KNM_TRANSFORMS_TREE_ANGLE_AXIS(-2.0f, VEC3_UNIT_X));
+
+    // Initially, everything is sent
+    std::vector<uint8_t> message;
+    REQUIRE( encoder.encode(sourceNodes, 3, message) == 3 );
+    REQUIRE( decoder.decode(message.data(), message.size()) );
+
+    for (int i = 0; i < 3; ++i)
+    {
+        REQUIRE( equals(destination[i].getPosition(), source[i].getPosition(), 0.05f) );
+        REQUIRE( equals(destination[i].getOrientation(), source[i].getOrientation(), 0.01f) );
+        REQUIRE( equals(destination[i].getScale(), source[i].getScale()) );
+    }
+
+    REQUIRE( equals(destination[2].getWorldPosition(), vec3(10.0f, 20.0f, -30.0f), 0.05f) );
+
+    // Nothing changed
+    REQUIRE( encoder.encode(sourceNodes, 3, message) == 0 );
+    REQUIRE( message.size() == 4 );
+    REQUIRE( decoder.decode(message.data(), message.size()) );
+
+    // Only the position of one Transforms changed: 2 bits of identifier, 3 bits of mask
+    // and 3 x 16 bits of position
+    source[1].translate(vec3(1.0f, 0.0f, 0.0f));
+
+    REQUIRE( encoder.encode(sourceNodes, 3, message) == 1 );
+    REQUIRE( message.size() == 4 + 7 );
+    REQUIRE( decoder.decode(message.data(), message.size()) );
+    REQUIRE( equals(destination[1].getPosition(), vec3(1.0f, 0.0f, 0.0f), 0.05f) );
+    REQUIRE( equals(destination[1].getOrientation(), source[1].getOrientation(), 0.01f) );
+
+    // Statistics
+    REQUIRE( encoder.getStatistics().nbMessages == 3 );
+    REQUIRE( encoder.getStatistics().nbNodes == 4 );
+    REQUIRE( decoder.getStatistics().nbBytes == encoder.getStatistics().nbBytes );
+    REQUIRE( encoder.getStatistics().getBytesPerNode() > 0.0 );
+
+    // After a reset, everything is sent again
+    encoder.reset();
+    REQUIRE( encoder.encode(sourceNodes, 3, message) == 3 );
+}
+
+
+TEST_CASE( "Invalid replication messages", "[replication]" )
+{
+    Transforms source;
+    Transforms destination;
+
+    Transforms* sourceNodes[1] = { &source };
+    Transforms* destinationNodes[1] = { &destination };
+
+    ReplicationEncoder encoder(sourceNodes, 1);
+    ReplicationDecoder decoder(destinationNodes, 1);
+
+    source.setPosition(vec3(1.0f, 2.0f, 3.0f));
+
+    std::vector<uint8_t> message;
+    encoder.encode(sourceNodes, 1, message);
+
+    REQUIRE( !decoder.decode(message.data(), 3) );
+    REQUIRE( !decoder.decode(message.data(), message.size() - 1) );
+    REQUIRE( equals(destination.getPosition(), VEC3_ZERO) );
+}
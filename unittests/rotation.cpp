@@ -179,3 +179,29 @@ TEST_CASE( "Rotation (world) around X of child", "[rotation]" )
     REQUIRE( equals(KNM_TRANSFORMS_TREE_ANGLE_AXIS(-PI / 2.0f, VEC3_UNIT_Y) * KNM_TRANSFORMS_TREE_ANGLE_AXIS(PI / 2.0f, VEC3_UNIT_Z),
                     c.getWorldOrientation()) );
 }
+
+
+TEST_CASE( "Rotation (world) of several children", "[rotation]" )
+{
+    Transforms p;
+    Transforms c1;
+    Transforms c2;
+
+    c1.setParent(&p);
+    c2.setParent(&p);
+
+    p.setOrientation(KNM_TRANSFORMS_TREE_ANGLE_AXIS(-PI / 2.0f, VEC3_UNIT_Y));
+    c2.setOrientation(KNM_TRANSFORMS_TREE_ANGLE_AXIS(PI / 2.0f, VEC3_UNIT_X));
+
+    Transforms* nodes[] = { &c1, &c2 };
+    quat q[] = { KNM_TRANSFORMS_TREE_ANGLE_AXIS(-PI / 2.0f, VEC3_UNIT_X),
+                 KNM_TRANSFORMS_TREE_ANGLE_AXIS(PI / 2.0f, VEC3_UNIT_Z) };
+
+    quat expected2 = q[1] * c2.getWorldOrientation();
+
+    Transforms::rotate(nodes, q, 2, TS_WORLD);
+
+    REQUIRE( equals(KNM_TRANSFORMS_TREE_ANGLE_AXIS(PI / 2.0f, VEC3_UNIT_Z), c1.getOrientation()) );
+    REQUIRE( equals(q[0] * p.getWorldOrientation(), c1.getWorldOrientation()) );
+    REQUIRE( equals(expected2, c2.getWorldOrientation()) );
+}
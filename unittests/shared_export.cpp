@@ -0,0 +1,171 @@
+#include <catch.hpp>
+#include "common.h"
+
+using namespace knm::tr2;
+
+
+TEST_CASE( "Shared export of poses", "[shared_export]" )
+{
+    std::vector<uint64_t> memory(SharedExportWriter::getRequiredSize(2, 3, EF_POSES) / 8);
+
+    SharedExportWriter writer(memory.data(), 2);
+    SharedExportReader reader(memory.data(), memory.size() * 8);
+
+    REQUIRE( reader.isValid() );
+    REQUIRE( reader.getFormat() == EF_POSES );
+    REQUIRE( reader.getValuesPerNode() == 10 );
+    REQUIRE( reader.getLastFrame() == 0 );
+
+    std::vector<float> values;
+    uint64_t frame;
+
+    REQUIRE( !reader.read(values, frame) );
+
+    Transforms a;
+    Transforms b;
+
+    b.setParent(&a);
+    a.setPosition(vec3(1.0f, 2.0f, 3.0f));
+    b.setPosition(vec3(1.0f, 0.0f, 0.0f));
+    b.setScale(vec3(2.0f, 2.0f, 2.0f));
+
+    Transforms* nodes[2] = { &a, &b };
+
+    REQUIRE( writer.write(nodes, 2) == 1 );
+
+    REQUIRE( reader.read(values, frame) );
+    REQUIRE( frame == 1 );
+    REQUIRE( values.size() == 20 );
+    REQUIRE( values[10] == Approx(2.0f) );
+    REQUIRE( values[11] == Approx(2.0f) );
+    REQUIRE( values[12] == Approx(3.0f) );
+    REQUIRE( values[16] == Approx(1.0f) );
+    REQUIRE( values[17] == Approx(2.0f) );
+
+    // Several frames (more than the number of slots)
+    for (int i = 0; i < 4; ++i)
+    {
+        a.translate(vec3(1.0f, 0.0f, 0.0f));
+        writer.write(nodes, 1);
+    }
+
+    REQUIRE( reader.getLastFrame() == 5 );
+    REQUIRE( reader.read(values, frame) );
+    REQUIRE( frame == 5 );
+    REQUIRE( values.size() == 10 );
+    REQUIRE( values[0] == Approx(5.0f) );
+}
+
+
+TEST_CASE( "Shared export of matrices", "[shared_export]" )
+{
+    std::vector<uint64_t> memory(SharedExportWriter::getRequiredSize(1, 2, EF_MATRICES) / 8);
+
+    SharedExportWriter writer(memory.data(), 1, 2, EF_MATRICES);
+    SharedExportReader reader(memory.data(), memory.size() * 8);
+
+    REQUIRE( reader.getValuesPerNode() == 12 );
+
+    Transforms a;
+    a.setPosition(vec3(1.0f, 2.0f, 3.0f));
+    a.setOrientation(KNM_TRANSFORMS_TREE_ANGLE_AXIS(PI / 2.0f, VEC3_UNIT_Z));
+    a.setScale(vec3(2.0f, 2.0f, 2.0f));
+
+    Transforms* node = &a;
+    writer.write(&node, 1);
+
+    std::vector<float> values;
+    uint64_t frame;
+    REQUIRE( reader.read(values, frame) );
+
+    mat4 matrix = a.getWorldMatrix();
+
+    for (int row = 0; row < 3; ++row)
+    {
+        for (int column = 0; column < 4; ++column)
+            REQUIRE( values[row * 4 + column] == Approx(matrix[column][row]).margin(1e-5) );
+    }
+}
+
+
+TEST_CASE( "Shared export with invalid memory", "[shared_export]" )
+{
+    std::vector<uint64_t> memory(64, 0);
+
+    SharedExportReader reader(memory.data(), memory.size() * 8);
+    REQUIRE( !reader.isValid() );
+
+    SharedExportWriter writer(memory.data(), 1, 2);
+
+    // Too small
+    SharedExportReader reader2(memory.data(), 16);
+    REQUIRE( !reader2.isValid() );
+
+    SharedExportReader reader3(memory.data(), memory.size() * 8);
+    REQUIRE( reader3.isValid() );
+}
+
+
+TEST_CASE( "Shared export read in place", "[shared_export]" )
+{
+    std::vector<uint64_t> memory(SharedExportWriter::getRequiredSize(2, 2, EF_POSES) / 8);
+
+    SharedExportWriter writer(memory.data(), 2, 2);
+    SharedExportReader reader(memory.data(), memory.size() * 8);
+
+    exported_frame_t frame;
+    REQUIRE( !reader.beginRead(frame) );
+
+    Transforms a;
+    a.setPosition(vec3(1.0f, 2.0f, 3.0f));
+
+    Transforms* node = &a;
+    writer.write(&node, 1);
+
+    REQUIRE( reader.beginRead(frame) );
+    REQUIRE( frame.frame == 1 );
+    REQUIRE( frame.nbNodes == 1 );
+    REQUIRE( frame.values[0] == Approx(1.0f) );
+    REQUIRE( frame.values[2] == Approx(3.0f) );
+    REQUIRE( reader.endRead(frame) );
+
+    // The slot is overwritten while being read (the ring has 2 slots)
+    REQUIRE( reader.beginRead(frame) );
+
+    writer.write(&node, 1);
+    REQUIRE( reader.endRead(frame) );
+
+    writer.write(&node, 1);
+    REQUIRE( !reader.endRead(frame) );
+
+    REQUIRE( reader.beginRead(frame) );
+    REQUIRE( frame.frame == 3 );
+    REQUIRE( reader.endRead(frame) );
+}
+
+
+TEST_CASE( "Shared export of Transforms needing an update", "[shared_export]" )
+{
+    std::vector<uint64_t> memory(SharedExportWriter::getRequiredSize(2, 2, EF_POSES) / 8);
+
+    SharedExportWriter writer(memory.data(), 2, 2);
+    SharedExportReader reader(memory.data(), memory.size() * 8);
+
+    Transforms a;
+    Transforms b;
+    b.setParent(&a);
+
+    Transforms* nodes[2] = { &b, &a };
+
+    // The world transforms are updated by the writer
+    a.setPosition(vec3(1.0f, 0.0f, 0.0f));
+    b.setPosition(vec3(0.0f, 1.0f, 0.0f));
+    writer.write(nodes, 2);
+
+    std::vector<float> values;
+    uint64_t frame;
+    REQUIRE( reader.read(values, frame) );
+    REQUIRE( values[0] == Approx(1.0f) );
+    REQUIRE( values[1] == Approx(1.0f) );
+    REQUIRE( values[10] == Approx(1.0f) );
+}
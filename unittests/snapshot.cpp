@@ -0,0 +1,179 @@
+#include <catch.hpp>
+#include "common.h"
+#include <sstream>
+
+using namespace knm::tr2;
+
+
+static void createHierarchy(Transforms* nodes)
+{
+    nodes[1].setParent(&nodes[0]);
+    nodes[2].setParent(&nodes[1]);
+    nodes[3].setParent(&nodes[0]);
+
+    nodes[0].setPosition(vec3(1.0f, 2.0f, 3.0f));
+    nodes[1].setOrientation(KNM_TRANSFORMS_TREE_ANGLE_AXIS(PI / 2.0f, VEC3_UNIT_Y));
+    nodes[2].setPosition(vec3(0.0f, 0.0f, 1.0f));
+    nodes[2].setScale(vec3(2.0f, 3.0f, 4.0f));
+    nodes[3].setInheritScale(false);
+
+    nodes[1].addTag("tag1");
+    nodes[2].addTag("tag1");
+    nodes[2].addTag("tag2");
+}
+
+
+static void checkHierarchy(Transforms* nodes)
+{
+    REQUIRE( nodes[0].getParent() == nullptr );
+    REQUIRE( nodes[1].getParent() == &nodes[0] );
+    REQUIRE( nodes[2].getParent() == &nodes[1] );
+    REQUIRE( nodes[3].getParent() == &nodes[0] );
+
+    REQUIRE( equals(nodes[0].getPosition(), vec3(1.0f, 2.0f, 3.0f)) );
+    REQUIRE( equals(nodes[2].getScale(), vec3(2.0f, 3.0f, 4.0f)) );
+    REQUIRE( equals(nodes[2].getWorldPosition(), vec3(2.0f, 2.0f, 3.0f)) );
+
+    REQUIRE( nodes[3].inheritOrientation() );
+    REQUIRE( !nodes[3].inheritScale() );
+
+    REQUIRE( nodes[0].getTags().empty() );
+    REQUIRE( nodes[1].hasTag("tag1") );
+    REQUIRE( nodes[2].getTags().size() == 2 );
+    REQUIRE( nodes[2].hasTag("tag1") );
+    REQUIRE( nodes[2].hasTag("tag2") );
+}
+
+
+TEST_CASE( "Snapshot in memory", "[snapshot]" )
+{
+    Transforms source[4];
+    createHierarchy(source);
+
+    Transforms* root = &source[0];
+
+    std::vector<uint8_t> buffer;
+    SnapshotWriter::write(&root, 1, buffer);
+
+    REQUIRE( buffer.size() % 4 == 0 );
+
+    SnapshotReader reader;
+    REQUIRE( reader.open(buffer.data(), buffer.size()) );
+    REQUIRE( reader.isValid() );
+    REQUIRE( reader.getNbNodes() == 4 );
+    REQUIRE( !reader.hasWorldTransforms() );
+
+    // Parents first
+    REQUIRE( reader.getParents()[0] == -1 );
+    REQUIRE( reader.getParents()[1] == 0 );
+    REQUIRE( reader.getParents()[2] == 0 );
+    REQUIRE( reader.getParents()[3] == 1 );
+
+    Transforms restored[4];
+    Transforms* nodes[4] = { &restored[0], &restored[1], &restored[3], &restored[2] };
+    reader.restore(nodes);
+
+    checkHierarchy(restored);
+}
+
+
+TEST_CASE( "Snapshot in a stream", "[snapshot]" )
+{
+    Transforms source[4];
+    createHierarchy(source);
+
+    Transforms* root = &source[0];
+
+    std::stringstream stream;
+    REQUIRE( SnapshotWriter::write(&root, 1, stream, true) );
+
+    SnapshotReader reader;
+    REQUIRE( reader.read(stream) );
+    REQUIRE( reader.getNbNodes() == 4 );
+    REQUIRE( reader.hasWorldTransforms() );
+
+    pose_t pose = reader.getWorldPose(3);
+    REQUIRE( equals(pose.position, vec3(2.0f, 2.0f, 3.0f)) );
+    REQUIRE( equals(pose.scale, vec3(2.0f, 3.0f, 4.0f)) );
+    REQUIRE( equals(pose.orientation, source[2].getWorldOrientation()) );
+
+    std::vector<std::string> tags = reader.getTags(3);
+    REQUIRE( tags.size() == 2 );
+    REQUIRE( tags[0] == "tag1" );
+    REQUIRE( tags[1] == "tag2" );
+
+    Transforms restored[4];
+    Transforms* nodes[4] = { &restored[0], &restored[1], &restored[3], &restored[2] };
+    reader.restore(nodes);
+
+    checkHierarchy(restored);
+}
+
+
+TEST_CASE( "Snapshot with several roots", "[snapshot]" )
+{
+    Transforms a;
+    Transforms b;
+    Transforms c;
+
+    c.setParent(&b);
+
+    Transforms* roots[2] = { &a, &b };
+
+    std::vector<uint8_t> buffer;
+    SnapshotWriter::write(roots, 2, buffer);
+
+    SnapshotReader reader;
+    REQUIRE( reader.open(buffer.data(), buffer.size()) );
+    REQUIRE( reader.getNbNodes() == 3 );
+    REQUIRE( reader.getParents()[0] == -1 );
+    REQUIRE( reader.getParents()[1] == -1 );
+    REQUIRE( reader.getParents()[2] == 1 );
+}
+
+
+TEST_CASE( "Invalid snapshots", "[snapshot]" )
+{
+    Transforms source[4];
+    createHierarchy(source);
+
+    Transforms* root = &source[0];
+
+    std::vector<uint8_t> buffer;
+    SnapshotWriter::write(&root, 1, buffer);
+
+    SnapshotReader reader;
+
+    // Truncated
+    REQUIRE( !reader.open(buffer.data(), buffer.size() - 4) );
+    REQUIRE( !reader.isValid() );
+
+    // Wrong magic number
+    std::vector<uint8_t> corrupted = buffer;
+    corrupted[0] = 0;
+    REQUIRE( !reader.open(corrupted.data(), corrupted.size()) );
+
+    // Child before its parent
+    corrupted = buffer;
+    int32_t index = 2;
+    std::memcpy(corrupted.data() + 8 * 4 + 4, &index, sizeof(index));
+    REQUIRE( !reader.open(corrupted.data(), corrupted.size()) );
+
+    // Different byte order
+    corrupted = buffer;
+    std::reverse(corrupted.begin() + 7 * 4, corrupted.begin() + 8 * 4);
+    REQUIRE( !reader.open(corrupted.data(), corrupted.size()) );
+
+    // Truncated stream
+    std::stringstream stream(std::string(buffer.begin(), buffer.end() - 4));
+    REQUIRE( !reader.read(stream) );
+
+    // Huge number of Transforms in the header of a small stream
+    corrupted = buffer;
+    uint32_t count = 0xFFFFFFFF;
+    std::memcpy(corrupted.data() + 2 * 4, &count, sizeof(count));
+
+    std::stringstream stream2(std::string(corrupted.begin(), corrupted.end()));
+    REQUIRE( !reader.read(stream2) );
+    REQUIRE( !reader.isValid() );
+}
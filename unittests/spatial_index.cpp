@@ -0,0 +1,190 @@
+#include <catch.hpp>
+#include "common.h"
+
+using namespace knm::tr2;
+
+
+TEST_CASE( "Spatial index creation", "[spatial_index]" )
+{
+    SpatialIndex index(10.0f);
+
+    REQUIRE( index.size() == 0 );
+    REQUIRE( index.getCellSize() == 10.0f );
+}
+
+
+TEST_CASE( "Spatial index add and remove", "[spatial_index]" )
+{
+    SpatialIndex index(10.0f);
+
+    Transforms a;
+    Transforms b;
+    Transforms c;
+
+    b.setParent(&a);
+    c.setParent(&b);
+
+    index.addHierarchy(&a);
+
+    REQUIRE( index.size() == 3 );
+    REQUIRE( index.contains(&a) );
+    REQUIRE( index.contains(&b) );
+    REQUIRE( index.contains(&c) );
+
+    index.remove(&a);
+
+    REQUIRE( index.size() == 2 );
+    REQUIRE( !index.contains(&a) );
+    REQUIRE( index.contains(&b) );
+    REQUIRE( index.contains(&c) );
+
+    index.clear();
+
+    REQUIRE( index.size() == 0 );
+}
+
+
+TEST_CASE( "Spatial index queries", "[spatial_index]" )
+{
+    SpatialIndex index(10.0f);
+
+    std::vector<Transforms> nodes(100);
+    for (int i = 0; i < 100; ++i)
+    {
+        nodes[i].setPosition(real(i % 10) * 5.0f, 0.0f, real(i / 10) * 5.0f);
+        index.add(&nodes[i]);
+    }
+
+    std::vector<Transforms*> result;
+
+    SECTION("radius")
+    {
+        REQUIRE( index.queryRadius(vec3(20.0f, 0.0f, 20.0f), 5.5f, result) == 5 );
+        REQUIRE( std::find(result.begin(), result.end(), &nodes[44]) != result.end() );
+        REQUIRE( std::find(result.begin(), result.end(), &nodes[43]) != result.end() );
+        REQUIRE( std::find(result.begin(), result.end(), &nodes[45]) != result.end() );
+        REQUIRE( std::find(result.begin(), result.end(), &nodes[34]) != result.end() );
+        REQUIRE( std::find(result.begin(), result.end(), &nodes[54]) != result.end() );
+    }
+
+    SECTION("box")
+    {
+        REQUIRE( index.queryBox(vec3(-1.0f, -1.0f, -1.0f), vec3(6.0f, 1.0f, 11.0f), result) == 6 );
+        REQUIRE( std::find(result.begin(), result.end(), &nodes[0]) != result.end() );
+        REQUIRE( std::find(result.begin(), result.end(), &nodes[21]) != result.end() );
+    }
+
+    SECTION("huge box")
+    {
+        REQUIRE( index.queryBox(vec3(-1e6f, -1e6f, -1e6f), vec3(1e6f, 1e6f, 1e6f), result) == 100 );
+    }
+
+    SECTION("nearest")
+    {
+        REQUIRE( index.queryNearest(vec3(100.0f, 0.0f, 100.0f), 3, result) == 3 );
+        REQUIRE( result[0] == &nodes[99] );
+        REQUIRE( ((result[1] == &nodes[98]) || (result[1] == &nodes[89])) );
+        REQUIRE( ((result[2] == &nodes[98]) || (result[2] == &nodes[89])) );
+    }
+
+    SECTION("nearest (more than available)")
+    {
+        REQUIRE( index.queryNearest(VEC3_ZERO, 1000, result) == 100 );
+        REQUIRE( result[0] == &nodes[0] );
+        REQUIRE( result[99] == &nodes[99] );
+    }
+}
+
+
+TEST_CASE( "Spatial index refresh", "[spatial_index]" )
+{
+    SpatialIndex index(10.0f);
+
+    Transforms p;
+    Transforms c1;
+    Transforms c2;
+    Transforms other;
+
+    c1.setParent(&p);
+    c2.setParent(&p);
+
+    c1.setPosition(1.0f, 0.0f, 0.0f);
+    c2.setPosition(-1.0f, 0.0f, 0.0f);
+    other.setPosition(0.0f, 0.0f, 50.0f);
+
+    index.addHierarchy(&p);
+    index.add(&other);
+
+    REQUIRE( index.refresh() == 0 );
+
+    std::vector<Transforms*> result;
+    REQUIRE( index.queryRadius(vec3(100.0f, 0.0f, 0.0f), 5.0f, result) == 0 );
+
+    // Moving the parent moves the children too
+    p.setPosition(100.0f, 0.0f, 0.0f);
+
+    // Not visible before the refresh
+    REQUIRE( index.queryRadius(vec3(100.0f, 0.0f, 0.0f), 5.0f, result) == 0 );
+
+    REQUIRE( index.refresh() == 3 );
+    REQUIRE( index.queryRadius(vec3(100.0f, 0.0f, 0.0f), 5.0f, result) == 3 );
+    REQUIRE( equals(vec3(101.0f, 0.0f, 0.0f), index.getPosition(&c1)) );
+
+    REQUIRE( index.refresh() == 0 );
+
+    // Explicit list of moved Transforms
+    other.setPosition(100.0f, 0.0f, 2.0f);
+
+    Transforms* moved[] = { &other };
+    index.refresh(moved, 1);
+
+    REQUIRE( index.queryRadius(vec3(100.0f, 0.0f, 0.0f), 5.0f, result) == 4 );
+    REQUIRE( index.refresh() == 0 );
+}
+
+
+TEST_CASE( "Spatial index with non-finite positions", "[spatial_index]" )
+{
+    SpatialIndex index(10.0f);
+
+    const real nan = std::numeric_limits<real>::quiet_NaN();
+    const real inf = std::numeric_limits<real>::infinity();
+
+    Transforms a;
+    Transforms b;
+    Transforms c;
+    Transforms d;
+
+    a.setPosition(nan, 0.0f, 0.0f);
+    b.setPosition(0.0f, nan, 0.0f);
+    c.setPosition(1.0f, 0.0f, 0.0f);
+    d.setPosition(inf, 0.0f, 0.0f);
+
+    index.add(&a);
+    index.add(&b);
+    index.add(&c);
+
+    std::vector<Transforms*> result;
+
+    // Only one Transforms with a finite position: the search must stop
+    REQUIRE( index.queryNearest(VEC3_ZERO, 2, result) == 1 );
+    REQUIRE( result[0] == &c );
+
+    index.add(&d);
+
+    REQUIRE( index.queryNearest(VEC3_ZERO, 3, result) == 1 );
+    REQUIRE( index.queryBox(vec3(-inf, -inf, -inf), vec3(inf, inf, inf), result) == 1 );
+    REQUIRE( index.queryRadius(VEC3_ZERO, 1e30f, result) == 1 );
+
+    // Back to a finite position
+    a.setPosition(2.0f, 0.0f, 0.0f);
+    index.refresh();
+
+    REQUIRE( index.queryNearest(VEC3_ZERO, 3, result) == 2 );
+    REQUIRE( result[0] == &c );
+    REQUIRE( result[1] == &a );
+
+    index.remove(&d);
+    index.remove(&b);
+    REQUIRE( index.size() == 2 );
+}
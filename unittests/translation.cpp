@@ -254,3 +254,47 @@ TEST_CASE( "Translation (world) of child (with scaling)", "[translation]" )
     REQUIRE( equals(vec3(10.0f, 15.0f, 20.0f), c.getPosition()) );
     REQUIRE( equals(vec3(30.0f, 40.0f, 50.0f), c.getWorldPosition()) );
 }
+
+
+TEST_CASE( "Translation (world) of several children", "[translation]" )
+{
+    Transforms p;
+    Transforms c1;
+    Transforms c2;
+
+    c1.setParent(&p);
+    c2.setParent(&p);
+
+    p.setPosition(10.0f, 10.0f, 10.0f);
+    p.setOrientation(KNM_TRANSFORMS_TREE_ANGLE_AXIS(PI / 2.0f, VEC3_UNIT_Y));
+    p.setScale(2.0f);
+
+    Transforms* nodes[] = { &c1, &c2 };
+    vec3 d[] = { vec3(20.0f, 30.0f, 40.0f), vec3(-10.0f, 0.0f, 10.0f) };
+
+    Transforms::translate(nodes, d, 2, TS_WORLD);
+
+    REQUIRE( equals(vec3(10.0f, 10.0f, 10.0f), p.getWorldPosition()) );
+    REQUIRE( equals(vec3(-20.0f, 15.0f, 10.0f), c1.getPosition()) );
+    REQUIRE( equals(vec3(30.0f, 40.0f, 50.0f), c1.getWorldPosition()) );
+    REQUIRE( equals(vec3(-5.0f, 0.0f, -5.0f), c2.getPosition()) );
+    REQUIRE( equals(vec3(0.0f, 10.0f, 20.0f), c2.getWorldPosition()) );
+}
+
+
+TEST_CASE( "Translation of several children uses the local space by default", "[translation]" )
+{
+    Transforms c1;
+    Transforms c2;
+
+    c1.setOrientation(KNM_TRANSFORMS_TREE_ANGLE_AXIS(PI / 2.0f, VEC3_UNIT_Y));
+    c2.setOrientation(KNM_TRANSFORMS_TREE_ANGLE_AXIS(PI / 2.0f, VEC3_UNIT_Y));
+
+    Transforms* nodes[] = { &c1 };
+    vec3 d[] = { vec3(1.0f, 0.0f, 0.0f) };
+
+    Transforms::translate(nodes, d, 1);
+    c2.translate(d[0]);
+
+    REQUIRE( equals(c2.getPosition(), c1.getPosition()) );
+}
@@ -0,0 +1,131 @@
+#include <catch.hpp>
+#include "common.h"
+
+using namespace knm::tr2;
+
+
+TEST_CASE( "Velocity integration in parent space", "[velocity]" )
+{
+    Transforms parent;
+    Transforms child;
+    Transforms idle;
+
+    parent.setOrientation(KNM_TRANSFORMS_TREE_ANGLE_AXIS(1.5707963f, VEC3_UNIT_Z));
+    child.setParent(&parent);
+
+    VelocityIntegrator integrator;
+    integrator.setVelocity(&child, vec3(2.0f, 0.0f, 0.0f), vec3(0.0f, 1.0f, 0.0f));
+
+    REQUIRE( integrator.size() == 1 );
+    REQUIRE( integrator.hasVelocity(&child) );
+    REQUIRE( !integrator.hasVelocity(&idle) );
+    REQUIRE( equals(integrator.getLinearVelocity(&child), vec3(2.0f, 0.0f, 0.0f)) );
+    REQUIRE( equals(integrator.getAngularVelocity(&child), vec3(0.0f, 1.0f, 0.0f)) );
+    REQUIRE( equals(integrator.getLinearVelocity(&idle), VEC3_ZERO) );
+
+    integrator.integrate(0.5f);
+
+    REQUIRE( equals(child.getPosition(), vec3(1.0f, 0.0f, 0.0f)) );
+    REQUIRE( equals(child.getOrientation(), KNM_TRANSFORMS_TREE_ANGLE_AXIS(0.5f, VEC3_UNIT_Y)) );
+    REQUIRE( equals(child.getWorldPosition(), vec3(0.0f, 1.0f, 0.0f)) );
+
+    integrator.integrate(0.5f);
+
+    REQUIRE( equals(child.getPosition(), vec3(2.0f, 0.0f, 0.0f)) );
+    REQUIRE( equals(child.getOrientation(), KNM_TRANSFORMS_TREE_ANGLE_AXIS(1.0f, VEC3_UNIT_Y)) );
+
+    integrator.removeVelocity(&child);
+    REQUIRE( integrator.size() == 0 );
+
+    integrator.integrate(1.0f);
+    REQUIRE( equals(child.getPosition(), vec3(2.0f, 0.0f, 0.0f)) );
+}
+
+
+TEST_CASE( "Velocity integration of large rotations", "[velocity]" )
+{
+    Transforms a;
+    Transforms b;
+    Transforms c;
+
+    VelocityIntegrator integrator;
+    integrator.setVelocity(&a, VEC3_ZERO, vec3(0.0f, 4.0f, 0.0f));
+    integrator.setVelocity(&b, VEC3_ZERO, vec3(-3.0f, 0.0f, 0.0f));
+    integrator.setVelocity(&c, VEC3_ZERO, vec3(0.0f, 0.0f, 1e-20f));
+
+    // More than half a turn in one step
+    integrator.integrate(1.0f);
+
+    REQUIRE( equals(a.getOrientation(), KNM_TRANSFORMS_TREE_ANGLE_AXIS(4.0f, VEC3_UNIT_Y)) );
+    REQUIRE( equals(b.getOrientation(), KNM_TRANSFORMS_TREE_ANGLE_AXIS(3.0f, VEC3_NEGATIVE_UNIT_X)) );
+    REQUIRE( equals(c.getOrientation(), QUAT_IDENTITY) );
+
+    integrator.integrate(2.0f);
+
+    REQUIRE( equals(a.getOrientation(), KNM_TRANSFORMS_TREE_ANGLE_AXIS(12.0f, VEC3_UNIT_Y)) );
+    REQUIRE( equals(b.getOrientation(), KNM_TRANSFORMS_TREE_ANGLE_AXIS(9.0f, VEC3_NEGATIVE_UNIT_X)) );
+}
+
+
+TEST_CASE( "Velocity integration in local space", "[velocity]" )
+{
+    Transforms node;
+    node.setOrientation(KNM_TRANSFORMS_TREE_ANGLE_AXIS(1.5707963f, VEC3_UNIT_Y));
+
+    VelocityIntegrator integrator;
+    integrator.setVelocity(&node, vec3(0.0f, 0.0f, 1.0f), vec3(0.0f, 0.0f, 1.0f), TS_LOCAL);
+
+    quat expected = node.getOrientation() * KNM_TRANSFORMS_TREE_ANGLE_AXIS(0.25f, VEC3_UNIT_Z);
+
+    integrator.integrate(0.25f);
+
+    REQUIRE( equals(node.getPosition(), vec3(0.25f, 0.0f, 0.0f)) );
+    REQUIRE( equals(node.getOrientation(), expected) );
+}
+
+
+TEST_CASE( "Velocity integration in world space", "[velocity]" )
+{
+    Transforms parent;
+    Transforms child;
+
+    parent.setOrientation(KNM_TRANSFORMS_TREE_ANGLE_AXIS(1.5707963f, VEC3_UNIT_Z));
+    parent.setScale(vec3(2.0f, 2.0f, 2.0f));
+    child.setParent(&parent);
+
+    VelocityIntegrator integrator;
+    integrator.setVelocity(&child, vec3(4.0f, 0.0f, 0.0f), vec3(0.0f, 0.0f, 0.0f), TS_PARENT);
+    integrator.setVelocity(&child, vec3(4.0f, 0.0f, 0.0f), vec3(0.0f, 0.5f, 0.0f), TS_WORLD);
+
+    REQUIRE( integrator.size() == 1 );
+
+    quat expected = KNM_TRANSFORMS_TREE_ANGLE_AXIS(0.5f, VEC3_UNIT_Y) * child.getWorldOrientation();
+
+    integrator.integrate(1.0f);
+
+    REQUIRE( equals(child.getWorldPosition(), vec3(4.0f, 0.0f, 0.0f)) );
+    REQUIRE( equals(child.getWorldOrientation(), expected) );
+}
+
+
+TEST_CASE( "Velocity integration of many Transforms", "[velocity]" )
+{
+    const size_t NB_NODES = 37;
+
+    Transforms nodes[NB_NODES];
+    VelocityIntegrator integrator;
+
+    for (size_t i = 0; i < NB_NODES; ++i)
+        integrator.setVelocity(&nodes[i], vec3(real(i), 0.0f, 0.0f), vec3(0.0f, real(i) * 0.1f, 0.0f));
+
+    integrator.removeVelocity(&nodes[5]);
+    integrator.integrate(2.0f);
+
+    for (size_t i = 0; i < NB_NODES; ++i)
+    {
+        real speed = (i == 5 ? 0.0f : real(i));
+
+        REQUIRE( equals(nodes[i].getWorldPosition(), vec3(speed * 2.0f, 0.0f, 0.0f)) );
+        REQUIRE( equals(nodes[i].getWorldOrientation(), KNM_TRANSFORMS_TREE_ANGLE_AXIS(speed * 0.2f, VEC3_UNIT_Y)) );
+    }
+}
@@ -0,0 +1,154 @@
+#include <catch.hpp>
+#include "common.h"
+
+using namespace knm::tr2;
+
+
+TEST_CASE( "Set world position (no parent)", "[world]" )
+{
+    Transforms t;
+
+    t.setWorldPosition(vec3(10.0f, 20.0f, 30.0f));
+
+    REQUIRE( equals(vec3(10.0f, 20.0f, 30.0f), t.getPosition()) );
+    REQUIRE( equals(vec3(10.0f, 20.0f, 30.0f), t.getWorldPosition()) );
+}
+
+
+TEST_CASE( "Set world position of child", "[world]" )
+{
+    Transforms p;
+    Transforms c;
+
+    c.setParent(&p);
+
+    p.setPosition(10.0f, 10.0f, 10.0f);
+    p.setOrientation(KNM_TRANSFORMS_TREE_ANGLE_AXIS(PI / 2.0f, VEC3_UNIT_Y));
+    p.setScale(2.0f);
+
+    c.setWorldPosition(vec3(30.0f, 40.0f, 50.0f));
+
+    REQUIRE( equals(vec3(-20.0f, 15.0f, 10.0f), c.getPosition()) );
+    REQUIRE( equals(vec3(30.0f, 40.0f, 50.0f), c.getWorldPosition()) );
+}
+
+
+TEST_CASE( "Set world orientation of child", "[world]" )
+{
+    Transforms p;
+    Transforms c;
+
+    c.setParent(&p);
+
+    p.setOrientation(KNM_TRANSFORMS_TREE_ANGLE_AXIS(-PI / 2.0f, VEC3_UNIT_Y));
+
+    SECTION("with inheritance")
+    {
+        c.setWorldOrientation(KNM_TRANSFORMS_TREE_ANGLE_AXIS(PI / 2.0f, VEC3_UNIT_X));
+
+        REQUIRE( equals(KNM_TRANSFORMS_TREE_ANGLE_AXIS(PI / 2.0f, VEC3_UNIT_Y) * KNM_TRANSFORMS_TREE_ANGLE_AXIS(PI / 2.0f, VEC3_UNIT_X),
+                        c.getOrientation()) );
+        REQUIRE( equals(KNM_TRANSFORMS_TREE_ANGLE_AXIS(PI / 2.0f, VEC3_UNIT_X), c.getWorldOrientation()) );
+    }
+
+    SECTION("without inheritance")
+    {
+        c.setInheritOrientation(false);
+        c.setWorldOrientation(KNM_TRANSFORMS_TREE_ANGLE_AXIS(PI / 2.0f, VEC3_UNIT_X));
+
+        REQUIRE( equals(KNM_TRANSFORMS_TREE_ANGLE_AXIS(PI / 2.0f, VEC3_UNIT_X), c.getOrientation()) );
+        REQUIRE( equals(KNM_TRANSFORMS_TREE_ANGLE_AXIS(PI / 2.0f, VEC3_UNIT_X), c.getWorldOrientation()) );
+    }
+}
+
+
+TEST_CASE( "Set world scale of child", "[world]" )
+{
+    Transforms p;
+    Transforms c;
+
+    c.setParent(&p);
+
+    p.setScale(2.0f, 4.0f, 8.0f);
+
+    SECTION("with inheritance")
+    {
+        c.setWorldScale(vec3(4.0f, 4.0f, 4.0f));
+
+        REQUIRE( equals(vec3(2.0f, 1.0f, 0.5f), c.getScale()) );
+        REQUIRE( equals(vec3(4.0f, 4.0f, 4.0f), c.getWorldScale()) );
+    }
+
+    SECTION("without inheritance")
+    {
+        c.setInheritScale(false);
+        c.setWorldScale(vec3(4.0f, 4.0f, 4.0f));
+
+        REQUIRE( equals(vec3(4.0f, 4.0f, 4.0f), c.getScale()) );
+        REQUIRE( equals(vec3(4.0f, 4.0f, 4.0f), c.getWorldScale()) );
+    }
+}
+
+
+TEST_CASE( "Set world transforms of child", "[world]" )
+{
+    Transforms p;
+    Transforms c;
+
+    c.setParent(&p);
+
+    p.setPosition(10.0f, 10.0f, 10.0f);
+    p.setOrientation(KNM_TRANSFORMS_TREE_ANGLE_AXIS(PI / 2.0f, VEC3_UNIT_Y));
+    p.setScale(2.0f);
+
+    pose_t pose;
+    pose.position = vec3(30.0f, 40.0f, 50.0f);
+    pose.orientation = KNM_TRANSFORMS_TREE_ANGLE_AXIS(PI / 2.0f, VEC3_UNIT_X);
+    pose.scale = vec3(1.0f, 2.0f, 3.0f);
+
+    c.setWorldTransforms(pose);
+
+    pose_t world = c.getWorldTransforms();
+
+    REQUIRE( equals(pose.position, world.position) );
+    REQUIRE( equals(pose.orientation, world.orientation) );
+    REQUIRE( equals(pose.scale, world.scale) );
+}
+
+
+TEST_CASE( "Set world transforms of several Transforms", "[world]" )
+{
+    Transforms a;
+    Transforms b;
+    Transforms c;
+    Transforms d;
+
+    b.setParent(&a);
+    c.setParent(&b);
+    d.setParent(&a);
+
+    d.setPosition(1.0f, 2.0f, 3.0f);
+
+    // Children first, to check that the parents are processed before them
+    Transforms* nodes[] = { &c, &b, &a };
+    pose_t poses[3];
+
+    for (int i = 0; i < 3; ++i)
+    {
+        poses[i].position = vec3(i * 10.0f, i * 20.0f, i * 30.0f);
+        poses[i].orientation = KNM_TRANSFORMS_TREE_ANGLE_AXIS(PI / (i + 2.0f), VEC3_UNIT_Y);
+        poses[i].scale = vec3(i + 1.0f);
+    }
+
+    Transforms::setWorldTransforms(nodes, poses, 3);
+
+    for (int i = 0; i < 3; ++i)
+    {
+        REQUIRE( equals(poses[i].position, nodes[i]->getWorldPosition()) );
+        REQUIRE( equals(poses[i].orientation, nodes[i]->getWorldOrientation()) );
+        REQUIRE( equals(poses[i].scale, nodes[i]->getWorldScale()) );
+    }
+
+    // Untouched child of a moved parent
+    REQUIRE( equals(vec3(a.getWorldMatrix() * glm::vec4(1.0f, 2.0f, 3.0f, 1.0f)), d.getWorldPosition()) );
+}